@@ -0,0 +1,179 @@
+// JsonReader and JsonWriter against an nlohmann::json DOM, on chat completion payloads
+//
+// Reading extracts choices[0].message.content, as LlmClient does for every
+// response and streamed chunk; writing serializes a conversation into a
+// request body. Build in Release for meaningful numbers.
+
+#include "json_reader.h"
+#include "json_writer.h"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace voice_assist;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps results observable so the work is not optimized away
+size_t sink = 0;
+
+/**
+ * @brief Average time of one call of work, in microseconds
+ */
+template <typename Work>
+double measureUs(int iterations, Work work) {
+    work();  // Warm up caches and allocations
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        work();
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+}
+
+/**
+ * @brief Text with the newlines and quotes a typical reply has
+ */
+std::string replyText(size_t size) {
+    std::string text;
+    text.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        text += i % 97 == 0 ? '\n' : i % 61 == 0 ? '"' : static_cast<char>('a' + i % 26);
+    }
+    return text;
+}
+
+std::string completionBody(const std::string& content) {
+    const nlohmann::json body = {
+        {"id", "chatcmpl-123"},
+        {"object", "chat.completion"},
+        {"created", 1700000000},
+        {"model", "gpt-3.5-turbo"},
+        {"choices", {{{"index", 0},
+                      {"message", {{"role", "assistant"}, {"content", content}}},
+                      {"logprobs", nullptr},
+                      {"finish_reason", "stop"}}}},
+        {"usage", {{"prompt_tokens", 100}, {"completion_tokens", 50}, {"total_tokens", 150}}},
+        {"system_fingerprint", "fp_abc"},
+    };
+    return body.dump();
+}
+
+std::string readDom(const std::string& json, const char* messageKey) {
+    const nlohmann::json document = nlohmann::json::parse(json);
+    return document["choices"][0][messageKey]["content"].get<std::string>();
+}
+
+bool readPull(const std::string& json, const char* messageKey, std::string& content) {
+    JsonReader reader(json.data(), json.size());
+    std::string key;
+    if (!reader.beginObject()) {
+        return false;
+    }
+    while (reader.nextKey(key)) {
+        if (key != "choices") {
+            if (!reader.skipValue()) {
+                return false;
+            }
+            continue;
+        }
+        if (!reader.beginArray()) {
+            return false;
+        }
+        for (bool first = true; reader.nextElement(); first = false) {
+            if (!first || !reader.beginObject()) {
+                if (!reader.skipValue()) {
+                    return false;
+                }
+                continue;
+            }
+            while (reader.nextKey(key)) {
+                if (key != messageKey || !reader.beginObject()) {
+                    if (!reader.skipValue()) {
+                        return false;
+                    }
+                    continue;
+                }
+                while (reader.nextKey(key)) {
+                    if (key == "content" ? !reader.readString(content) : !reader.skipValue()) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return reader.atEnd();
+}
+
+void benchmarkReading() {
+    std::printf("%-24s %12s %12s %9s\n", "read", "DOM (us)", "pull (us)", "speedup");
+    struct Case {
+        const char* name;
+        std::string body;
+        const char* messageKey;
+        int iterations;
+    };
+    const Case cases[] = {
+        {"stream chunk",
+         R"({"id":"chatcmpl-1","object":"chat.completion.chunk","created":1,"model":"gpt",)"
+         R"("choices":[{"index":0,"delta":{"content":" world"},"finish_reason":null}]})",
+         "delta", 200000},
+        {"reply 200 B", completionBody(replyText(200)), "message", 50000},
+        {"reply 4 KB", completionBody(replyText(4000)), "message", 20000},
+        {"reply 64 KB", completionBody(replyText(64000)), "message", 2000},
+    };
+    for (const Case& c : cases) {
+        const double dom = measureUs(c.iterations, [&c]() { sink += readDom(c.body, c.messageKey).size(); });
+        std::string content;
+        const double pull = measureUs(c.iterations, [&c, &content]() {
+            sink += readPull(c.body, c.messageKey, content) ? content.size() : 0;
+        });
+        std::printf("%-24s %12.2f %12.2f %8.1fx\n", c.name, dom, pull, dom / pull);
+    }
+}
+
+void benchmarkWriting() {
+    std::printf("\n%-24s %12s %12s %9s\n", "write", "DOM (us)", "writer (us)", "speedup");
+    for (int turns : {2, 10, 40}) {
+        std::vector<std::pair<std::string, std::string>> messages;
+        messages.emplace_back("system", "You are a helpful voice assistant. Answer briefly.");
+        for (int i = 0; i < turns; ++i) {
+            messages.emplace_back(i % 2 ? "assistant" : "user", replyText(300));
+        }
+
+        const double dom = measureUs(20000, [&messages]() {
+            nlohmann::json body = {{"model", "gpt-3.5-turbo"}, {"temperature", 0.7}, {"max_tokens", 150}};
+            nlohmann::json& list = body["messages"] = nlohmann::json::array();
+            for (const auto& message : messages) {
+                list.push_back({{"role", message.first}, {"content", message.second}});
+            }
+            sink += body.dump().size();
+        });
+        const double writer = measureUs(20000, [&messages]() {
+            std::string body;
+            JsonWriter json(body);
+            json.beginObject().key("model").value("gpt-3.5-turbo").key("temperature").value(0.7f)
+                .key("max_tokens").value(150).key("messages").beginArray();
+            for (const auto& message : messages) {
+                json.beginObject().key("role").value(message.first).key("content").value(message.second).endObject();
+            }
+            json.endArray().endObject();
+            sink += body.size();
+        });
+        const std::string name = std::to_string(turns) + " turns";
+        std::printf("%-24s %12.2f %12.2f %8.1fx\n", name.c_str(), dom, writer, dom / writer);
+    }
+}
+
+} // namespace
+
+int main() {
+    benchmarkReading();
+    benchmarkWriting();
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,258 @@
+#ifndef AUDIO_BUFFER_H
+#define AUDIO_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace voice_assist {
+
+/**
+ * @brief Audio format specification
+ */
+struct AudioFormat {
+    int sampleRate = 16000;
+    int channels = 1;
+    int bitsPerSample = 16;
+};
+
+/**
+ * @brief Non-owning view over a contiguous run of audio samples
+ *
+ * Views handed to callbacks are only valid for the duration of the call.
+ */
+struct AudioSampleView {
+    const int16_t* data = nullptr;
+    size_t size = 0;
+
+    AudioSampleView() = default;
+    AudioSampleView(const int16_t* data, size_t size) : data(data), size(size) {}
+
+    const int16_t* begin() const { return data; }
+    const int16_t* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    int16_t operator[](size_t index) const { return data[index]; }
+};
+
+/**
+ * @brief Preallocated single-producer/single-consumer lock-free ring buffer
+ *
+ * One thread may write and one (possibly different) thread may read
+ * concurrently without locks. Capacity is rounded up to a power of two and
+ * only changes through reset(), which must not race with readers or writers.
+ */
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRingBuffer requires trivially copyable elements");
+
+public:
+    /**
+     * @brief Up to two contiguous regions covering the readable data
+     */
+    struct ReadRegion {
+        const T* first = nullptr;
+        size_t firstSize = 0;
+        const T* second = nullptr;
+        size_t secondSize = 0;
+
+        size_t size() const { return firstSize + secondSize; }
+    };
+
+    explicit SpscRingBuffer(size_t capacity = 0) {
+        reset(capacity);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /**
+     * @brief Reallocates the storage and discards any buffered data
+     */
+    void reset(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        if (capacity == 0) {
+            rounded = 0;
+        }
+        if (rounded != capacity_) {
+            buffer_.reset(rounded ? new T[rounded] : nullptr);
+            capacity_ = rounded;
+        }
+        mask_ = rounded ? rounded - 1 : 0;
+        writeIndex_.store(0, std::memory_order_relaxed);
+        readIndex_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Discards buffered data; consumer side only
+     */
+    void clear() {
+        readIndex_.store(writeIndex_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    size_t readAvailable() const {
+        return writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_acquire);
+    }
+
+    size_t writeAvailable() const {
+        return capacity_ - readAvailable();
+    }
+
+    /**
+     * @brief Copies up to count elements in; producer side only
+     * @return Number of elements actually written
+     */
+    size_t write(const T* data, size_t count) {
+        const size_t write = writeIndex_.load(std::memory_order_relaxed);
+        const size_t read = readIndex_.load(std::memory_order_acquire);
+        count = std::min(count, capacity_ - (write - read));
+        if (count == 0) {
+            return 0;
+        }
+
+        const size_t offset = write & mask_;
+        const size_t firstPart = std::min(count, capacity_ - offset);
+        std::memcpy(buffer_.get() + offset, data, firstPart * sizeof(T));
+        std::memcpy(buffer_.get(), data + firstPart, (count - firstPart) * sizeof(T));
+
+        writeIndex_.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Appends up to count value-initialized elements; producer side only
+     * @return Number of elements actually written
+     */
+    size_t writeZeros(size_t count) {
+        const size_t write = writeIndex_.load(std::memory_order_relaxed);
+        const size_t read = readIndex_.load(std::memory_order_acquire);
+        count = std::min(count, capacity_ - (write - read));
+        if (count == 0) {
+            return 0;
+        }
+
+        const size_t offset = write & mask_;
+        const size_t firstPart = std::min(count, capacity_ - offset);
+        std::fill_n(buffer_.get() + offset, firstPart, T());
+        std::fill_n(buffer_.get(), count - firstPart, T());
+
+        writeIndex_.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Copies up to count elements out; consumer side only
+     * @return Number of elements actually read
+     */
+    size_t read(T* out, size_t count) {
+        ReadRegion region = peek(count);
+        std::memcpy(out, region.first, region.firstSize * sizeof(T));
+        std::memcpy(out + region.firstSize, region.second, region.secondSize * sizeof(T));
+        consume(region.size());
+        return region.size();
+    }
+
+    /**
+     * @brief Exposes up to count readable elements without copying; consumer side only
+     *
+     * The regions stay valid until the matching consume() call.
+     */
+    ReadRegion peek(size_t count) const {
+        ReadRegion region;
+        const size_t read = readIndex_.load(std::memory_order_relaxed);
+        const size_t write = writeIndex_.load(std::memory_order_acquire);
+        count = std::min(count, write - read);
+        if (count == 0) {
+            return region;
+        }
+
+        const size_t offset = read & mask_;
+        region.first = buffer_.get() + offset;
+        region.firstSize = std::min(count, capacity_ - offset);
+        region.second = buffer_.get();
+        region.secondSize = count - region.firstSize;
+        return region;
+    }
+
+    /**
+     * @brief Releases elements previously exposed by peek(); consumer side only
+     */
+    void consume(size_t count) {
+        const size_t read = readIndex_.load(std::memory_order_relaxed);
+        count = std::min(count, writeIndex_.load(std::memory_order_acquire) - read);
+        readIndex_.store(read + count, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<T[]> buffer_;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+
+    // Keep producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> writeIndex_{0};
+    alignas(64) std::atomic<size_t> readIndex_{0};
+};
+
+/**
+ * @brief Fixed-size, zero-initialized heap buffer aligned for SIMD loads
+ *
+ * Used for DSP working memory that is sized once and reused for every frame.
+ */
+template <typename T, size_t Alignment = 64>
+class AlignedBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer requires trivially copyable elements");
+
+public:
+    AlignedBuffer() = default;
+
+    explicit AlignedBuffer(size_t size) {
+        resize(size);
+    }
+
+    /**
+     * @brief Reallocates the buffer and zeroes it
+     */
+    void resize(size_t size) {
+        data_.reset(size ? static_cast<T*>(::operator new[](size * sizeof(T), std::align_val_t(Alignment))) : nullptr);
+        size_ = size;
+        clear();
+    }
+
+    /**
+     * @brief Zeroes the contents
+     */
+    void clear() {
+        if (size_) {
+            std::memset(data_.get(), 0, size_ * sizeof(T));
+        }
+    }
+
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+    size_t size() const { return size_; }
+    T& operator[](size_t index) { return data_[index]; }
+    const T& operator[](size_t index) const { return data_[index]; }
+
+private:
+    struct Deleter {
+        void operator()(T* pointer) const {
+            ::operator delete[](pointer, std::align_val_t(Alignment));
+        }
+    };
+
+    std::unique_ptr<T[], Deleter> data_;
+    size_t size_ = 0;
+};
+
+} // namespace voice_assist
+
+#endif // AUDIO_BUFFER_H
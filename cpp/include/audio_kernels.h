@@ -0,0 +1,83 @@
+#ifndef AUDIO_KERNELS_H
+#define AUDIO_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace voice_assist {
+namespace kernels {
+
+/**
+ * @brief Name of the instruction set the kernels were compiled for
+ *
+ * One of "avx2", "sse2", "neon" or "scalar". The path is chosen at compile
+ * time; configure with -DENABLE_AVX2=ON to build the AVX2 variant.
+ */
+const char* instructionSet();
+
+/**
+ * @brief Converts int16 samples to floats in [-1, 1)
+ */
+void int16ToFloat(const int16_t* in, float* out, size_t count);
+
+/**
+ * @brief Converts floats in [-1, 1] to int16 samples, rounding and saturating
+ */
+void floatToInt16(const float* in, int16_t* out, size_t count);
+
+/**
+ * @brief Multiplies samples by a linear gain, saturating at the int16 range
+ *
+ * in and out may alias.
+ */
+void applyGain(const int16_t* in, int16_t* out, size_t count, float gain);
+
+/**
+ * @brief Largest absolute sample value; 32768 for a full-scale negative sample
+ */
+int32_t peakAbs(const int16_t* samples, size_t count);
+
+/**
+ * @brief Exact sum of squared samples
+ */
+uint64_t sumSquares(const int16_t* samples, size_t count);
+
+/**
+ * @brief Root-mean-square level in sample units
+ */
+float rms(const int16_t* samples, size_t count);
+
+/**
+ * @brief Dot product of two float vectors
+ */
+float dotProduct(const float* a, const float* b, size_t count);
+
+/**
+ * @brief y += scale * x
+ */
+void multiplyAdd(float* y, const float* x, float scale, size_t count);
+
+/**
+ * @brief Splits interleaved frames into one plane per channel
+ */
+void deinterleave(const int16_t* in, int16_t* const* planes, size_t channels, size_t frames);
+
+/**
+ * @brief Converts interleaved frames between channel counts
+ *
+ * Mono is duplicated into every output channel and any layout downmixes to
+ * mono by averaging. Otherwise output channel c averages the input channels
+ * congruent to c, or repeats input channel c modulo the input count.
+ * in and out must not overlap unless the channel counts match.
+ */
+void mixChannels(const int16_t* in, size_t inChannels, int16_t* out, size_t outChannels, size_t frames);
+
+/**
+ * @brief Merges one plane per channel into interleaved frames
+ */
+void interleave(const int16_t* const* planes, int16_t* out, size_t channels, size_t frames);
+
+} // namespace kernels
+} // namespace voice_assist
+
+#endif // AUDIO_KERNELS_H
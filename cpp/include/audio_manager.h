@@ -1,21 +1,30 @@
 #ifndef AUDIO_MANAGER_H
 #define AUDIO_MANAGER_H
 
+#include "audio_buffer.h"
+#include "echo_canceller.h"
+#include "format_converter.h"
+#include "noise_suppressor.h"
+#include "playback_queue.h"
+
 #include <string>
 #include <vector>
 #include <functional>
 #include <memory>
 #include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace voice_assist {
 
 /**
- * @brief Audio format specification
+ * @brief Selects the implementation returned by createAudioManager
  */
-struct AudioFormat {
-    int sampleRate = 16000;
-    int channels = 1;
-    int bitsPerSample = 16;
+enum class AudioBackend {
+    PLATFORM,  // Native capture and playback devices
+    FILE       // Memory-mapped WAV/raw files, for headless and replay runs
 };
 
 /**
@@ -26,7 +35,28 @@ struct AudioConfig {
     float gainLevel = 1.0f;
     bool echoCancellation = true;
     bool noiseSuppression = true;
+    int echoTailMs = 200;        // Longest playback-to-capture delay the echo canceller covers
     int bufferSizeMs = 100;
+    int captureBufferFrames = 16;
+    int preRollMs = 500;         // Processed capture history kept for consumers that start late
+    int playbackQueueMs = 10000; // Audio that may be queued for playback before writers block
+    int playbackPrebufferMs = 60; // Jitter buffer filled before a stream starts playing
+    
+    // FILE backend options
+    AudioBackend backend = AudioBackend::PLATFORM;
+    std::string inputFile;       // WAV, or raw PCM in `format`
+    std::string outputFile;      // WAV receiving all playback; empty discards it
+    bool fileRealTime = true;    // Pace the input at real time instead of as fast as possible
+};
+
+/**
+ * @brief Counters describing the health of the capture ring buffer
+ */
+struct CaptureStats {
+    uint64_t deliveredFrames = 0;
+    uint64_t overruns = 0;
+    uint64_t droppedSamples = 0;
+    uint64_t underruns = 0;
 };
 
 /**
@@ -34,7 +64,7 @@ struct AudioConfig {
  */
 class AudioManager {
 public:
-    using AudioSampleCallback = std::function<void(const std::vector<int16_t>&, bool)>;
+    using AudioSampleCallback = std::function<void(AudioSampleView, bool)>;
     
     AudioManager(const AudioConfig& config = AudioConfig());
     virtual ~AudioManager();
@@ -42,7 +72,8 @@ public:
     /**
      * @brief Starts audio recording
      * 
-     * @param callback Function to call with audio samples
+     * @param callback Function to call with each captured frame; the view
+     *                 points into the capture ring and is only valid during the call
      * @return bool Success or failure
      */
     virtual bool startRecording(AudioSampleCallback callback) = 0;
@@ -58,13 +89,64 @@ public:
     virtual bool isRecording() const;
     
     /**
-     * @brief Plays back audio data
+     * @brief Plays back audio data and waits until it has been played
      * 
      * @param audioData Vector of audio samples to play
      * @param format Format of the audio data
-     * @return bool Success or failure
+     * @return bool Success or failure; false if the clip was flushed
      */
-    virtual bool playAudio(const std::vector<int16_t>& audioData, const AudioFormat& format = AudioFormat()) = 0;
+    virtual bool playAudio(const std::vector<int16_t>& audioData, const AudioFormat& format = AudioFormat());
+    
+    /**
+     * @brief Queues a whole clip for playback and returns immediately
+     * 
+     * @return Handle to wait on, or 0 on failure
+     */
+    PlaybackHandle queueAudio(const std::vector<int16_t>& audioData, const AudioFormat& format = AudioFormat());
+    
+    /**
+     * @brief Starts a playback stream that audio can be written to as it is produced
+     * 
+     * The first stream opened fixes the output format; later streams in other
+     * formats are converted to it.
+     * @return Handle, or 0 if the output device could not be started
+     */
+    PlaybackHandle openPlayback(const AudioFormat& format = AudioFormat());
+    
+    /**
+     * @brief Appends samples to an open playback stream without waiting for them to play
+     * 
+     * @return false if the stream is unknown, closed or was flushed
+     */
+    bool writePlayback(PlaybackHandle handle, AudioSampleView samples);
+    
+    /**
+     * @brief Ends a playback stream; its remaining audio still plays
+     */
+    void closePlayback(PlaybackHandle handle);
+    
+    /**
+     * @brief Blocks until a closed stream has been played
+     * 
+     * @param timeoutMs Negative waits indefinitely
+     * @return true if it played to the end
+     */
+    bool waitPlayback(PlaybackHandle handle, int timeoutMs = -1);
+    
+    /**
+     * @brief Stops all playback within one buffer period and cancels every stream
+     */
+    void flushPlayback();
+    
+    /**
+     * @brief Checks whether audio is queued or a playback stream is open
+     */
+    bool isPlaying() const;
+    
+    /**
+     * @brief Gets the playback queue counters
+     */
+    PlaybackStats getPlaybackStats() const;
     
     /**
      * @brief Converts text to speech and plays it
@@ -75,6 +157,16 @@ public:
      */
     virtual bool speak(const std::string& text, const std::string& voice = "") = 0;
     
+    /**
+     * @brief Converts text to speech without waiting for it to be played
+     * 
+     * Engines that synthesize PCM write it to a playback stream as it is
+     * produced, so output starts once the jitter buffer fills. The default
+     * falls back to speak() for engines that play by themselves.
+     * @return Handle of the playback stream, or 0 if nothing was queued
+     */
+    virtual PlaybackHandle speakAsync(const std::string& text, const std::string& voice = "");
+    
     /**
      * @brief Sets the audio configuration
      */
@@ -84,15 +176,180 @@ public:
      * @brief Gets the current configuration
      */
     const AudioConfig& getConfig() const;
+    
+    /**
+     * @brief Gets the capture ring buffer counters
+     */
+    CaptureStats getCaptureStats() const;
+    
+    /**
+     * @brief Hands the last preRollMs of captured audio to sink, oldest first, and empties it
+     * 
+     * Call from inside the sample callback only. The frame being delivered is
+     * not part of the pre-roll yet. The views are only valid during the call.
+     * @return Number of samples handed over
+     */
+    size_t drainPreRoll(const std::function<void(AudioSampleView)>& sink);
 
 protected:
     AudioConfig config_;
     bool recording_ = false;
     AudioSampleCallback callback_;
+    
+    /**
+     * @brief Number of interleaved samples in one bufferSizeMs capture frame
+     */
+    size_t captureFrameSamples() const;
+    
+    /**
+     * @brief Largest chunk the backend hands to dispatchCaptureSamples()
+     *
+     * Sizes the processing scratch, so that nothing is allocated on the
+     * capture thread. Defaults to captureFrameSamples().
+     */
+    virtual size_t captureChunkSamples() const;
+    
+    /**
+     * @brief Sizes the capture ring from the config and resets the counters
+     *
+     * Must be called before the capture thread starts.
+     */
+    void prepareCaptureBuffer();
+    
+    /**
+     * @brief Queues captured samples; called from the device thread only
+     *
+     * Never blocks. Samples that do not fit are dropped and counted as an overrun.
+     * @return Number of samples queued
+     */
+    size_t pushCaptureSamples(const int16_t* samples, size_t count);
+    
+    /**
+     * @brief Queues count samples of silence in place of audio the device lost
+     *
+     * Keeps the capture timeline in step with the far-end reference. Same
+     * rules as pushCaptureSamples().
+     */
+    size_t pushCaptureSilence(size_t count);
+    
+    /**
+     * @brief Checks whether a full frame is waiting in the capture ring
+     */
+    bool hasCaptureFrame() const;
+    
+    /**
+     * @brief Hands the next frame to the sample callback; called from the consumer thread only
+     *
+     * @param isFinal Flush whatever is buffered, even if it is less than a frame
+     * @return true if a frame was delivered
+     */
+    bool deliverCaptureFrame(bool isFinal = false);
+    
+    /**
+     * @brief Hands samples to the sample callback without going through the ring
+     *
+     * For backends whose input is already resident in memory.
+     */
+    void dispatchCaptureSamples(AudioSampleView samples, bool isFinal);
+    
+    /**
+     * @brief Starts pulling audio from the playback queue with renderPlayback()
+     *
+     * Called once, when the first stream is opened. The default runs a thread
+     * that renders one bufferSizeMs period at a time and hands the audio to
+     * writePlaybackDevice(), paced at real time if isPlaybackRealTime().
+     */
+    virtual bool startPlaybackDevice(const AudioFormat& format);
+    
+    /**
+     * @brief Stops the device started by startPlaybackDevice()
+     */
+    virtual void stopPlaybackDevice();
+    
+    /**
+     * @brief Receives the audio rendered by the default playback thread
+     *
+     * Only the part that came from the queue is passed, never underrun silence.
+     */
+    virtual void writePlaybackDevice(AudioSampleView samples);
+    
+    /**
+     * @brief Chooses whether the default playback thread runs at real-time pace
+     */
+    virtual bool isPlaybackRealTime() const;
+    
+    /**
+     * @brief Called after flushPlayback() so the device can drop its own buffered audio
+     */
+    virtual void onPlaybackFlushed();
+    
+    /**
+     * @brief Fills out with the next samples to play; called from the device thread only
+     *
+     * Never blocks. Rendered audio is also queued as the echo canceller's far-end reference.
+     * @return Number of samples that came from the queue; the rest is silence
+     */
+    size_t renderPlayback(int16_t* out, size_t count);
+    
+    /**
+     * @brief Stops the playback device and discards the queue
+     *
+     * Derived destructors must call this, since the device calls back into them.
+     */
+    void shutdownPlayback();
+    
+    /**
+     * @brief Queues samples handed to the output device as the echo canceller's far-end reference
+     *
+     * Called from the device thread only, in the playback queue's format, so
+     * the reference is queued in step with the device. Never blocks or
+     * allocates: the samples are copied into a preallocated ring, and the
+     * capture thread converts them to the capture rate and mixes them down
+     * to mono before the next frame is cancelled. Chunks that do not fit are
+     * dropped.
+     */
+    void submitFarEnd(const int16_t* samples, size_t count);
+
+private:
+    SpscRingBuffer<int16_t> captureBuffer_;
+    SpscRingBuffer<int16_t> preRoll_;   // Written and read on the consumer thread only
+    size_t preRollSamples_ = 0;
+    std::vector<int16_t> frameScratch_;
+    std::vector<int16_t> processScratch_;
+    std::unique_ptr<NoiseSuppressor> noiseSuppressor_;
+    std::unique_ptr<EchoCanceller> echoCanceller_;
+    
+    // Far-end reference on its way from the device thread to the capture
+    // thread. Set up with the playback queue and published by farEndReady_;
+    // the converter and scratch belong to the capture thread.
+    SpscRingBuffer<int16_t> farEndBuffer_;
+    AudioFormat farEndFormat_;
+    std::unique_ptr<FormatConverter> farEndConverter_;
+    std::vector<int16_t> farEndScratch_;
+    std::atomic<bool> farEndReady_{false};
+    std::atomic<uint64_t> deliveredFrames_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> droppedSamples_{0};
+    std::atomic<uint64_t> underruns_{0};
+    
+    std::shared_ptr<PlaybackQueue> playbackQueue_;  // Shared with callers still using it
+    mutable std::mutex playbackMutex_;  // Guards creating and destroying the queue
+    std::thread playbackThread_;
+    std::atomic<bool> playbackRunning_{false};
+    std::mutex playbackWakeMutex_;
+    std::condition_variable playbackWake_;
+    
+    AudioSampleView processCapture(AudioSampleView samples);
+    void openFarEnd(const AudioFormat& format);
+    void createFarEndConverter();
+    void drainFarEnd();
+    void appendPreRoll(AudioSampleView samples);
+    std::shared_ptr<PlaybackQueue> getPlaybackQueue() const;
+    void playbackLoop();
 };
 
 /**
- * @brief Creates a platform-specific audio manager instance
+ * @brief Creates an audio manager for the configured backend
  */
 std::unique_ptr<AudioManager> createAudioManager(const AudioConfig& config = AudioConfig());
 
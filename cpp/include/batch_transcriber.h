@@ -0,0 +1,87 @@
+#ifndef BATCH_TRANSCRIBER_H
+#define BATCH_TRANSCRIBER_H
+
+#include "audio_manager.h"
+#include "feature_frontend.h"
+#include "voice_recognizer.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Configuration for offline transcription of recordings
+ */
+struct BatchConfig {
+    int workers = 0;                   // 0 runs one worker per hardware thread
+    AudioConfig audio;                 // Format and preprocessing applied to every file
+    VoiceRecognizerConfig recognizer;
+    FeatureConfig features;            // sampleRate is taken from audio.format
+};
+
+/**
+ * @brief Outcome of transcribing one file
+ */
+struct BatchResult {
+    std::string file;
+    std::string text;                  // Final results joined by spaces
+    bool ok = false;
+    std::string error;
+    double audioMs = 0.0;
+    double elapsedMs = 0.0;
+};
+
+/**
+ * @brief Transcribes many recordings in parallel without sound hardware
+ *
+ * Files are handed out one at a time to a pool of worker threads, each with
+ * its own recognizer instance and feature frontend, so nothing is shared on
+ * the audio path. Every file is read through the file audio backend as fast
+ * as the recognizer accepts it, with the same conversion and preprocessing
+ * as live capture, and fed through VoiceRecognizer::processAudio() and
+ * processFeatures(). Engines that cannot take pushed audio, such as those
+ * that listen to a microphone, fail every file rather than attribute room
+ * audio or nothing to it.
+ */
+class BatchTranscriber {
+public:
+    using ResultCallback = std::function<void(const BatchResult&)>;
+
+    explicit BatchTranscriber(const BatchConfig& config = BatchConfig());
+
+    /**
+     * @brief Lists the recordings to transcribe
+     *
+     * @param path A directory, searched recursively for .wav, .raw and .pcm
+     *             files, or a manifest with one path per line; blank lines
+     *             and lines starting with '#' are skipped, and relative
+     *             paths are taken relative to the manifest
+     * @return Paths in a stable order; empty if nothing was found
+     */
+    static std::vector<std::string> collectInputs(const std::string& path);
+
+    /**
+     * @brief Transcribes the files and blocks until all are done
+     *
+     * @param onResult Called once per file, in completion order; calls are
+     *                 serialized
+     * @return Number of files transcribed without error
+     */
+    size_t run(const std::vector<std::string>& files, const ResultCallback& onResult);
+
+    /**
+     * @brief Formats a result as one line of JSON, without the newline
+     */
+    static std::string toJsonLine(const BatchResult& result);
+
+private:
+    BatchConfig config_;
+
+    BatchResult transcribeFile(const std::string& path, VoiceRecognizer& recognizer, FeatureFrontend* frontend);
+};
+
+} // namespace voice_assist
+
+#endif // BATCH_TRANSCRIBER_H
@@ -0,0 +1,96 @@
+#ifndef ECHO_CANCELLER_H
+#define ECHO_CANCELLER_H
+
+#include "audio_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace voice_assist {
+
+/**
+ * @brief Streaming single-channel acoustic echo canceller
+ *
+ * Estimates the speaker-to-microphone echo path with a time-domain NLMS
+ * filter and subtracts the predicted echo from the capture signal. A second,
+ * fixed copy of the weights produces the output and is only refreshed when
+ * the adapting filter does better; together with a coupling-based double-talk
+ * detector this keeps near-end speech from corrupting the echo path estimate.
+ * Far-end samples queued with pushFarEnd() are paired one-to-one with
+ * near-end samples in process() on the capture thread, so far-end
+ * audio submitted before the device plays it lands early in the history,
+ * where the filter tail absorbs the delay. When no far-end audio is queued
+ * the reference is silence and the filter is bypassed.
+ *
+ * The far-end history is a fixed circular buffer stored twice over, so the
+ * newest tail window is always contiguous for the SIMD dot products. All
+ * memory is allocated in the constructor.
+ */
+class EchoCanceller {
+public:
+    /**
+     * @param sampleRate Rate of both the near-end and far-end signals
+     * @param tailMs Longest echo delay, including device buffering, that can be cancelled
+     * @param queueMs Far-end audio that may be queued ahead of capture before it is dropped
+     */
+    explicit EchoCanceller(int sampleRate = 16000, int tailMs = 200, int queueMs = 2000);
+
+    /**
+     * @brief Queues far-end (loudspeaker) samples; called from one producer thread only
+     *
+     * Never blocks. Samples that do not fit are dropped.
+     * @return Number of samples queued
+     */
+    size_t pushFarEnd(const int16_t* samples, size_t count);
+
+    /**
+     * @brief Removes the echo from captured samples; called from the capture thread only
+     *
+     * in and out may alias.
+     */
+    void process(const int16_t* in, int16_t* out, size_t count);
+
+    /**
+     * @brief Forgets the echo path and discards queued far-end audio
+     *
+     * Called from the capture thread, or while capture is stopped.
+     */
+    void reset();
+
+    /**
+     * @brief Number of filter taps
+     */
+    size_t tailSamples() const;
+
+private:
+    size_t taps_;
+    size_t position_ = 0;        // Index of the newest sample in history_
+    size_t silentSamples_ = 0;   // Consecutive silent far-end samples
+    float farEnergy_ = 0.0f;     // Sum of squares over the filter window
+    float errorScale_ = 0.0f;    // Typical background error magnitude
+    float coupling_ = 0.0f;      // Learned echo power / far-end power
+
+    // Signal and residual powers over the current comparison block
+    size_t blockFill_ = 0;
+    float farPower_ = 0.0f;
+    float echoPower_ = 0.0f;
+    float nearPower_ = 0.0f;
+    float foregroundPower_ = 0.0f;
+    float backgroundPower_ = 0.0f;
+
+    SpscRingBuffer<int16_t> farEndQueue_;
+    AlignedBuffer<float> foreground_;   // Weights producing the output
+    AlignedBuffer<float> background_;   // Continuously adapting NLMS weights
+    AlignedBuffer<float> history_;      // 2 * taps_; newest-first window at position_
+    AlignedBuffer<int16_t> farScratch_;
+    AlignedBuffer<float> nearScratch_;
+    AlignedBuffer<float> farFloat_;
+
+    void processChunk(const int16_t* in, int16_t* out, size_t count);
+    void pushHistory(float sample);
+    void compareFilters();
+};
+
+} // namespace voice_assist
+
+#endif // ECHO_CANCELLER_H
@@ -0,0 +1,108 @@
+#ifndef ENDPOINT_ROUTER_H
+#define ENDPOINT_ROUTER_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Routing counters and estimates for one endpoint
+ */
+struct EndpointStats {
+    std::string baseUrl;
+    double latencyMs = 0.0;     // Smoothed time to first byte; 0 until measured
+    double p95Ms = 0.0;         // Over recent samples; 0 until there are enough
+    double errorRate = 0.0;     // Smoothed share of attempts that failed
+    uint64_t attempts = 0;      // Sent and not canceled before answering, hedges included
+    uint64_t failures = 0;      // Transport errors, 429s and 5xx responses
+    uint64_t wins = 0;          // Attempts whose response was used
+    bool healthy = true;        // False while cooling down after repeated failures
+};
+
+/**
+ * @brief Picks among equivalent API endpoints by latency and health
+ *
+ * Each endpoint keeps an exponentially weighted moving average of its time
+ * to first byte and of its error rate, plus a window of recent samples for
+ * the p95 that hedged requests wait before trying another endpoint.
+ * Requests go to the healthy endpoint with the lowest latency, inflated by
+ * its error rate. Endpoints never tried, or not heard from for a while,
+ * are tried first so that a slow spell is not remembered forever. Several
+ * failures in a row take an endpoint out of rotation for a cooldown that
+ * doubles each time, after which one request probes it again. All methods
+ * are thread-safe.
+ */
+class EndpointRouter {
+public:
+    struct Endpoint;  // Defined in endpoint_router.cpp
+    using EndpointPtr = std::shared_ptr<Endpoint>;
+
+    explicit EndpointRouter(const std::vector<std::string>& baseUrls);
+    ~EndpointRouter();
+
+    /**
+     * @brief Replaces the endpoint list, keeping what is known about URLs still in it
+     *
+     * Endpoints handed out earlier stay valid; reports about removed ones
+     * are ignored.
+     */
+    void setEndpoints(const std::vector<std::string>& baseUrls);
+
+    /**
+     * @brief Picks the endpoint for a request
+     * @param exclude Endpoint already tried, for choosing a hedge
+     * @return Null if there are no endpoints, or no other healthy one when
+     *         exclude is given
+     */
+    EndpointPtr choose(const EndpointPtr& exclude = nullptr);
+
+    static const std::string& baseUrl(const EndpointPtr& endpoint);
+
+    /**
+     * @brief How long to wait for endpoint to start answering before hedging
+     *
+     * The p95 of its recent times to first byte, or fallbackMs until enough
+     * have been seen.
+     */
+    double hedgeDelayMs(const EndpointPtr& endpoint, double fallbackMs);
+
+    /**
+     * @brief Records the time an attempt took to start answering
+     */
+    void reportLatency(const EndpointPtr& endpoint, double ms);
+
+    /**
+     * @brief Records how an attempt ended
+     * @param failed The endpoint did not answer, or answered 429 or 5xx
+     * @param won The attempt's response was the one used
+     */
+    void reportResult(const EndpointPtr& endpoint, bool failed, bool won);
+
+    /**
+     * @brief Records an attempt that lost a hedge after waiting waitedMs
+     *
+     * A wait longer than the endpoint's latency estimate counts as a
+     * sample: it understates the latency, but ignoring it would hide
+     * exactly the slowness that hedging works around.
+     */
+    void reportLoss(const EndpointPtr& endpoint, double waitedMs);
+
+    size_t size() const;
+    std::vector<EndpointStats> getStats() const;
+
+private:
+    mutable std::mutex mutex_;          // Guards endpoints_ and every Endpoint's fields
+    std::vector<EndpointPtr> endpoints_;
+    size_t next_ = 0;                   // Rotates ties among unmeasured endpoints
+
+    void addSample(Endpoint& endpoint, double ms);
+    bool healthy(const Endpoint& endpoint) const;
+};
+
+} // namespace voice_assist
+
+#endif // ENDPOINT_ROUTER_H
@@ -0,0 +1,174 @@
+#ifndef FEATURE_FRONTEND_H
+#define FEATURE_FRONTEND_H
+
+#include "audio_buffer.h"
+#include "fft.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Configuration options for acoustic feature extraction
+ */
+struct FeatureConfig {
+    int sampleRate = 16000;
+    size_t melBands = 40;
+    size_t cepstra = 0;          // MFCCs appended to each frame; 0 skips the DCT
+    float preEmphasis = 0.97f;   // First-order high-pass coefficient; 0 disables it
+};
+
+/**
+ * @brief History of feature frames in one contiguous, cache-aligned block
+ *
+ * Rows are padded to a multiple of 64 bytes so every frame starts on its own
+ * cache line and can be handed to SIMD kernels directly. Frames are numbered
+ * from the start of the stream; the matrix keeps the most recent capacity()
+ * of them and overwrites the oldest. Single-threaded: the producer and all
+ * readers run on the capture thread.
+ */
+class FeatureMatrix {
+public:
+    FeatureMatrix(size_t dimension, size_t capacity);
+
+    /**
+     * @brief Values used in each row
+     */
+    size_t dimension() const;
+
+    /**
+     * @brief Distance in floats between consecutive rows
+     */
+    size_t stride() const;
+
+    size_t capacity() const;
+
+    /**
+     * @brief Number of frames produced so far; the next frame gets this index
+     */
+    uint64_t frameCount() const;
+
+    /**
+     * @brief Index of the oldest frame still held
+     */
+    uint64_t oldestFrame() const;
+
+    /**
+     * @brief Features of a held frame
+     */
+    const float* row(uint64_t frame) const;
+
+    /**
+     * @brief Energy of the hop that completed a held frame, in dBFS
+     */
+    float levelDb(uint64_t frame) const;
+
+    /**
+     * @brief Forgets all frames
+     */
+    void clear();
+
+private:
+    friend class FeatureFrontend;
+
+    size_t dimension_;
+    size_t stride_;
+    size_t capacity_;
+    uint64_t frameCount_ = 0;
+    AlignedBuffer<float> rows_;
+    std::vector<float> levels_;
+
+    float* appendRow(float levelDb);
+};
+
+/**
+ * @brief Streaming log-mel / MFCC feature extractor
+ *
+ * Pre-emphasizes mono input, cuts it into 25 ms Hann-windowed frames every
+ * 10 ms and reduces each power spectrum to log energies in triangular mel
+ * bands between 20 Hz and 7.6 kHz. With FeatureConfig::cepstra set, a DCT-II
+ * of those energies follows them in the same row, so stages that want
+ * log-mel and stages that want MFCCs share one frame. The filterbank and
+ * DCT matrices are built once in the constructor; the filterbank is stored
+ * sparsely, one contiguous weight run per band, so each band and each
+ * coefficient is a single SIMD dot product. Frames are written into a
+ * FeatureMatrix as soon as their last hop arrives; nothing is allocated
+ * after construction.
+ */
+class FeatureFrontend {
+public:
+    using FrameCallback = std::function<void(const float*)>;
+
+    /**
+     * @param historyFrames Frames kept in the feature matrix
+     */
+    explicit FeatureFrontend(const FeatureConfig& config = FeatureConfig(), size_t historyFrames = 100);
+
+    const FeatureConfig& getConfig() const;
+
+    /**
+     * @brief Number of log-mel values at the start of each frame
+     */
+    size_t bands() const;
+
+    /**
+     * @brief Number of values in each frame: the log-mel bands, then the cepstra
+     */
+    size_t dimension() const;
+
+    /**
+     * @brief Samples between the starts of consecutive frames
+     */
+    size_t hopSamples() const;
+
+    /**
+     * @brief Frames computed so far
+     */
+    const FeatureMatrix& features() const;
+
+    /**
+     * @brief Consumes mono samples of any count
+     *
+     * @param onFrame Optionally called with each frame completed; the pointer
+     *                is a row of features()
+     * @return Number of frames completed
+     */
+    size_t process(AudioSampleView samples, const FrameCallback& onFrame = FrameCallback());
+
+    /**
+     * @brief Clears the signal history and the feature matrix
+     */
+    void reset();
+
+private:
+    FeatureConfig config_;
+    size_t hop_;
+    size_t window_;
+    Fft fft_;
+    FeatureMatrix matrix_;
+    size_t hopFill_ = 0;
+    float lastSample_ = 0.0f;            // Pre-emphasis state
+
+    AlignedBuffer<float> hann_;
+    AlignedBuffer<float> history_;       // Last window_ pre-emphasized samples
+    AlignedBuffer<float> frame_;         // Windowed, zero-padded FFT input
+    AlignedBuffer<float> real_;
+    AlignedBuffer<float> imag_;
+    AlignedBuffer<float> power_;
+    AlignedBuffer<float> melWeights_;    // Every band's weights, back to back
+    AlignedBuffer<float> dct_;           // cepstra x bandStride_, orthonormal DCT-II
+    AlignedBuffer<int16_t> hopInput_;
+    std::vector<uint32_t> melFirstBin_;
+    std::vector<uint32_t> melBinCount_;
+    std::vector<uint32_t> melOffset_;    // Start of each band in melWeights_
+    size_t bandStride_ = 0;
+
+    void processHop(float* out);
+};
+
+} // namespace voice_assist
+
+#endif // FEATURE_FRONTEND_H
@@ -0,0 +1,73 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include "audio_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Real-input FFT of a fixed power-of-two size
+ *
+ * Twiddles and the bit-reversal permutation are computed once in the
+ * constructor; transforms never allocate. Spectra use a split layout
+ * (separate real and imaginary arrays of size()/2 + 1 bins) so per-bin
+ * loops vectorize cleanly.
+ */
+class Fft {
+public:
+    explicit Fft(size_t size = 512);
+
+    /**
+     * @brief Transform length in samples
+     */
+    size_t size() const;
+
+    /**
+     * @brief Number of spectrum bins, size() / 2 + 1
+     */
+    size_t bins() const;
+
+    /**
+     * @brief Forward transform, unnormalized
+     *
+     * @param input size() real samples
+     * @param real bins() real parts
+     * @param imag bins() imaginary parts
+     */
+    void forward(const float* input, float* real, float* imag);
+
+    /**
+     * @brief Inverse transform, scaled so that inverse(forward(x)) == x
+     *
+     * @param real bins() real parts
+     * @param imag bins() imaginary parts
+     * @param output size() real samples
+     */
+    void inverse(const float* real, const float* imag, float* output);
+
+    /**
+     * @brief Smallest power of two that is at least minimum
+     */
+    static size_t nextPowerOfTwo(size_t minimum);
+
+private:
+    size_t size_;
+    size_t half_;
+    std::vector<uint32_t> bitReverse_;
+    AlignedBuffer<float> twiddleReal_;   // e^{-2*pi*i*k/half} for the complex stage
+    AlignedBuffer<float> twiddleImag_;
+    AlignedBuffer<float> splitReal_;     // e^{-2*pi*i*k/size} for the real/complex split
+    AlignedBuffer<float> splitImag_;
+    AlignedBuffer<float> workReal_;
+    AlignedBuffer<float> workImag_;
+
+    void transform(float* real, float* imag);
+};
+
+} // namespace voice_assist
+
+#endif // FFT_H
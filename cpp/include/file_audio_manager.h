@@ -0,0 +1,84 @@
+#ifndef FILE_AUDIO_MANAGER_H
+#define FILE_AUDIO_MANAGER_H
+
+#include "audio_manager.h"
+#include "mapped_file.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace voice_assist {
+
+/**
+ * @brief Audio manager backed by memory-mapped files instead of sound hardware
+ *
+ * Capture streams PCM from AudioConfig::inputFile (WAV or raw) either at
+ * real-time pace or as fast as the consumer accepts it, converted to
+ * AudioConfig::format when the file differs. Playback is rendered from the
+ * playback queue, at real-time pace unless fileRealTime is off, and appended
+ * to AudioConfig::outputFile as a WAV file in the format of the first clip.
+ * Useful for headless load tests and for replaying recorded utterances
+ * deterministically.
+ */
+class FileAudioManager : public AudioManager {
+public:
+    explicit FileAudioManager(const AudioConfig& config = AudioConfig());
+    ~FileAudioManager() override;
+
+    bool startRecording(AudioSampleCallback callback) override;
+    void stopRecording() override;
+    bool speak(const std::string& text, const std::string& voice = "") override;
+
+    /**
+     * @brief Gets the format of the input file, valid after startRecording
+     */
+    const AudioFormat& getInputFormat() const;
+
+    /**
+     * @brief Checks whether the whole input file has been delivered
+     */
+    bool isInputFinished() const;
+
+    /**
+     * @brief Blocks until the whole input file has been delivered or recording stops
+     */
+    void waitForInputEnd();
+
+protected:
+    bool startPlaybackDevice(const AudioFormat& format) override;
+    void writePlaybackDevice(AudioSampleView samples) override;
+    bool isPlaybackRealTime() const override;
+    size_t captureChunkSamples() const override;
+
+private:
+    MappedFile input_;
+    MappedFile output_;
+    AudioFormat inputFormat_;
+    const int16_t* inputSamples_ = nullptr;
+    size_t inputSampleCount_ = 0;
+    std::vector<int16_t> unalignedCopy_;
+    std::unique_ptr<FormatConverter> inputConverter_;  // File format to AudioConfig::format
+
+    AudioFormat outputFormat_;
+    size_t outputDataBytes_ = 0;
+    bool outputFailed_ = false;  // Reopening would truncate what was written
+    std::mutex outputMutex_;
+
+    std::thread streamThread_;
+    std::atomic<bool> streaming_{false};       // Changed under streamMutex_; read without it
+    std::atomic<bool> inputFinished_{false};   // Likewise
+    std::mutex streamMutex_;
+    std::condition_variable streamCondition_;
+
+    bool openInput();
+    size_t inputFrameSamples() const;
+    void streamLoop();
+    bool openOutput(const AudioFormat& format);
+    void finalizeOutput();
+};
+
+} // namespace voice_assist
+
+#endif // FILE_AUDIO_MANAGER_H
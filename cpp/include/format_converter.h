@@ -0,0 +1,71 @@
+#ifndef FORMAT_CONVERTER_H
+#define FORMAT_CONVERTER_H
+
+#include "audio_buffer.h"
+#include "resampler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Streaming conversion between two interleaved 16-bit PCM formats
+ *
+ * Combines channel mixing with the polyphase Resampler. Downmixing happens
+ * before resampling and upmixing after, so the filter always runs on the
+ * smaller channel count. Conversion is chunked and stateful: feed a stream
+ * piece by piece and pass isFinal with the last piece to drain the filter.
+ * The output buffer is reused between calls and only grows.
+ */
+class FormatConverter {
+public:
+    /**
+     * @throws std::invalid_argument for non-positive rates or channel counts
+     */
+    FormatConverter(const AudioFormat& from, const AudioFormat& to);
+
+    /**
+     * @brief Checks whether the formats match and samples pass through untouched
+     */
+    bool isPassthrough() const;
+
+    const AudioFormat& inputFormat() const;
+    const AudioFormat& outputFormat() const;
+
+    /**
+     * @brief Upper bound on the samples convert() returns for inputSamples,
+     *        including a final flush
+     */
+    size_t maxOutputSamples(size_t inputSamples) const;
+
+    /**
+     * @brief Converts the next piece of the stream
+     *
+     * A trailing partial frame is ignored.
+     * @param isFinal Also emit the samples held back by the resampler and reset
+     * @return View of the input when passing through, otherwise of an internal
+     *         buffer; valid until the next call
+     */
+    AudioSampleView convert(AudioSampleView input, bool isFinal = false);
+
+    /**
+     * @brief Discards the resampler state
+     */
+    void reset();
+
+private:
+    AudioFormat from_;
+    AudioFormat to_;
+    size_t resampleChannels_;
+    std::unique_ptr<Resampler> resampler_;
+    std::vector<int16_t> mixed_;    // One chunk at the resampled channel count
+    std::vector<int16_t> resampled_;
+    std::vector<int16_t> output_;
+};
+
+} // namespace voice_assist
+
+#endif // FORMAT_CONVERTER_H
@@ -0,0 +1,130 @@
+#ifndef HTTP_TRANSPORT_H
+#define HTTP_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief One HTTP POST to send
+ */
+struct HttpRequest {
+    std::string url;
+    std::vector<std::string> headers;  // "Name: value"
+    std::string body;
+    long timeoutSeconds = 30;
+
+    // Receives the body of a 2xx response as it arrives instead of
+    // HttpResponse::body, then once more with no data when the transfer
+    // ends. Runs on the I/O thread, so it must not block; returning false
+    // aborts the transfer.
+    std::function<bool(const char* data, size_t size)> onData;
+
+    // Called once when a 2xx response starts arriving, before its first
+    // onData; runs on the I/O thread
+    std::function<void()> onResponseStart;
+
+    // Held back this long before it is sent; canceling it in the meantime
+    // means it is never sent at all
+    long delayMs = 0;
+};
+
+/**
+ * @brief Outcome of an HttpRequest
+ */
+struct HttpResponse {
+    bool ok = false;         // The transfer completed; the status may still be an error
+    long status = 0;
+    std::string body;
+    std::string error;       // Transport error when !ok
+    double totalMs = 0.0;    // From submission to the last byte
+    bool reusedConnection = false;
+};
+
+/**
+ * @brief Process-wide HTTP client that keeps connections warm between requests
+ *
+ * Owns one libcurl multi handle, driven by a single I/O thread, so every
+ * request in the process shares the same connection cache, DNS cache and
+ * TLS session cache. Each request to a host after the first reuses an idle
+ * keep-alive connection, and concurrent requests to the same host are
+ * multiplexed as HTTP/2 streams on one connection where the server allows
+ * it, so a turn no longer pays DNS, TCP and TLS setup again. Easy handles
+ * are pooled and reset between requests. The library is initialized the
+ * first time instance() is called.
+ */
+class HttpTransport {
+public:
+    using RequestId = uint64_t;
+    using CompletionCallback = std::function<void(HttpResponse)>;
+
+    /**
+     * @brief Gets the shared transport
+     *
+     * It is never destroyed: request threads may still be running while
+     * static objects are torn down at exit.
+     */
+    static HttpTransport& instance();
+
+    HttpTransport(const HttpTransport&) = delete;
+    HttpTransport& operator=(const HttpTransport&) = delete;
+
+    /**
+     * @brief Queues a request; safe from any thread
+     *
+     * @param onComplete Called exactly once with the outcome, on the I/O
+     *                   thread, so it must not block
+     * @return Id for cancel(); never 0
+     */
+    RequestId submit(HttpRequest request, CompletionCallback onComplete);
+
+    /**
+     * @brief Queues a request and returns a future for its outcome
+     */
+    std::future<HttpResponse> submit(HttpRequest request);
+
+    /**
+     * @brief Sends a request and waits for the whole response
+     */
+    HttpResponse perform(HttpRequest request);
+
+    /**
+     * @brief Aborts a request; it completes with an error unless it already finished
+     */
+    void cancel(RequestId id);
+
+private:
+    struct Transfer;
+
+    HttpTransport();
+
+    void* multi_ = nullptr;   // CURLM*, only touched by the I/O thread
+    void* share_ = nullptr;   // CURLSH*, likewise
+    std::vector<void*> idleHandles_;  // CURL*, I/O thread only
+    std::unordered_map<RequestId, void*> active_;  // Running transfers' CURL*, I/O thread only
+    std::vector<std::unique_ptr<Transfer>> delayed_;  // Waiting for their delay to pass, I/O thread only
+
+    std::mutex mutex_;
+    RequestId nextId_ = 1;
+    std::vector<std::unique_ptr<Transfer>> pending_;
+    std::vector<RequestId> canceled_;
+    std::thread ioThread_;
+
+    void ioLoop();
+    void start(std::unique_ptr<Transfer> transfer);
+    void finish(void* handle, int result);
+    std::unique_ptr<Transfer> retire(void* handle);
+};
+
+} // namespace voice_assist
+
+#endif // HTTP_TRANSPORT_H
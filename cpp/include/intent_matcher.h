@@ -0,0 +1,123 @@
+#ifndef INTENT_MATCHER_H
+#define INTENT_MATCHER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief A transcript recognized as one of the configured commands
+ */
+struct IntentMatch {
+    std::string intent;
+    std::vector<std::pair<std::string, std::string>> slots;  // Name and captured value, in pattern order
+    std::string reply;  // The rule's reply with slots and built-ins filled in; may be empty
+
+    /**
+     * @brief Gets a captured slot value, or an empty string
+     */
+    std::string slot(const std::string& name) const;
+};
+
+/**
+ * @brief Matches transcripts against command patterns without a network round trip
+ *
+ * Rules are read from a text file, one per line:
+ *
+ *     # intent: pattern [=> reply]
+ *     stop: (stop|cancel|never mind) [please]
+ *     time: what time is it => It's {time}.
+ *     timer: set [a] timer for {amount:number} {unit} => Timer set for {amount} {unit}.
+ *
+ * Patterns are words compared after lower-casing and dropping punctuation.
+ * (a|b c) lists alternatives and [a] marks optional words. Slots capture part
+ * of the transcript:
+ * - {name} captures one word.
+ * - {name:number} captures a number in digits or words ("twenty five") and
+ *   yields it in digits.
+ * - {name:text} captures one or more words.
+ * Replies may also use {time} and {date}.
+ *
+ * Alternatives are expanded when the file is loaded. The expanded patterns
+ * are compiled into a trie keyed by interned word ids, with each node's
+ * edges kept sorted for binary search. Matching a transcript is a single
+ * tokenization followed by a walk of that trie, which takes microseconds.
+ * The whole transcript must match. Literal words take precedence over
+ * slots, and earlier rules win ties. The matcher is immutable after
+ * loading, so it can be used from any thread.
+ */
+class IntentMatcher {
+public:
+    IntentMatcher();
+
+    /**
+     * @brief Adds the rules in a file
+     * @return true if the file was read and every rule in it compiled
+     */
+    bool loadRules(const std::string& path);
+
+    /**
+     * @brief Adds one rule
+     * @return false if the pattern is malformed
+     */
+    bool addRule(const std::string& intent, const std::string& pattern, const std::string& reply = "");
+
+    size_t ruleCount() const;
+
+    /**
+     * @brief Matches a whole transcript
+     * @return true if some rule matched; match is filled in
+     */
+    bool match(const std::string& text, IntentMatch& match) const;
+
+private:
+    enum class SlotType {
+        WORD,
+        NUMBER,
+        TEXT
+    };
+
+    struct SlotEdge {
+        SlotType type;
+        uint32_t name;   // Index into slotNames_
+        uint32_t child;
+    };
+
+    struct Node {
+        std::vector<std::pair<uint32_t, uint32_t>> words;  // Word id and child, sorted by id
+        std::vector<SlotEdge> slots;                       // In the order they were added
+        int32_t rule = -1;                                 // Rule accepted here, if any
+    };
+
+    struct Rule {
+        std::string intent;
+        std::string reply;
+    };
+
+    struct Capture {
+        uint32_t name;
+        SlotType type;
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<Rule> rules_;
+    std::unordered_map<std::string, uint32_t> vocabulary_;
+    std::vector<std::string> slotNames_;
+
+    uint32_t internWord(const std::string& word);
+    uint32_t internSlot(const std::string& name);
+    uint32_t addWordEdge(uint32_t node, uint32_t word);
+    uint32_t addSlotEdge(uint32_t node, SlotType type, uint32_t name);
+    bool walk(uint32_t node, size_t position, const std::vector<std::string>& tokens,
+              const std::vector<uint32_t>& ids, std::vector<Capture>& captures, int32_t& rule) const;
+};
+
+} // namespace voice_assist
+
+#endif // INTENT_MATCHER_H
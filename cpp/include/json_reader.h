@@ -0,0 +1,99 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace voice_assist {
+
+/**
+ * @brief Pull reader that walks a JSON document without building a DOM
+ *
+ * The caller steps through the containers it cares about and skips every
+ * other value; skipped values are still checked for syntax, but nothing in
+ * them is copied or unescaped. Strings that are read are unescaped
+ * straight into the caller's buffer, with plain runs found by
+ * findJsonEscape(); their bytes are not checked to be valid UTF-8. Any
+ * syntax error makes the reader fail: the call returns false and failed()
+ * stays true.
+ *
+ *     reader.beginObject();
+ *     while (reader.nextKey(key)) {
+ *         if (key == "name") reader.readString(name); else reader.skipValue();
+ *     }
+ */
+class JsonReader {
+public:
+    enum class Type {
+        OBJECT,
+        ARRAY,
+        STRING,
+        NUMBER,
+        BOOLEAN,
+        NUL,
+        INVALID   // End of input or a syntax error
+    };
+
+    JsonReader(const char* data, size_t size);
+
+    /**
+     * @brief Type of the next value, without consuming it
+     */
+    Type peek();
+
+    bool beginObject();
+
+    /**
+     * @brief Reads the next key of the current object
+     * @return false at the end of the object, which is consumed, or on error
+     */
+    bool nextKey(std::string& key);
+
+    bool beginArray();
+
+    /**
+     * @brief Moves to the next element of the current array
+     * @return false at the end of the array, which is consumed, or on error
+     */
+    bool nextElement();
+
+    /**
+     * @brief Reads a string value into out, replacing its contents
+     */
+    bool readString(std::string& out);
+
+    /**
+     * @brief Reads a number of at most 18 digits, without a fraction or exponent
+     */
+    bool readInteger(int64_t& value);
+
+    bool skipValue();
+
+    /**
+     * @brief Checks that only whitespace is left
+     */
+    bool atEnd();
+
+    bool failed() const;
+
+private:
+    const char* position_;
+    const char* end_;
+    bool first_ = false;    // No member or element of the current container read yet
+    bool failed_ = false;
+
+    void skipWhitespace();
+    bool fail();
+    bool expect(char c);
+    bool nextMember(std::string* key);
+    bool readCodePoint(uint32_t& codePoint);
+    bool skipValue(int depth);
+    bool skipString();
+    bool skipNumber();
+    bool skipLiteral(const char* literal, size_t length);
+};
+
+} // namespace voice_assist
+
+#endif // JSON_READER_H
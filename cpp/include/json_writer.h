@@ -0,0 +1,74 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace voice_assist {
+
+/**
+ * @brief Finds the first quote, backslash or control character
+ *
+ * These are the bytes a JSON string cannot hold as they are, and the only
+ * ones that end a plain run when reading one. Scans 16 bytes at a time with
+ * SSE2 or NEON where available.
+ *
+ * @return Index of the byte, or size if there is none
+ */
+size_t findJsonEscape(const char* data, size_t size);
+
+/**
+ * @brief Appends a string to out as a quoted JSON string
+ *
+ * Only quotes, backslashes and control characters are escaped; other bytes,
+ * UTF-8 included, are copied as they are. Runs of bytes that need no escape
+ * are found with findJsonEscape() and copied in one go.
+ */
+void appendJsonString(std::string& out, const char* data, size_t size);
+
+/**
+ * @brief Writes compact JSON straight into a string, without building a DOM
+ *
+ * Calls must form a well-formed document; the writer only inserts the
+ * commas and colons. Nothing is allocated beyond the growth of the output,
+ * which callers can avoid by reserving it.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(const std::string& text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(const char* data, size_t size);
+    JsonWriter& value(bool flag);
+    JsonWriter& value(int number);
+    JsonWriter& value(int64_t number);
+
+    /**
+     * @brief Writes a number in its shortest form that reads back exactly; null if not finite
+     */
+    JsonWriter& value(float number);
+    JsonWriter& value(double number);
+
+    /**
+     * @brief Writes an already serialized value
+     */
+    JsonWriter& raw(const std::string& json);
+
+private:
+    std::string& out_;
+    bool needComma_ = false;  // A value was written in the current container
+
+    void separate();
+};
+
+} // namespace voice_assist
+
+#endif // JSON_WRITER_H
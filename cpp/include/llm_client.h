@@ -1,11 +1,18 @@
 #ifndef LLM_CLIENT_H
 #define LLM_CLIENT_H
 
+#include "endpoint_router.h"
+#include "response_cache.h"
+#include "worker_pool.h"
+
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <future>
 
 namespace voice_assist {
@@ -25,6 +32,18 @@ struct Message {
     std::string id;
     
     Message(Role role, const std::string& content);
+    
+    /**
+     * @brief Gets the message serialized as an element of a request's messages array
+     * 
+     * Serialized once, at construction, and shared by copies, so resending
+     * a long history only copies bytes. role and content must therefore
+     * not be changed afterwards; build a new Message instead.
+     */
+    const std::string& json() const;
+
+private:
+    std::shared_ptr<const std::string> json_;
 };
 
 /**
@@ -37,14 +56,95 @@ struct LlmClientConfig {
     float temperature = 0.7f;
     int maxTokens = 150;
     int timeout = 30; // seconds
+    int maxConcurrentRequests = 4;  // Sent at once; later ones wait in the queue
+    int maxQueuedRequests = 16;     // Beyond this, new requests fail straight away
+    int callbackThreads = 2;        // Threads parsing responses and running callbacks; fixed at construction
+    ResponseCacheConfig cache;      // Fixed at construction
+    std::vector<std::string> endpoints;  // Equivalent base URLs to route between; empty uses baseUrl alone
+    bool hedgeRequests = false;     // Resend a slow request to a second endpoint; the first to answer wins
+    int hedgeDelayMs = 1000;        // Wait before hedging until an endpoint's p95 is known
+};
+
+/**
+ * @brief Token usage and reply counters reported by the API
+ */
+struct LlmUsageStats {
+    uint64_t responses = 0;          // Successful replies from the network
+    uint64_t promptTokens = 0;       // Where the API reported usage
+    uint64_t completionTokens = 0;
+    uint64_t truncated = 0;          // Replies cut off at maxTokens
+};
+
+struct LlmRequestState;  // Defined in llm_client.cpp
+
+/**
+ * @brief Handle to one request sent by LlmClient
+ * 
+ * Canceling fails the response future with "Request canceled" at once,
+ * skips the request's callbacks and aborts its transfer within
+ * milliseconds, releasing the connection and the client's slot. Handles
+ * may outlive the client.
+ */
+class LlmRequest {
+public:
+    LlmRequest() = default;
+    
+    /**
+     * @brief Cancels the request unless it already completed
+     * 
+     * Safe from any thread, including the request's own callbacks, and any
+     * number of times. Waits for a delta callback in progress on another
+     * thread; once it returns no further delta arrives, and the final
+     * callback no longer runs unless it had already started.
+     */
+    void cancel();
+    
+    /**
+     * @brief Checks whether this handle refers to a request
+     */
+    bool valid() const;
+    
+    /**
+     * @brief Future for the response text or error
+     */
+    std::future<std::string>& response();
+
+private:
+    friend class LlmClient;
+    
+    std::shared_ptr<LlmRequestState> state_;
+    std::future<std::string> response_;
 };
 
 /**
  * @brief Client for interacting with Language Model APIs
+ * 
+ * Requests are event-driven: they are sent on the shared HttpTransport's
+ * I/O thread, and responses are parsed and delivered to callbacks on a
+ * small fixed pool of threads, so no thread is created per request. At
+ * most maxConcurrentRequests are in flight; up to maxQueuedRequests more
+ * wait for a slot, and any beyond that fail at once with an error instead
+ * of blocking the caller. Destroying the client cancels all outstanding
+ * requests without calling their callbacks and waits for callbacks that
+ * are already running, so it must not be destroyed from one of them.
+ * 
+ * With the response cache enabled, a request whose endpoint, model,
+ * sampling settings and messages match an earlier successful one is
+ * answered from the cache without touching the network. Its callbacks run
+ * on the pool as usual, and a streamed reply arrives as a single delta.
+ * 
+ * Given several equivalent endpoints, each request goes to the fastest
+ * healthy one as judged by EndpointRouter. With hedging on, a request
+ * whose endpoint has not started answering within its p95 time to first
+ * byte is sent to a second endpoint as well; the first 2xx response to
+ * start is used and the other attempt is canceled. If an attempt fails
+ * before either starts answering, the request is left to the other one.
+ * A hedged request still takes a single slot.
  */
 class LlmClient {
 public:
     using ResponseCallback = std::function<void(const std::string&, bool)>;
+    using DeltaCallback = std::function<void(const std::string&)>;
     
     LlmClient(const LlmClientConfig& config = LlmClientConfig());
     ~LlmClient();
@@ -54,10 +154,30 @@ public:
      * 
      * @param messages The conversation history
      * @param callback Function to call with the response or error
-     * @return std::future<std::string> Future containing the response
+     * @return Handle holding the future for the response
+     */
+    LlmRequest sendConversation(
+        const std::vector<Message>& messages,
+        ResponseCallback callback = nullptr
+    );
+    
+    /**
+     * @brief Sends a conversation and streams the reply as it is generated
+     * 
+     * Requests "stream": true and parses the server-sent events as the
+     * bytes arrive. onDelta is called with each new piece of text, in order,
+     * on the request's thread; callback and the future still receive the
+     * whole reply at the end.
+     * 
+     * @param messages The conversation history
+     * @param onDelta Function to call with each piece of the response; no
+     *                call starts after LlmRequest::cancel() returns
+     * @param callback Function to call with the response or error
+     * @return Handle holding the future for the response
      */
-    std::future<std::string> sendConversation(
+    LlmRequest streamConversation(
         const std::vector<Message>& messages,
+        DeltaCallback onDelta,
         ResponseCallback callback = nullptr
     );
     
@@ -72,18 +192,53 @@ public:
     const LlmClientConfig& getConfig() const;
     
     /**
-     * @brief Cancels any pending requests
+     * @brief Cancels every queued and in-flight request, as LlmRequest::cancel() does
      */
     void cancelPendingRequests();
+    
+    /**
+     * @brief Gets the response cache counters; all zero when it is disabled
+     */
+    ResponseCacheStats getCacheStats() const;
+    
+    /**
+     * @brief Gets the token usage counters
+     */
+    LlmUsageStats getUsageStats() const;
+    
+    /**
+     * @brief Gets latency and health estimates for each endpoint
+     */
+    std::vector<EndpointStats> getEndpointStats() const;
 
 private:
+    using Request = LlmRequestState;
+    
     LlmClientConfig config_;
-    bool cancelRequested_ = false;
-    std::mutex mutex_;
+    std::mutex mutex_;                              // Guards config_ and the fields below
+    std::condition_variable idle_;                  // Signaled as requests finish
+    std::vector<std::shared_ptr<Request>> active_;  // Sent and not yet completed
+    std::deque<std::shared_ptr<Request>> queued_;   // Waiting for a free slot
+    bool shuttingDown_ = false;
+    std::unique_ptr<WorkerPool> callbacks_;
+    std::unique_ptr<ResponseCache> cache_;          // Null unless config.cache.enabled
+    std::unique_ptr<EndpointRouter> router_;
+    mutable std::mutex usageMutex_;                 // Guards usage_
+    LlmUsageStats usage_;
     
-    std::string buildRequestBody(const std::vector<Message>& messages);
-    std::string performRequest(const std::string& endpoint, const std::string& body);
-    std::string parseResponse(const std::string& jsonResponse);
+    LlmRequest startRequest(
+        const std::vector<Message>& messages,
+        DeltaCallback onDelta,
+        ResponseCallback callback
+    );
+    void dispatch(const std::shared_ptr<Request>& request);
+    void sendAttempt(const std::shared_ptr<Request>& request, int index, std::string body, long delayMs);
+    void claimAttempt(const std::shared_ptr<Request>& request, int index);
+    void schedule(const std::shared_ptr<Request>& request);
+    void drain(const std::shared_ptr<Request>& request);
+    void complete(const std::shared_ptr<Request>& request);
+    ResponseCache::Key cacheKey(const std::vector<Message>& messages) const;
+    std::string buildRequestBody(const std::vector<Message>& messages, bool stream);
 };
 
 } // namespace voice_assist
@@ -0,0 +1,87 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace voice_assist {
+
+/**
+ * @brief Cross-platform memory-mapped file
+ *
+ * Read-only mappings are used to stream large inputs without copying them
+ * into the heap; writable mappings can be grown with resize().
+ */
+class MappedFile {
+public:
+    enum class Mode {
+        READ_ONLY,   // Map an existing file for reading
+        READ_WRITE,  // Open or create a file, keeping its contents
+        CREATE       // Create or truncate a file
+    };
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Opens and maps a file
+     *
+     * @param path File to map
+     * @param mode How to open the file
+     * @param size Initial size for writable modes; ignored when it is smaller
+     *             than an existing READ_WRITE file
+     * @return bool Success or failure; on failure the file is closed
+     */
+    bool open(const std::string& path, Mode mode, size_t size = 0);
+
+    /**
+     * @brief Changes the file length and remaps it; writable modes only
+     *
+     * Pointers obtained from data() are invalidated. On failure the file is
+     * closed, leaving size() == 0 and isOpen() false.
+     */
+    bool resize(size_t size);
+
+    /**
+     * @brief Flushes dirty pages to disk; writable modes only
+     */
+    bool sync();
+
+    /**
+     * @brief Unmaps and closes the file
+     */
+    void close();
+
+    bool isOpen() const;
+    bool isWritable() const;
+    uint8_t* data();
+    const uint8_t* data() const;
+    size_t size() const;
+    const std::string& path() const;
+
+private:
+    std::string path_;
+    Mode mode_ = Mode::READ_ONLY;
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+
+    bool map();
+    void unmap();
+};
+
+} // namespace voice_assist
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,67 @@
+#ifndef NOISE_SUPPRESSOR_H
+#define NOISE_SUPPRESSOR_H
+
+#include "audio_buffer.h"
+#include "fft.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace voice_assist {
+
+/**
+ * @brief Streaming single-channel spectral noise suppressor
+ *
+ * Runs a 10 ms hop STFT with 50% overlapping square-root Hann windows,
+ * tracks a per-bin noise estimate that falls quickly and rises slowly, and
+ * applies a decision-directed Wiener gain before overlap-add resynthesis.
+ * All buffers are allocated in the constructor; per-bin state is stored as
+ * separate float arrays so the inner loops vectorize.
+ */
+class NoiseSuppressor {
+public:
+    explicit NoiseSuppressor(int sampleRate = 16000);
+
+    /**
+     * @brief Processes a chunk of any length
+     *
+     * Output lags input by latencySamples(). in and out may alias.
+     */
+    void process(const int16_t* in, int16_t* out, size_t count);
+
+    /**
+     * @brief Clears the signal history and the noise estimate
+     */
+    void reset();
+
+    /**
+     * @brief Delay introduced by the analysis/synthesis pipeline
+     */
+    size_t latencySamples() const;
+
+private:
+    size_t hop_;
+    size_t window_;
+    Fft fft_;
+    size_t frames_ = 0;
+    size_t hopFill_ = 0;
+
+    AlignedBuffer<float> sqrtHann_;
+    AlignedBuffer<float> history_;       // Last window_ input samples
+    AlignedBuffer<float> frame_;         // Windowed, zero-padded FFT input
+    AlignedBuffer<float> real_;
+    AlignedBuffer<float> imag_;
+    AlignedBuffer<float> noisePower_;
+    AlignedBuffer<float> smoothedPower_;
+    AlignedBuffer<float> previousGain_;
+    AlignedBuffer<float> previousPosterior_;
+    AlignedBuffer<float> overlap_;       // Second half of the last synthesized frame
+    AlignedBuffer<int16_t> hopInput_;
+    AlignedBuffer<int16_t> hopOutput_;
+
+    void processHop();
+};
+
+} // namespace voice_assist
+
+#endif // NOISE_SUPPRESSOR_H
@@ -0,0 +1,150 @@
+#ifndef PLAYBACK_QUEUE_H
+#define PLAYBACK_QUEUE_H
+
+#include "audio_buffer.h"
+#include "format_converter.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Identifies one queued clip or stream; 0 is never a valid handle
+ */
+using PlaybackHandle = uint64_t;
+
+/**
+ * @brief Counters describing the playback queue
+ */
+struct PlaybackStats {
+    uint64_t queuedSamples = 0;   // Waiting to be rendered right now
+    uint64_t playedSamples = 0;
+    uint64_t underruns = 0;       // Times an open stream ran dry mid-playback
+    uint64_t flushes = 0;
+};
+
+/**
+ * @brief Asynchronous playback queue with a jitter buffer
+ *
+ * Any number of producer threads open streams, write PCM in any format and
+ * close them, one thread per stream at a time. The audio is converted to the
+ * queue's format and appended to a preallocated lock-free ring in the order
+ * it is written. A single device thread pulls samples with render(), which
+ * never blocks or allocates.
+ *
+ * Playback only starts once prebufferMs of audio is queued or no stream is
+ * open any more, and falls back to buffering when an open stream runs dry,
+ * so a producer that synthesizes in bursts does not stutter. flush()
+ * discards everything queued at the next render() call, i.e. within one
+ * device period.
+ */
+class PlaybackQueue {
+public:
+    /**
+     * @throws std::invalid_argument for non-positive rates or channel counts
+     */
+    PlaybackQueue(const AudioFormat& format, int capacityMs = 10000, int prebufferMs = 60);
+
+    /**
+     * @brief Format samples are rendered in
+     */
+    const AudioFormat& getFormat() const;
+
+    /**
+     * @brief Starts a new stream whose audio arrives in the given format
+     * @return Handle, or 0 if the format is invalid
+     */
+    PlaybackHandle open(const AudioFormat& format);
+
+    /**
+     * @brief Appends samples to an open stream
+     *
+     * Returns as soon as the samples are queued; only blocks while the queue
+     * already holds capacityMs of audio. A trailing partial frame is ignored.
+     * @return false if the stream is unknown, closed or was flushed
+     */
+    bool write(PlaybackHandle handle, AudioSampleView samples, float gain = 1.0f);
+
+    /**
+     * @brief Marks the end of a stream so its tail plays without waiting for more
+     */
+    void close(PlaybackHandle handle);
+
+    /**
+     * @brief Blocks until a stream has been closed and fully rendered
+     *
+     * Handles the queue no longer tracks count as played.
+     * @param timeoutMs Negative waits indefinitely
+     * @return true if it played to the end; false if it was flushed or the wait timed out
+     */
+    bool wait(PlaybackHandle handle, int timeoutMs = -1);
+
+    /**
+     * @brief Checks whether any audio is queued or any stream is still open
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Drops all queued audio and cancels every open stream
+     */
+    void flush();
+
+    /**
+     * @brief Fills out with the next samples; called from the device thread only
+     *
+     * Whatever is not covered by queued audio is zeroed.
+     * @return Number of queued samples rendered
+     */
+    size_t render(int16_t* out, size_t count);
+
+    /**
+     * @brief Gets the queue counters
+     */
+    PlaybackStats getStats() const;
+
+private:
+    struct Stream {
+        uint64_t end = 0;       // Write position just past the stream's last sample
+        bool open = true;
+        bool cancelled = false;
+        std::unique_ptr<FormatConverter> converter;
+        float gain = 1.0f;      // Of the last write; also applied to the resampler tail
+        std::vector<int16_t> gainScratch;
+    };
+
+    AudioFormat format_;
+    size_t prebufferSamples_;
+    SpscRingBuffer<int16_t> ring_;
+
+    // Producer side, guarded by mutex_
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<PlaybackHandle, Stream> streams_;
+    PlaybackHandle nextHandle_ = 1;
+
+    // Positions count every sample ever queued; shared with the device thread
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> read_{0};
+    std::atomic<uint64_t> flushTarget_{0};     // Discard everything written before this
+    std::atomic<int> openStreams_{0};
+    std::atomic<uint64_t> played_{0};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<uint64_t> flushes_{0};
+
+    // Device thread only
+    bool buffering_ = true;
+
+    bool appendLocked(std::unique_lock<std::mutex>& lock, PlaybackHandle handle, AudioSampleView samples, float gain);
+    bool isFinishedLocked(const Stream& stream) const;
+    void forgetFinishedLocked();
+};
+
+} // namespace voice_assist
+
+#endif // PLAYBACK_QUEUE_H
@@ -0,0 +1,88 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "audio_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Streaming rational-ratio polyphase resampler for interleaved int16 audio
+ *
+ * The rate ratio is reduced to L/M and a Kaiser-windowed sinc prototype is
+ * split into L phases once in the constructor, each padded to a multiple of
+ * eight taps for the SIMD dot product. Input is consumed chunk by chunk;
+ * the filter history and the phase carry over between calls, so splitting
+ * a stream into arbitrary pieces produces the same output as converting it
+ * in one go. Nothing is allocated after construction.
+ */
+class Resampler {
+public:
+    /**
+     * @param zeroCrossings Sinc zero crossings on each side of the centre tap;
+     *                      higher is sharper and slower
+     * @throws std::invalid_argument for non-positive rates or channel counts
+     */
+    Resampler(int inputRate, int outputRate, int channels, int zeroCrossings = 16);
+
+    /**
+     * @brief Upper bound on the frames process() can return for inputFrames
+     */
+    size_t maxOutputFrames(size_t inputFrames) const;
+
+    /**
+     * @brief Resamples interleaved frames
+     *
+     * @param out Room for maxOutputFrames(inputFrames) frames
+     * @return Number of frames written
+     */
+    size_t process(const int16_t* in, size_t inputFrames, int16_t* out);
+
+    /**
+     * @brief Emits the samples still held back by the filter and resets
+     *
+     * After flush() the total output matches the input duration exactly.
+     * @param out Room for maxOutputFrames(0) frames
+     * @return Number of frames written
+     */
+    size_t flush(int16_t* out);
+
+    /**
+     * @brief Clears the filter history and phase
+     */
+    void reset();
+
+    int inputRate() const;
+    int outputRate() const;
+    int channels() const;
+
+private:
+    int inputRate_;
+    int outputRate_;
+    int channels_;
+    size_t up_;          // L: output rate / gcd
+    size_t down_;        // M: input rate / gcd
+    size_t taps_;        // Taps per phase
+    size_t delay_;       // Input frames of zero padding that centre the filter
+
+    size_t phase_ = 0;   // Current phase, in [0, up_)
+    size_t position_ = 0;  // First history frame under the filter
+    size_t fill_ = 0;      // History frames buffered
+    uint64_t inputFrames_ = 0;
+    uint64_t outputFrames_ = 0;
+
+    AlignedBuffer<float> bank_;                  // up_ phases of taps_ coefficients
+    std::vector<AlignedBuffer<float>> history_;  // One plane per channel
+    std::vector<AlignedBuffer<float>> output_;   // One plane per channel
+    std::vector<AlignedBuffer<int16_t>> planes_; // int16 (de)interleave scratch
+    std::vector<int16_t*> planePointers_;
+
+    size_t processChunk(const int16_t* in, size_t frames, int16_t* out);
+};
+
+} // namespace voice_assist
+
+#endif // RESAMPLER_H
@@ -0,0 +1,116 @@
+#ifndef RESILIENT_VOICE_RECOGNIZER_H
+#define RESILIENT_VOICE_RECOGNIZER_H
+
+#include "voice_recognizer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Recovery counters for a ResilientVoiceRecognizer
+ */
+struct RecoveryStats {
+    uint64_t failures = 0;        // Failures reported by active engines
+    uint64_t standbySwaps = 0;    // Failures absorbed by promoting the standby
+    uint64_t rebuilds = 0;        // Engines built in the background
+    uint64_t failedRebuilds = 0;
+};
+
+/**
+ * @brief Keeps recognition running across engine failures
+ *
+ * Wraps engines made by a factory. Besides the active engine it keeps a
+ * prepared standby. When the active engine reports a failure through
+ * VoiceRecognizer::reportFailure, the standby takes its place and starts
+ * listening with the same callback. A recovery thread then retires the
+ * failed engine and builds a new standby, retrying failed builds with
+ * jittered exponential backoff. Failure reports only flag the engine and
+ * wake that thread, so an engine's listener thread is never blocked.
+ * Captured audio is forwarded to whichever engine is active. Failed
+ * engines are stopped and destroyed without holding the lock that
+ * startListening() and stopListening() take, so an engine that is slow to
+ * shut down does not hold up the caller.
+ */
+class ResilientVoiceRecognizer : public VoiceRecognizer {
+public:
+    using Factory = std::function<std::unique_ptr<VoiceRecognizer>(const VoiceRecognizerConfig&)>;
+
+    /**
+     * @param factory Builds one engine; may return nullptr on failure. Only
+     *                called from the constructor and the recovery thread.
+     */
+    ResilientVoiceRecognizer(const VoiceRecognizerConfig& config, Factory factory);
+    ~ResilientVoiceRecognizer() override;
+
+    bool startListening(TranscriptionCallback callback) override;
+    void stopListening() override;
+    bool isListening() const override;
+    bool acceptsPushedAudio() const override;
+    void processAudio(AudioSampleView samples) override;
+    void processFeatures(const FeatureMatrix& features, uint64_t firstFrame, size_t count) override;
+    void finalizeUtterance() override;
+
+    /**
+     * @brief Sets the configuration of the wrapper, both engines and engines built later
+     */
+    void setConfig(const VoiceRecognizerConfig& config) override;
+
+    /**
+     * @brief Checks whether a prepared standby engine is ready
+     */
+    bool hasStandby() const;
+
+    RecoveryStats getRecoveryStats() const;
+
+private:
+    Factory factory_;
+    std::atomic<bool> wantListening_{false};
+
+    // Serializes starting, stopping and swapping engines
+    std::mutex controlMutex_;
+
+    // Guards the engines and, after construction, config_; held only
+    // briefly, as the capture thread takes it for every frame
+    mutable std::mutex engineMutex_;
+    std::unique_ptr<VoiceRecognizer> active_;
+    std::unique_ptr<VoiceRecognizer> standby_;
+    RecoveryStats stats_;
+
+    // Wakes the recovery thread. Failure reports take only this lock, so an
+    // engine may report from inside any call, including processAudio().
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::vector<VoiceRecognizer*> failedEngines_;
+    bool wakePending_ = false;
+    bool stopping_ = false;
+
+    // Recovery thread only, after construction
+    int backoffMs_ = 0;
+    std::chrono::steady_clock::time_point nextBuild_;
+    std::minstd_rand jitter_;
+    std::thread recoveryThread_;
+
+    std::unique_ptr<VoiceRecognizer> buildEngine();
+    bool startEngine(VoiceRecognizer& engine);
+    bool needsEngine() const;
+    void handleFailure(VoiceRecognizer* engine, const std::string& reason);
+    void wakeRecovery();
+    void recoveryLoop();
+    void replaceFailedEngine(VoiceRecognizer* failed);
+    void rebuildEngine();
+    void scheduleRebuild();
+};
+
+} // namespace voice_assist
+
+#endif // RESILIENT_VOICE_RECOGNIZER_H
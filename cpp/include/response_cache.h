@@ -0,0 +1,121 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace voice_assist {
+
+/**
+ * @brief Configuration for caching LLM responses
+ */
+struct ResponseCacheConfig {
+    bool enabled = false;
+    size_t maxEntries = 256;              // In memory; least recently used are evicted first
+    size_t maxMemoryBytes = 4 << 20;      // Response text held in memory
+    int ttlSeconds = 3600;                // 0 keeps responses until they are evicted
+    std::string diskPath;                 // Mapped file that survives restarts; empty keeps the cache in memory
+    size_t maxDiskBytes = 64 << 20;
+};
+
+/**
+ * @brief Cache counters
+ */
+struct ResponseCacheStats {
+    uint64_t memoryHits = 0;
+    uint64_t diskHits = 0;
+    uint64_t misses = 0;      // Including entries that had expired
+    uint64_t expired = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;   // Dropped from memory to make room
+};
+
+/**
+ * @brief Two-tier store of responses keyed by a hash of the request
+ *
+ * The memory tier is an LRU list indexed by a hash map, bounded by entry
+ * count and bytes. The optional disk tier is an append-only log in a
+ * memory-mapped file: opening it scans the records once to index them, a
+ * lookup reads straight from the mapping, and when the file fills up the
+ * live records are compacted to its start. Responses found on disk are
+ * promoted to memory. Expiry is wall-clock time, so it holds across
+ * restarts. All methods are thread-safe.
+ */
+class ResponseCache {
+public:
+    /**
+     * @brief 128-bit request fingerprint; collisions are not a practical concern
+     */
+    struct Key {
+        uint64_t high = 0;
+        uint64_t low = 0;
+
+        bool operator==(const Key& other) const {
+            return high == other.high && low == other.low;
+        }
+    };
+
+    explicit ResponseCache(const ResponseCacheConfig& config);
+    ~ResponseCache();
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    /**
+     * @brief Hashes the serialized request
+     */
+    static Key makeKey(const std::string& request);
+
+    /**
+     * @brief Looks a response up in memory, then on disk
+     * @return true if an unexpired response was found
+     */
+    bool lookup(const Key& key, std::string& response);
+
+    /**
+     * @brief Stores a response in both tiers
+     */
+    void store(const Key& key, const std::string& response);
+
+    ResponseCacheStats getStats() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return static_cast<size_t>(key.low);
+        }
+    };
+
+    struct Entry {
+        Key key;
+        std::string response;
+        int64_t expiresAt;   // Seconds since the epoch; 0 never expires
+    };
+
+    ResponseCacheConfig config_;
+    mutable std::mutex mutex_;                   // Guards everything below
+    std::list<Entry> entries_;                   // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    size_t memoryBytes_ = 0;
+    ResponseCacheStats stats_;
+
+    MappedFile disk_;
+    std::unordered_map<Key, size_t, KeyHash> diskIndex_;  // Offset of each key's latest record
+    size_t diskUsed_ = 0;
+
+    void insertLocked(const Key& key, const std::string& response, int64_t expiresAt);
+    bool openDisk();
+    bool readDiskLocked(const Key& key, std::string& response, int64_t& expiresAt);
+    void appendDiskLocked(const Key& key, const std::string& response, int64_t expiresAt);
+    void compactDiskLocked(int64_t now);
+};
+
+} // namespace voice_assist
+
+#endif // RESPONSE_CACHE_H
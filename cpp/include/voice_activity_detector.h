@@ -0,0 +1,88 @@
+#ifndef VOICE_ACTIVITY_DETECTOR_H
+#define VOICE_ACTIVITY_DETECTOR_H
+
+#include "audio_buffer.h"
+#include "voice_recognizer.h"
+
+namespace voice_assist {
+
+/**
+ * @brief Streaming energy-based voice activity detector and endpointer
+ *
+ * Tracks an adaptive noise floor, seeded from the quietest frame of the
+ * first 300 ms, and scores each frame by how far it rises above it.
+ * VoiceRecognizerConfig::speechThreshold is the score (0..1 over a 30 dB
+ * range) a frame needs to count as speech, silenceTimeoutMs is the hangover
+ * before speech is declared over, and maxRecordingTimeMs caps an utterance. State is a handful of scalars, so each frame costs one pass over
+ * its samples and no allocation.
+ */
+class VoiceActivityDetector {
+public:
+    enum class Event {
+        NONE,
+        SPEECH_START,
+        SPEECH_END,
+        MAX_LENGTH_REACHED
+    };
+
+    VoiceActivityDetector(const VoiceRecognizerConfig& config = VoiceRecognizerConfig(),
+                          int sampleRate = 16000, int channels = 1);
+
+    /**
+     * @brief Processes one frame of interleaved samples of any length
+     * @return The endpoint event this frame triggered, if any
+     */
+    Event processFrame(AudioSampleView frame);
+
+    /**
+     * @brief Processes a frame whose level has already been measured
+     *
+     * @param levelDb Frame energy in dBFS
+     * @param durationMs Frame duration
+     */
+    Event processLevel(float levelDb, float durationMs);
+
+    /**
+     * @brief Forgets the current utterance but keeps the learned noise floor
+     */
+    void reset();
+
+    /**
+     * @brief Checks whether an utterance is in progress
+     */
+    bool isSpeaking() const;
+
+    /**
+     * @brief Gets the current noise floor estimate in dBFS
+     */
+    float getNoiseFloorDb() const;
+
+    /**
+     * @brief Sets the configuration
+     */
+    void setConfig(const VoiceRecognizerConfig& config);
+
+    /**
+     * @brief Gets the current configuration
+     */
+    const VoiceRecognizerConfig& getConfig() const;
+
+private:
+    VoiceRecognizerConfig config_;
+    int sampleRate_;
+    int channels_;
+
+    bool noiseFloorValid_ = false;
+    float noiseFloorDb_ = -90.0f;
+    float seedMs_ = 0.0f;  // Audio seen while the floor tracks the minimum level
+    bool speaking_ = false;
+    float onsetMs_ = 0.0f;
+    float silenceMs_ = 0.0f;
+    float utteranceMs_ = 0.0f;
+
+    void updateNoiseFloor(float levelDb, float durationMs);
+};
+
+} // namespace voice_assist
+
+#endif // VOICE_ACTIVITY_DETECTOR_H
@@ -4,12 +4,19 @@
 #include "audio_manager.h"
 #include "voice_recognizer.h"
 #include "llm_client.h"
+#include "voice_activity_detector.h"
+#include "wake_word_spotter.h"
+#include "intent_matcher.h"
+#include "worker_pool.h"
 
 #include <memory>
 #include <vector>
 #include <string>
 #include <functional>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 
 namespace voice_assist {
 
@@ -24,6 +31,28 @@ struct VoiceAssistantConfig {
     bool useTextToSpeech = true;
     bool saveConversationHistory = true;
     int maxContextMessages = 10;
+    bool useVoiceActivityDetection = true;
+    std::vector<std::string> wakeWordRecordings;  // WAV/raw recordings of the wake phrase; empty disables it
+    float wakeWordThreshold = 0.3f;
+    int speculativeStableMs = 0;  // Send the LLM request once the partial transcript is this stable; 0 waits for the final
+    bool streamResponses = true;  // Speak the reply sentence by sentence while it is being generated
+    std::string intentRulesFile;  // Commands answered locally, see IntentMatcher; empty sends everything to the LLM
+    ResponseCacheConfig responseCache;  // Answers repeated LLM requests locally; fixed at construction
+    std::vector<std::string> llmEndpoints;  // Equivalent LLM API base URLs; empty uses the client's default
+    bool hedgeLlmRequests = false;      // Resend slow LLM requests to a second endpoint
+    AudioConfig audio;
+    VoiceRecognizerConfig recognizer;  // language is taken from the field above
+    FeatureConfig features;            // sampleRate is taken from the capture format
+};
+
+/**
+ * @brief Outcome counters for speculative LLM dispatch
+ */
+struct SpeculationStats {
+    uint64_t dispatched = 0;  // Requests sent on a stable partial transcript
+    uint64_t hits = 0;        // Final transcript matched and the response was reused
+    uint64_t misses = 0;      // Discarded because the transcript changed or the turn ended
+    double savedMs = 0.0;     // Request time overlapped with endpointing, summed over hits
 };
 
 /**
@@ -43,8 +72,12 @@ public:
     
     using StateChangeCallback = std::function<void(State)>;
     using TranscriptionCallback = std::function<void(const std::string&)>;
+    using PartialTranscriptionCallback = std::function<void(const std::string&)>;
     using ResponseCallback = std::function<void(const std::string&)>;
     using ErrorCallback = std::function<void(const std::string&)>;
+    using VoiceActivityCallback = std::function<void(bool)>;
+    using WakeWordCallback = std::function<void()>;
+    using IntentCallback = std::function<bool(IntentMatch&)>;
     
     VoiceAssistant(const VoiceAssistantConfig& config = VoiceAssistantConfig());
     ~VoiceAssistant();
@@ -65,6 +98,19 @@ public:
      */
     void stopListening();
     
+    /**
+     * @brief Stops the response immediately
+     * 
+     * Silences playback and cancels the LLM request still producing the
+     * response, if any, returning to IDLE.
+     */
+    void stopSpeaking();
+    
+    /**
+     * @brief Checks whether a response is still being played
+     */
+    bool isSpeaking() const;
+    
     /**
      * @brief Sends a text input directly to the assistant
      */
@@ -100,6 +146,15 @@ public:
      */
     void setTranscriptionCallback(TranscriptionCallback callback);
     
+    /**
+     * @brief Sets the callback for the stable part of an utterance still being spoken
+     *
+     * Called from the recognizer's thread, at most once per
+     * VoiceRecognizerConfig::partialIntervalMs, so work that depends on the
+     * transcript can start before the user has finished.
+     */
+    void setPartialTranscriptionCallback(PartialTranscriptionCallback callback);
+    
     /**
      * @brief Sets the response callback
      */
@@ -110,29 +165,136 @@ public:
      */
     void setErrorCallback(ErrorCallback callback);
     
+    /**
+     * @brief Sets the callback invoked when speech starts (true) and ends (false)
+     */
+    void setVoiceActivityCallback(VoiceActivityCallback callback);
+    
+    /**
+     * @brief Sets the callback invoked when the wake phrase is heard
+     */
+    void setWakeWordCallback(WakeWordCallback callback);
+    
+    /**
+     * @brief Sets the callback that acts on locally matched commands
+     *
+     * Called on the thread that produced the transcript. It may change the
+     * reply; returning false hands the transcript to the LLM instead.
+     * Without a callback, matched commands just get their rule's reply.
+     * The "stop" intent also stops the response being spoken.
+     */
+    void setIntentCallback(IntentCallback callback);
+    
     /**
      * @brief Gets the conversation history
      */
     std::vector<Message> getConversationHistory() const;
+    
+    /**
+     * @brief Gets the speculative dispatch counters
+     */
+    SpeculationStats getSpeculationStats() const;
+    
+    /**
+     * @brief Gets the LLM response cache counters
+     */
+    ResponseCacheStats getResponseCacheStats() const;
+    
+    /**
+     * @brief Gets the LLM token usage counters
+     */
+    LlmUsageStats getLlmUsageStats() const;
+    
+    /**
+     * @brief Gets latency and health estimates for each LLM endpoint
+     */
+    std::vector<EndpointStats> getLlmEndpointStats() const;
 
 private:
+    /**
+     * @brief Reply being streamed from the LLM
+     */
+    struct StreamedReply {
+        std::string text;
+        size_t spoken = 0;      // Characters of text already handed to TTS
+        std::mutex mutex;       // Held while a claimed speculation replays its buffered deltas
+    };
+
+    /**
+     * @brief LLM request sent ahead of the final transcript
+     *
+     * When responses are streamed, deltas are buffered until the final
+     * transcript claims the speculation, then replayed into reply.
+     */
+    struct Speculation {
+        uint64_t id = 0;        // 0 when nothing is in flight
+        std::string text;       // Partial transcript the request was built from
+        std::chrono::steady_clock::time_point sentAt;
+        std::chrono::steady_clock::time_point doneAt;
+        bool done = false;
+        bool claimed = false;   // The final transcript matched; deliver as it arrives
+        bool isError = false;
+        std::string response;
+        std::string buffered;   // Deltas received before the claim
+        std::shared_ptr<StreamedReply> reply;  // Streamed speculations only
+        LlmRequest request;     // Canceled when the speculation is discarded
+    };
+
     std::unique_ptr<AudioManager> audioManager_;
     std::unique_ptr<VoiceRecognizer> voiceRecognizer_;
     std::unique_ptr<LlmClient> llmClient_;
+    std::unique_ptr<VoiceActivityDetector> voiceActivityDetector_;
+    std::unique_ptr<FeatureFrontend> featureFrontend_;  // Shared by the stages below; mono capture only
+    std::unique_ptr<WakeWordSpotter> wakeWordSpotter_;
+    std::unique_ptr<IntentMatcher> intentMatcher_;
     
     VoiceAssistantConfig config_;
-    State state_ = State::IDLE;
+    // Read and set from the caller's, capture, recognizer and LLM callback threads
+    std::atomic<State> state_{State::IDLE};
+    bool monitoring_ = false;                // Recorder runs between turns to fill the pre-roll
+    std::atomic<bool> capturing_{false};     // Frames are passed on to the recognizer
+    std::atomic<bool> turnStarting_{false};  // Set by startListening, handled on the capture thread
+    std::unique_ptr<WorkerPool> controlWorker_;  // Runs what the capture thread hands off, in order
+    std::atomic<bool> shuttingDown_{false};  // Work still queued on controlWorker_ is dropped
     std::vector<Message> conversationHistory_;
-    std::mutex mutex_;
+    LlmRequest responseRequest_;             // Request for the current turn's response
+    mutable std::mutex mutex_;
+    
+    // Guards the fields below; taken before mutex_ when both are needed
+    mutable std::mutex speculationMutex_;
+    Speculation speculation_;
+    uint64_t nextSpeculationId_ = 1;
+    std::string stablePartial_;
+    std::chrono::steady_clock::time_point stablePartialSince_;
+    SpeculationStats speculationStats_;
     
     StateChangeCallback stateChangeCallback_;
     TranscriptionCallback transcriptionCallback_;
+    PartialTranscriptionCallback partialTranscriptionCallback_;
     ResponseCallback responseCallback_;
     ErrorCallback errorCallback_;
+    VoiceActivityCallback voiceActivityCallback_;
+    WakeWordCallback wakeWordCallback_;
+    IntentCallback intentCallback_;
     
     void setState(State state);
+    bool startRecorder();
+    void handleAudioFrame(AudioSampleView samples, bool isFinal);
+    void handleWakeWord();
+    void startWakeWordTurn();
+    void handlePartialTranscription(const std::string& text);
     void handleTranscription(const std::string& text);
-    void handleLlmResponse(const std::string& response);
+    bool handleIntent(const std::string& text);
+    void requestResponse();
+    void maybeSpeculate();
+    void dispatchSpeculation(uint64_t id, const std::string& text);
+    void handleSpeculativeDelta(uint64_t id, const std::string& delta);
+    void handleSpeculativeResponse(uint64_t id, const std::string& response, bool isError);
+    bool claimSpeculation(const std::string& text);
+    void discardSpeculationLocked();
+    void handleResponseDelta(StreamedReply& reply, const std::string& delta);
+    void handleLlmResponse(const std::string& response, size_t spokenChars = 0);
+    void respond(const std::string& response, size_t spokenChars = 0);
     void reportError(const std::string& error);
 };
 
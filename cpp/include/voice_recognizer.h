@@ -1,6 +1,10 @@
 #ifndef VOICE_RECOGNIZER_H
 #define VOICE_RECOGNIZER_H
 
+#include "audio_buffer.h"
+#include "feature_frontend.h"
+
+#include <chrono>
 #include <string>
 #include <functional>
 #include <memory>
@@ -16,18 +20,39 @@ struct VoiceRecognizerConfig {
     float speechThreshold = 0.2f;
     int maxRecordingTimeMs = 15000;
     int silenceTimeoutMs = 2000;
+    int partialIntervalMs = 200;  // Minimum spacing of partial results; 0 disables them
+    bool recoverFailures = true;  // Wrap the engine in a ResilientVoiceRecognizer
+    bool warmStandby = true;      // Keep a second, prepared engine ready to take over
+    int recoveryBackoffMs = 250;  // Delay before retrying a failed rebuild; doubles per failure
+    int maxRecoveryBackoffMs = 30000;
 };
 
 /**
  * @brief Abstract base class for voice recognition functionality
+ *
+ * Transcriptions arrive through TranscriptionCallback. Final results carry
+ * isFinal = true. While an utterance is in progress, engines that produce
+ * hypotheses also deliver partial results with isFinal = false: the words
+ * the last two hypotheses agree on, at most once per partialIntervalMs and
+ * only when they change. A change that arrives within the interval is held
+ * back and sent with a later hypothesis, or just before the final result.
  */
 class VoiceRecognizer {
 public:
-    using TranscriptionCallback = std::function<void(const std::string&, bool)>;
+    using TranscriptionCallback = std::function<void(const std::string& text, bool isFinal)>;
+    using FailureCallback = std::function<void(const std::string& reason)>;
     
     VoiceRecognizer(const VoiceRecognizerConfig& config = VoiceRecognizerConfig());
     virtual ~VoiceRecognizer();
 
+    /**
+     * @brief Acquires the engine's resources ahead of startListening()
+     *
+     * Lets a standby engine take over quickly. The default does nothing.
+     * @return false if the engine cannot be set up
+     */
+    virtual bool prepare();
+    
     /**
      * @brief Starts listening for voice input
      * @param callback Function to call when transcription is available
@@ -44,10 +69,52 @@ public:
      */
     virtual bool isListening() const;
     
+    /**
+     * @brief Checks whether the engine transcribes the audio fed through
+     *        processAudio() and processFeatures()
+     *
+     * False, the default, for engines that capture from a microphone
+     * themselves or do not recognize anything yet.
+     */
+    virtual bool acceptsPushedAudio() const;
+    
+    /**
+     * @brief Feeds captured audio to engines that do not own a capture path
+     *
+     * The default implementation ignores the samples.
+     */
+    virtual void processAudio(AudioSampleView samples);
+    
+    /**
+     * @brief Feeds acoustic features of the audio passed to processAudio()
+     *
+     * Frames firstFrame to firstFrame + count - 1 of the shared matrix are
+     * new. The matrix is owned by the capture thread, so rows must be copied
+     * out before returning. The default implementation ignores the frames.
+     */
+    virtual void processFeatures(const FeatureMatrix& features, uint64_t firstFrame, size_t count);
+    
+    /**
+     * @brief Signals that the speaker has stopped, so the current utterance
+     *        should be finalized without waiting for the engine's own timeout
+     */
+    virtual void finalizeUtterance();
+    
+    /**
+     * @brief Sets the callback engines use to report that they stopped working
+     *
+     * Called from the engine's own thread, which must not be blocked. Must be
+     * set before listening starts.
+     */
+    void setFailureCallback(FailureCallback callback);
+    
     /**
      * @brief Sets the configuration
+     *
+     * Wrappers override this to pass the configuration on to the engines
+     * they hold.
      */
-    void setConfig(const VoiceRecognizerConfig& config);
+    virtual void setConfig(const VoiceRecognizerConfig& config);
     
     /**
      * @brief Gets the current configuration
@@ -58,10 +125,39 @@ protected:
     VoiceRecognizerConfig config_;
     bool listening_ = false;
     TranscriptionCallback callback_;
+    FailureCallback failureCallback_;
+    
+    /**
+     * @brief Reports an engine hypothesis for the current utterance
+     *
+     * Derives the stable prefix and passes it on as a partial result when
+     * it changed and the partial interval has elapsed; otherwise it is kept
+     * pending.
+     */
+    void reportHypothesis(const std::string& hypothesis);
+    
+    /**
+     * @brief Reports the final text of an utterance and resets partial tracking
+     */
+    void reportFinal(const std::string& text);
+    
+    /**
+     * @brief Reports that the engine failed and will not recover by itself
+     */
+    void reportFailure(const std::string& reason);
+
+private:
+    std::string lastHypothesis_;
+    std::string lastPartial_;
+    std::string pendingPartial_;  // Changed stable prefix held back by the partial interval
+    std::chrono::steady_clock::time_point lastPartialTime_;
 };
 
 /**
  * @brief Creates platform-specific voice recognizer instance
+ *
+ * Unless VoiceRecognizerConfig::recoverFailures is off, the engine is wrapped
+ * in a ResilientVoiceRecognizer.
  */
 std::unique_ptr<VoiceRecognizer> createVoiceRecognizer(const VoiceRecognizerConfig& config = VoiceRecognizerConfig());
 
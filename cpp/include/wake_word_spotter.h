@@ -0,0 +1,105 @@
+#ifndef WAKE_WORD_SPOTTER_H
+#define WAKE_WORD_SPOTTER_H
+
+#include "audio_buffer.h"
+#include "feature_frontend.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Always-on wake phrase detector matched against enrolled recordings
+ *
+ * Each recording of the wake phrase is reduced to a template of log-mel
+ * frames, trimmed to its loud part, mean-normalized with the same running
+ * average the live stream uses and scaled to unit length. Live frames are
+ * matched against every template by streaming subsequence DTW: one column
+ * of the cost matrix per 10 ms hop, with the template allowed to advance by
+ * zero to two frames per input frame, so the phrase may be spoken at half
+ * to twice the enrolled pace. Frame distances are cosine distances computed
+ * with SIMD dot products; a detection fires when the average distance along
+ * the best path that ends on a template's last frame drops below the
+ * threshold. With a few one-second templates this costs well under 1% of a
+ * core at 16 kHz.
+ *
+ * Live audio can be fed as samples, or as frames from a FeatureFrontend
+ * shared with other stages, as long as that frontend uses the same
+ * FeatureConfig as the spotter.
+ */
+class WakeWordSpotter {
+public:
+    /**
+     * @param features Feature settings; only the log-mel part is used
+     * @param threshold Average cosine distance (0..2) below which a match counts
+     */
+    explicit WakeWordSpotter(const FeatureConfig& features = FeatureConfig(), float threshold = 0.3f);
+
+    /**
+     * @brief Enrolls one recording of the wake phrase, in mono at the spotter's rate
+     *
+     * @return false if the recording holds too little speech to be useful
+     */
+    bool addTemplate(AudioSampleView recording);
+
+    /**
+     * @brief Number of templates enrolled
+     */
+    size_t templateCount() const;
+
+    /**
+     * @brief Feeds mono capture samples of any count
+     *
+     * @return true if the wake phrase ended within these samples
+     */
+    bool process(AudioSampleView samples);
+
+    /**
+     * @brief Feeds one frame computed by a frontend with the same configuration
+     *
+     * @param logMel The frame's log-mel bands
+     * @return true if the wake phrase ended on this frame
+     */
+    bool processFrame(const float* logMel);
+
+    /**
+     * @brief Forgets partial matches, e.g. after a detection has been acted on
+     */
+    void reset();
+
+    /**
+     * @brief Best average distance seen in the last process() or processFrame() call, for tuning the threshold
+     */
+    float getLastScore() const;
+
+    void setThreshold(float threshold);
+    float getThreshold() const;
+
+private:
+    struct Template {
+        size_t length = 0;
+        AlignedBuffer<float> frames;     // length x bands, unit-length rows
+        std::vector<float> cost;         // Best path cost ending on each template frame
+        std::vector<float> nextCost;
+        std::vector<uint32_t> pathLength;
+        std::vector<uint32_t> nextPathLength;
+    };
+
+    FeatureConfig features_;
+    FeatureFrontend frontend_;
+    float threshold_;
+    std::vector<Template> templates_;
+    AlignedBuffer<float> mean_;          // Running feature mean of the live stream
+    AlignedBuffer<float> normalized_;
+    bool meanValid_ = false;
+    size_t refractoryFrames_ = 0;
+    float lastScore_ = 2.0f;
+
+    void resetPaths();
+};
+
+} // namespace voice_assist
+
+#endif // WAKE_WORD_SPOTTER_H
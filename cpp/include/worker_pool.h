@@ -0,0 +1,55 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace voice_assist {
+
+/**
+ * @brief Fixed set of threads running posted tasks in FIFO order
+ *
+ * The queue itself is unbounded; callers bound what they post, e.g. one
+ * task per request in flight. Tasks posted from inside a task are fine.
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads Number of worker threads; at least one is started
+     */
+    explicit WorkerPool(size_t threads);
+
+    /**
+     * @brief Runs the tasks still queued, then joins the threads
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Queues a task; ignored once the pool is shutting down
+     * @return false if the task was not queued
+     */
+    bool post(Task task);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    void run();
+};
+
+} // namespace voice_assist
+
+#endif // WORKER_POOL_H
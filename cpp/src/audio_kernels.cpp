@@ -0,0 +1,539 @@
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// The instruction set is picked at compile time. x86-64 always has SSE2;
+// AVX2 has to be enabled explicitly since it is not baseline.
+#if defined(__AVX2__)
+    #define VOICE_ASSIST_AVX2 1
+    #include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VOICE_ASSIST_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define VOICE_ASSIST_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace voice_assist {
+namespace kernels {
+
+namespace {
+
+constexpr float kInt16Scale = 32768.0f;
+constexpr float kInt16Max = 32767.0f;
+constexpr float kInt16Min = -32768.0f;
+
+inline int16_t saturate(float value) {
+    value = std::min(std::max(value, kInt16Min), kInt16Max);
+    return static_cast<int16_t>(std::lrint(value));
+}
+
+#if defined(VOICE_ASSIST_NEON)
+inline int32x4_t roundToInt(float32x4_t value) {
+#if defined(__aarch64__)
+    return vcvtnq_s32_f32(value);
+#else
+    // ARMv7 only truncates; round half away from zero instead
+    const uint32x4_t negative = vcltq_f32(value, vdupq_n_f32(0.0f));
+    const float32x4_t half = vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+    return vcvtq_s32_f32(vaddq_f32(value, half));
+#endif
+}
+#endif
+
+} // namespace
+
+const char* instructionSet() {
+#if defined(VOICE_ASSIST_AVX2)
+    return "avx2";
+#elif defined(VOICE_ASSIST_SSE2)
+    return "sse2";
+#elif defined(VOICE_ASSIST_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void int16ToFloat(const int16_t* in, float* out, size_t count) {
+    const float scale = 1.0f / kInt16Scale;
+    size_t i = 0;
+
+#if defined(VOICE_ASSIST_AVX2)
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(values, vscale));
+    }
+#elif defined(VOICE_ASSIST_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend by placing each sample in the high half and shifting back down
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), vscale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), vscale));
+    }
+#elif defined(VOICE_ASSIST_NEON)
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t samples = vld1q_s16(in + i);
+        float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(out + i, vmulq_f32(low, vscale));
+        vst1q_f32(out + i + 4, vmulq_f32(high, vscale));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) * scale;
+    }
+}
+
+void floatToInt16(const float* in, int16_t* out, size_t count) {
+    size_t i = 0;
+
+#if defined(VOICE_ASSIST_AVX2)
+    const __m256 vscale = _mm256_set1_ps(kInt16Scale);
+    const __m256 vmax = _mm256_set1_ps(kInt16Max);
+    const __m256 vmin = _mm256_set1_ps(kInt16Min);
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(in + i), vscale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), vscale);
+        a = _mm256_min_ps(_mm256_max_ps(a, vmin), vmax);
+        b = _mm256_min_ps(_mm256_max_ps(b, vmin), vmax);
+        // packs works per 128-bit lane, so restore sample order afterwards
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+#elif defined(VOICE_ASSIST_SSE2)
+    const __m128 vscale = _mm_set1_ps(kInt16Scale);
+    const __m128 vmax = _mm_set1_ps(kInt16Max);
+    const __m128 vmin = _mm_set1_ps(kInt16Min);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(in + i), vscale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(in + i + 4), vscale);
+        a = _mm_min_ps(_mm_max_ps(a, vmin), vmax);
+        b = _mm_min_ps(_mm_max_ps(b, vmin), vmax);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#elif defined(VOICE_ASSIST_NEON)
+    const float32x4_t vscale = vdupq_n_f32(kInt16Scale);
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = roundToInt(vmulq_f32(vld1q_f32(in + i), vscale));
+        int32x4_t b = roundToInt(vmulq_f32(vld1q_f32(in + i + 4), vscale));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = saturate(in[i] * kInt16Scale);
+    }
+}
+
+void applyGain(const int16_t* in, int16_t* out, size_t count, float gain) {
+    if (gain == 1.0f) {
+        if (in != out) {
+            std::memmove(out, in, count * sizeof(int16_t));
+        }
+        return;
+    }
+
+    size_t i = 0;
+
+#if defined(VOICE_ASSIST_AVX2)
+    const __m256 vgain = _mm256_set1_ps(gain);
+    const __m256 vmax = _mm256_set1_ps(kInt16Max);
+    const __m256 vmin = _mm256_set1_ps(kInt16Min);
+    for (; i + 16 <= count; i += 16) {
+        __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256 a = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(samples)));
+        __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(samples, 1)));
+        a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(a, vgain), vmin), vmax);
+        b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(b, vgain), vmin), vmax);
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+#elif defined(VOICE_ASSIST_SSE2)
+    const __m128 vgain = _mm_set1_ps(gain);
+    const __m128 vmax = _mm_set1_ps(kInt16Max);
+    const __m128 vmin = _mm_set1_ps(kInt16Min);
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128 a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+        __m128 b = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+        a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(a, vgain), vmin), vmax);
+        b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(b, vgain), vmin), vmax);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif defined(VOICE_ASSIST_NEON)
+    const float32x4_t vgain = vdupq_n_f32(gain);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t samples = vld1q_s16(in + i);
+        float32x4_t a = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        float32x4_t b = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        int32x4_t scaledA = roundToInt(vmulq_f32(a, vgain));
+        int32x4_t scaledB = roundToInt(vmulq_f32(b, vgain));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(scaledA), vqmovn_s32(scaledB)));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = saturate(static_cast<float>(in[i]) * gain);
+    }
+}
+
+int32_t peakAbs(const int16_t* samples, size_t count) {
+    int32_t maxValue = 0;
+    int32_t minValue = 0;
+    size_t i = 0;
+
+#if defined(VOICE_ASSIST_AVX2)
+    __m256i vmax = _mm256_setzero_si256();
+    __m256i vmin = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        vmax = _mm256_max_epi16(vmax, values);
+        vmin = _mm256_min_epi16(vmin, values);
+    }
+    alignas(32) int16_t lanesMax[16];
+    alignas(32) int16_t lanesMin[16];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanesMax), vmax);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanesMin), vmin);
+    for (int lane = 0; lane < 16; ++lane) {
+        maxValue = std::max<int32_t>(maxValue, lanesMax[lane]);
+        minValue = std::min<int32_t>(minValue, lanesMin[lane]);
+    }
+#elif defined(VOICE_ASSIST_SSE2)
+    __m128i vmax = _mm_setzero_si128();
+    __m128i vmin = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        vmax = _mm_max_epi16(vmax, values);
+        vmin = _mm_min_epi16(vmin, values);
+    }
+    alignas(16) int16_t lanesMax[8];
+    alignas(16) int16_t lanesMin[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanesMax), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanesMin), vmin);
+    for (int lane = 0; lane < 8; ++lane) {
+        maxValue = std::max<int32_t>(maxValue, lanesMax[lane]);
+        minValue = std::min<int32_t>(minValue, lanesMin[lane]);
+    }
+#elif defined(VOICE_ASSIST_NEON)
+    int16x8_t vmax = vdupq_n_s16(0);
+    int16x8_t vmin = vdupq_n_s16(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t values = vld1q_s16(samples + i);
+        vmax = vmaxq_s16(vmax, values);
+        vmin = vminq_s16(vmin, values);
+    }
+    int16_t lanesMax[8];
+    int16_t lanesMin[8];
+    vst1q_s16(lanesMax, vmax);
+    vst1q_s16(lanesMin, vmin);
+    for (int lane = 0; lane < 8; ++lane) {
+        maxValue = std::max<int32_t>(maxValue, lanesMax[lane]);
+        minValue = std::min<int32_t>(minValue, lanesMin[lane]);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        maxValue = std::max<int32_t>(maxValue, samples[i]);
+        minValue = std::min<int32_t>(minValue, samples[i]);
+    }
+    return std::max(maxValue, -minValue);
+}
+
+uint64_t sumSquares(const int16_t* samples, size_t count) {
+    uint64_t total = 0;
+    size_t i = 0;
+
+    // madd produces pair sums of at most 2^31, which fit when treated as unsigned;
+    // they are widened to 64 bits before accumulating
+#if defined(VOICE_ASSIST_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        __m256i pairs = _mm256_madd_epi16(values, values);
+        acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(pairs, zero));
+        acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(pairs, zero));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(VOICE_ASSIST_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        __m128i pairs = _mm_madd_epi16(values, values);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(pairs, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(pairs, zero));
+    }
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    total = lanes[0] + lanes[1];
+#elif defined(VOICE_ASSIST_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t values = vld1q_s16(samples + i);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(values), vget_low_s16(values)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(values), vget_high_s16(values)));
+    }
+    total = static_cast<uint64_t>(vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1));
+#endif
+
+    for (; i < count; ++i) {
+        const int32_t value = samples[i];
+        total += static_cast<uint64_t>(value * value);
+    }
+    return total;
+}
+
+float rms(const int16_t* samples, size_t count) {
+    if (count == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(std::sqrt(static_cast<double>(sumSquares(samples, count)) / count));
+}
+
+float dotProduct(const float* a, const float* b, size_t count) {
+    size_t i = 0;
+    float total = 0.0f;
+
+#if defined(VOICE_ASSIST_AVX2)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    for (float lane : lanes) {
+        total += lane;
+    }
+#elif defined(VOICE_ASSIST_SSE2)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(VOICE_ASSIST_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vaddq_f32(acc0, acc1));
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+    for (; i < count; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+void multiplyAdd(float* y, const float* x, float scale, size_t count) {
+    size_t i = 0;
+
+#if defined(VOICE_ASSIST_AVX2)
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m256 result = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(x + i), vscale));
+        _mm256_storeu_ps(y + i, result);
+    }
+#elif defined(VOICE_ASSIST_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(x + i), vscale)));
+    }
+#elif defined(VOICE_ASSIST_NEON)
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), vld1q_f32(x + i), vscale));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        y[i] += scale * x[i];
+    }
+}
+
+void deinterleave(const int16_t* in, int16_t* const* planes, size_t channels, size_t frames) {
+    if (channels == 1) {
+        std::memcpy(planes[0], in, frames * sizeof(int16_t));
+        return;
+    }
+
+    size_t frame = 0;
+
+    if (channels == 2) {
+        int16_t* left = planes[0];
+        int16_t* right = planes[1];
+#if defined(VOICE_ASSIST_SSE2)
+        for (; frame + 8 <= frames; frame += 8) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * frame));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * frame + 8));
+            // Each 32-bit lane holds one L/R pair; split the halves with shifts
+            __m128i leftA = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+            __m128i leftB = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+            __m128i rightA = _mm_srai_epi32(a, 16);
+            __m128i rightB = _mm_srai_epi32(b, 16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(left + frame), _mm_packs_epi32(leftA, leftB));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(right + frame), _mm_packs_epi32(rightA, rightB));
+        }
+#elif defined(VOICE_ASSIST_NEON)
+        for (; frame + 8 <= frames; frame += 8) {
+            int16x8x2_t pair = vld2q_s16(in + 2 * frame);
+            vst1q_s16(left + frame, pair.val[0]);
+            vst1q_s16(right + frame, pair.val[1]);
+        }
+#endif
+        for (; frame < frames; ++frame) {
+            left[frame] = in[2 * frame];
+            right[frame] = in[2 * frame + 1];
+        }
+        return;
+    }
+
+    for (; frame < frames; ++frame) {
+        for (size_t channel = 0; channel < channels; ++channel) {
+            planes[channel][frame] = in[frame * channels + channel];
+        }
+    }
+}
+
+void interleave(const int16_t* const* planes, int16_t* out, size_t channels, size_t frames) {
+    if (channels == 1) {
+        std::memcpy(out, planes[0], frames * sizeof(int16_t));
+        return;
+    }
+
+    size_t frame = 0;
+
+    if (channels == 2) {
+        const int16_t* left = planes[0];
+        const int16_t* right = planes[1];
+#if defined(VOICE_ASSIST_SSE2)
+        for (; frame + 8 <= frames; frame += 8) {
+            __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + frame));
+            __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + frame));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame + 8), _mm_unpackhi_epi16(l, r));
+        }
+#elif defined(VOICE_ASSIST_NEON)
+        for (; frame + 8 <= frames; frame += 8) {
+            int16x8x2_t pair;
+            pair.val[0] = vld1q_s16(left + frame);
+            pair.val[1] = vld1q_s16(right + frame);
+            vst2q_s16(out + 2 * frame, pair);
+        }
+#endif
+        for (; frame < frames; ++frame) {
+            out[2 * frame] = left[frame];
+            out[2 * frame + 1] = right[frame];
+        }
+        return;
+    }
+
+    for (; frame < frames; ++frame) {
+        for (size_t channel = 0; channel < channels; ++channel) {
+            out[frame * channels + channel] = planes[channel][frame];
+        }
+    }
+}
+
+void mixChannels(const int16_t* in, size_t inChannels, int16_t* out, size_t outChannels, size_t frames) {
+    if (inChannels == outChannels) {
+        std::memmove(out, in, frames * inChannels * sizeof(int16_t));
+        return;
+    }
+
+    size_t frame = 0;
+
+    if (inChannels == 2 && outChannels == 1) {
+#if defined(VOICE_ASSIST_SSE2)
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; frame + 8 <= frames; frame += 8) {
+            // madd sums each L/R pair into 32 bits; halve and pack back down
+            __m128i a = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * frame)), ones);
+            __m128i b = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * frame + 8)), ones);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + frame),
+                             _mm_packs_epi32(_mm_srai_epi32(a, 1), _mm_srai_epi32(b, 1)));
+        }
+#elif defined(VOICE_ASSIST_NEON)
+        for (; frame + 8 <= frames; frame += 8) {
+            int16x8x2_t pair = vld2q_s16(in + 2 * frame);
+            vst1q_s16(out + frame, vhaddq_s16(pair.val[0], pair.val[1]));
+        }
+#endif
+        for (; frame < frames; ++frame) {
+            out[frame] = static_cast<int16_t>((in[2 * frame] + in[2 * frame + 1]) >> 1);
+        }
+        return;
+    }
+
+    if (inChannels == 1 && outChannels == 2) {
+#if defined(VOICE_ASSIST_SSE2)
+        for (; frame + 8 <= frames; frame += 8) {
+            __m128i mono = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + frame));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame), _mm_unpacklo_epi16(mono, mono));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame + 8), _mm_unpackhi_epi16(mono, mono));
+        }
+#elif defined(VOICE_ASSIST_NEON)
+        for (; frame + 8 <= frames; frame += 8) {
+            int16x8x2_t pair;
+            pair.val[0] = vld1q_s16(in + frame);
+            pair.val[1] = pair.val[0];
+            vst2q_s16(out + 2 * frame, pair);
+        }
+#endif
+        for (; frame < frames; ++frame) {
+            out[2 * frame] = in[frame];
+            out[2 * frame + 1] = in[frame];
+        }
+        return;
+    }
+
+    for (; frame < frames; ++frame) {
+        const int16_t* source = in + frame * inChannels;
+        int16_t* target = out + frame * outChannels;
+        if (outChannels < inChannels) {
+            for (size_t channel = 0; channel < outChannels; ++channel) {
+                int32_t sum = 0;
+                int32_t count = 0;
+                for (size_t from = channel; from < inChannels; from += outChannels) {
+                    sum += source[from];
+                    ++count;
+                }
+                target[channel] = static_cast<int16_t>(sum / count);
+            }
+        } else {
+            for (size_t channel = 0; channel < outChannels; ++channel) {
+                target[channel] = source[channel % inChannels];
+            }
+        }
+    }
+}
+
+} // namespace kernels
+} // namespace voice_assist
@@ -1,5 +1,9 @@
 #include "audio_manager.h"
+#include "file_audio_manager.h"
+#include "audio_kernels.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 
 #ifdef _WIN32
     // Windows-specific includes
@@ -11,19 +15,30 @@
     // CoreAudio headers would go here
 #else
     // Linux-specific includes
-    // PulseAudio headers would go here
+    #include <pulse/pulseaudio.h>
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <chrono>
 #endif
 
 namespace voice_assist {
 
+namespace {
+
+// Far-end audio the device may render ahead of capture, as the echo
+// canceller's own queue allows, and how much the capture thread converts at a time
+constexpr int kFarEndBufferMs = 2000;
+constexpr int kFarEndChunkMs = 20;
+
+} // namespace
+
 AudioManager::AudioManager(const AudioConfig& config)
     : config_(config), recording_(false) {
 }
 
 AudioManager::~AudioManager() {
-    if (recording_) {
-        stopRecording();
-    }
+    // Derived classes stop themselves; the pure virtual cannot be called from here
 }
 
 bool AudioManager::isRecording() const {
@@ -43,6 +58,435 @@ const AudioConfig& AudioManager::getConfig() const {
     return config_;
 }
 
+CaptureStats AudioManager::getCaptureStats() const {
+    CaptureStats stats;
+    stats.deliveredFrames = deliveredFrames_.load(std::memory_order_relaxed);
+    stats.overruns = overruns_.load(std::memory_order_relaxed);
+    stats.droppedSamples = droppedSamples_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t AudioManager::captureFrameSamples() const {
+    const AudioFormat& format = config_.format;
+    size_t samples = static_cast<size_t>(format.sampleRate) * format.channels * config_.bufferSizeMs / 1000;
+    return std::max<size_t>(samples, format.channels);
+}
+
+size_t AudioManager::captureChunkSamples() const {
+    return captureFrameSamples();
+}
+
+void AudioManager::prepareCaptureBuffer() {
+    const size_t frameSamples = captureFrameSamples();
+    const size_t frames = static_cast<size_t>(std::max(config_.captureBufferFrames, 2));
+    
+    // All capture memory is allocated here so the audio thread never touches the heap
+    captureBuffer_.reset(frameSamples * frames);
+    frameScratch_.assign(frameSamples, 0);
+    processScratch_.assign(std::max(captureChunkSamples(), frameSamples), 0);
+    
+    const AudioFormat& format = config_.format;
+    const size_t frame = static_cast<size_t>(std::max(format.channels, 1));
+    preRollSamples_ = static_cast<size_t>(format.sampleRate) * frame * std::max(config_.preRollMs, 0) / 1000 / frame * frame;
+    preRoll_.reset(preRollSamples_);
+    
+    // The device thread only touches the far-end ring, never the canceller
+    echoCanceller_.reset();
+    if (config_.echoCancellation) {
+        if (config_.format.channels == 1) {
+            echoCanceller_ = std::make_unique<EchoCanceller>(config_.format.sampleRate, config_.echoTailMs);
+        } else {
+            std::cerr << "Echo cancellation is only supported for mono capture" << std::endl;
+        }
+    }
+    {
+        // The capture thread is not running yet, so this thread stands in as
+        // the ring's consumer; audio played since the last recording is stale
+        std::lock_guard<std::mutex> lock(playbackMutex_);
+        if (farEndReady_) {
+            farEndBuffer_.clear();
+            createFarEndConverter();
+        }
+    }
+    
+    noiseSuppressor_.reset();
+    if (config_.noiseSuppression) {
+        if (config_.format.channels == 1) {
+            noiseSuppressor_ = std::make_unique<NoiseSuppressor>(config_.format.sampleRate);
+        } else {
+            std::cerr << "Noise suppression is only supported for mono capture" << std::endl;
+        }
+    }
+    
+    deliveredFrames_ = 0;
+    overruns_ = 0;
+    droppedSamples_ = 0;
+    underruns_ = 0;
+}
+
+size_t AudioManager::pushCaptureSamples(const int16_t* samples, size_t count) {
+    size_t written = captureBuffer_.write(samples, count);
+    if (written < count) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedSamples_.fetch_add(count - written, std::memory_order_relaxed);
+    }
+    return written;
+}
+
+size_t AudioManager::pushCaptureSilence(size_t count) {
+    size_t written = captureBuffer_.writeZeros(count);
+    if (written < count) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedSamples_.fetch_add(count - written, std::memory_order_relaxed);
+    }
+    return written;
+}
+
+bool AudioManager::hasCaptureFrame() const {
+    return !frameScratch_.empty() && captureBuffer_.readAvailable() >= frameScratch_.size();
+}
+
+bool AudioManager::deliverCaptureFrame(bool isFinal) {
+    const size_t frameSamples = frameScratch_.size();
+    const size_t available = captureBuffer_.readAvailable();
+    if (frameSamples == 0 || (available < frameSamples && !isFinal)) {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    auto region = captureBuffer_.peek(frameSamples);
+    AudioSampleView view(region.first, region.firstSize);
+    if (region.secondSize > 0) {
+        // The frame wraps around the end of the ring; stitch it in the scratch frame
+        std::copy(region.first, region.first + region.firstSize, frameScratch_.begin());
+        std::copy(region.second, region.second + region.secondSize,
+                  frameScratch_.begin() + region.firstSize);
+        view = AudioSampleView(frameScratch_.data(), region.size());
+    }
+    
+    dispatchCaptureSamples(view, isFinal);
+    captureBuffer_.consume(region.size());
+    return true;
+}
+
+void AudioManager::dispatchCaptureSamples(AudioSampleView samples, bool isFinal) {
+    // A chunk larger than the processing scratch is split rather than
+    // growing the scratch on the capture thread
+    const bool process = echoCanceller_ || noiseSuppressor_ || config_.gainLevel != 1.0f;
+    const size_t frame = static_cast<size_t>(std::max(config_.format.channels, 1));
+    const size_t limit = process ? processScratch_.size() / frame * frame : samples.size;
+    if (process && limit == 0) {
+        return;  // prepareCaptureBuffer() was not called
+    }
+    
+    do {
+        AudioSampleView piece(samples.data, std::min(samples.size, limit));
+        samples = AudioSampleView(samples.data + piece.size, samples.size - piece.size);
+        const bool last = isFinal && samples.empty();
+        if (process && !piece.empty()) {
+            piece = processCapture(piece);
+        }
+        if (callback_ && (!piece.empty() || last)) {
+            callback_(piece, last);
+        }
+        appendPreRoll(piece);
+    } while (!samples.empty());
+    deliveredFrames_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t AudioManager::drainPreRoll(const std::function<void(AudioSampleView)>& sink) {
+    auto region = preRoll_.peek(preRoll_.readAvailable());
+    if (region.firstSize > 0) {
+        sink(AudioSampleView(region.first, region.firstSize));
+    }
+    if (region.secondSize > 0) {
+        sink(AudioSampleView(region.second, region.secondSize));
+    }
+    preRoll_.consume(region.size());
+    return region.size();
+}
+
+void AudioManager::appendPreRoll(AudioSampleView samples) {
+    if (preRollSamples_ == 0 || samples.empty()) {
+        return;
+    }
+    
+    // Overwrite the oldest audio; the ring is preallocated, so this never allocates
+    if (samples.size >= preRollSamples_) {
+        preRoll_.clear();
+        preRoll_.write(samples.end() - preRollSamples_, preRollSamples_);
+        return;
+    }
+    const size_t held = preRoll_.readAvailable();
+    if (held + samples.size > preRollSamples_) {
+        preRoll_.consume(held + samples.size - preRollSamples_);
+    }
+    preRoll_.write(samples.data, samples.size);
+}
+
+AudioSampleView AudioManager::processCapture(AudioSampleView samples) {
+    // dispatchCaptureSamples() keeps samples within the scratch
+    int16_t* out = processScratch_.data();
+    const int16_t* in = samples.data;
+    
+    // Cancel echo first so the noise estimate does not track playback, and
+    // suppress noise before applying gain so the estimate is gain-independent
+    if (echoCanceller_) {
+        drainFarEnd();
+        echoCanceller_->process(in, out, samples.size);
+        in = out;
+    }
+    if (noiseSuppressor_) {
+        noiseSuppressor_->process(in, out, samples.size);
+        in = out;
+    }
+    kernels::applyGain(in, out, samples.size, config_.gainLevel);
+    
+    return AudioSampleView(out, samples.size);
+}
+
+void AudioManager::submitFarEnd(const int16_t* samples, size_t count) {
+    // Whole chunks only, so a multichannel ring never loses frame alignment.
+    // A full ring means capture has stalled or echo cancellation is off; the
+    // reference is dropped rather than blocking playback.
+    if (farEndBuffer_.writeAvailable() >= count) {
+        farEndBuffer_.write(samples, count);
+    }
+}
+
+void AudioManager::openFarEnd(const AudioFormat& format) {
+    // Called with playbackMutex_ held, before the device starts. The capture
+    // thread ignores the ring until farEndReady_ is set.
+    const size_t frame = static_cast<size_t>(format.channels);
+    farEndFormat_ = format;
+    farEndBuffer_.reset(static_cast<size_t>(format.sampleRate) * frame * kFarEndBufferMs / 1000);
+    farEndScratch_.assign(std::max<size_t>(static_cast<size_t>(format.sampleRate) * kFarEndChunkMs / 1000, 1) * frame, 0);
+    createFarEndConverter();
+    farEndReady_.store(true, std::memory_order_release);
+}
+
+void AudioManager::createFarEndConverter() {
+    // Called with playbackMutex_ held, while the capture thread is stopped or
+    // before farEndReady_ lets it see the converter
+    farEndConverter_.reset();
+    if (!config_.echoCancellation || config_.format.channels != 1) {
+        return;
+    }
+    AudioFormat to;
+    to.sampleRate = config_.format.sampleRate;
+    to.channels = 1;
+    farEndConverter_ = std::make_unique<FormatConverter>(farEndFormat_, to);
+}
+
+void AudioManager::drainFarEnd() {
+    // Capture thread only
+    if (!farEndReady_.load(std::memory_order_acquire) || !farEndConverter_) {
+        return;
+    }
+    
+    const size_t frame = static_cast<size_t>(farEndFormat_.channels);
+    while (true) {
+        const size_t count = std::min(farEndBuffer_.readAvailable(), farEndScratch_.size()) / frame * frame;
+        if (count == 0) {
+            break;
+        }
+        farEndBuffer_.read(farEndScratch_.data(), count);
+        
+        // The converter keeps its filter state, so chunks of one stream join up
+        AudioSampleView reference = farEndConverter_->convert(AudioSampleView(farEndScratch_.data(), count));
+        echoCanceller_->pushFarEnd(reference.data, reference.size);
+    }
+}
+
+bool AudioManager::playAudio(const std::vector<int16_t>& audioData, const AudioFormat& format) {
+    if (audioData.empty()) {
+        return true;
+    }
+    
+    PlaybackHandle handle = queueAudio(audioData, format);
+    return handle != 0 && waitPlayback(handle);
+}
+
+PlaybackHandle AudioManager::queueAudio(const std::vector<int16_t>& audioData, const AudioFormat& format) {
+    PlaybackHandle handle = openPlayback(format);
+    if (handle == 0) {
+        return 0;
+    }
+    
+    writePlayback(handle, AudioSampleView(audioData.data(), audioData.size()));
+    closePlayback(handle);
+    return handle;
+}
+
+PlaybackHandle AudioManager::speakAsync(const std::string& text, const std::string& voice) {
+    speak(text, voice);
+    return 0;
+}
+
+PlaybackHandle AudioManager::openPlayback(const AudioFormat& format) {
+    if (format.sampleRate <= 0 || format.channels <= 0) {
+        std::cerr << "Invalid playback format" << std::endl;
+        return 0;
+    }
+    
+    std::shared_ptr<PlaybackQueue> queue;
+    {
+        std::lock_guard<std::mutex> lock(playbackMutex_);
+        if (!playbackQueue_) {
+            // The device is opened on first use, in the format of the first stream
+            playbackQueue_ = std::make_shared<PlaybackQueue>(format, config_.playbackQueueMs,
+                                                             config_.playbackPrebufferMs);
+            openFarEnd(format);
+            if (!startPlaybackDevice(format)) {
+                farEndReady_ = false;
+                playbackQueue_.reset();
+                return 0;
+            }
+        }
+        queue = playbackQueue_;
+    }
+    
+    return queue->open(format);
+}
+
+bool AudioManager::writePlayback(PlaybackHandle handle, AudioSampleView samples) {
+    std::shared_ptr<PlaybackQueue> queue = getPlaybackQueue();
+    if (!queue || !queue->write(handle, samples, config_.gainLevel)) {
+        return false;
+    }
+    
+    playbackWake_.notify_one();
+    return true;
+}
+
+void AudioManager::closePlayback(PlaybackHandle handle) {
+    if (std::shared_ptr<PlaybackQueue> queue = getPlaybackQueue()) {
+        queue->close(handle);
+        playbackWake_.notify_one();
+    }
+}
+
+bool AudioManager::waitPlayback(PlaybackHandle handle, int timeoutMs) {
+    std::shared_ptr<PlaybackQueue> queue = getPlaybackQueue();
+    return queue && queue->wait(handle, timeoutMs);
+}
+
+void AudioManager::flushPlayback() {
+    if (std::shared_ptr<PlaybackQueue> queue = getPlaybackQueue()) {
+        queue->flush();
+        onPlaybackFlushed();
+    }
+}
+
+bool AudioManager::isPlaying() const {
+    std::shared_ptr<PlaybackQueue> queue = getPlaybackQueue();
+    return queue && queue->isActive();
+}
+
+PlaybackStats AudioManager::getPlaybackStats() const {
+    std::shared_ptr<PlaybackQueue> queue = getPlaybackQueue();
+    return queue ? queue->getStats() : PlaybackStats();
+}
+
+bool AudioManager::startPlaybackDevice(const AudioFormat&) {
+    playbackRunning_ = true;
+    playbackThread_ = std::thread(&AudioManager::playbackLoop, this);
+    return true;
+}
+
+void AudioManager::stopPlaybackDevice() {
+    {
+        std::lock_guard<std::mutex> lock(playbackWakeMutex_);
+        playbackRunning_ = false;
+    }
+    playbackWake_.notify_all();
+    if (playbackThread_.joinable()) {
+        playbackThread_.join();
+    }
+}
+
+void AudioManager::writePlaybackDevice(AudioSampleView) {
+    // No device; the audio is discarded at the rate it would have played
+}
+
+bool AudioManager::isPlaybackRealTime() const {
+    return true;
+}
+
+void AudioManager::onPlaybackFlushed() {
+}
+
+size_t AudioManager::renderPlayback(int16_t* out, size_t count) {
+    // The queue outlives the device, so the device thread reads it without locking
+    PlaybackQueue& queue = *playbackQueue_;
+    const bool active = queue.isActive();
+    const size_t rendered = queue.render(out, count);
+    
+    // Underrun gaps are passed on too, keeping the reference aligned with the device
+    if (rendered > 0 || active) {
+        submitFarEnd(out, count);
+    }
+    return rendered;
+}
+
+void AudioManager::shutdownPlayback() {
+    std::lock_guard<std::mutex> lock(playbackMutex_);
+    if (!playbackQueue_) {
+        return;
+    }
+    
+    // Release anyone still waiting on a stream before the device goes away
+    playbackQueue_->flush();
+    stopPlaybackDevice();
+    playbackQueue_.reset();
+    farEndReady_ = false;
+}
+
+std::shared_ptr<PlaybackQueue> AudioManager::getPlaybackQueue() const {
+    // The caller's reference keeps the queue alive past shutdownPlayback()
+    std::lock_guard<std::mutex> lock(playbackMutex_);
+    return playbackQueue_;
+}
+
+void AudioManager::playbackLoop() {
+    PlaybackQueue& queue = *playbackQueue_;
+    const AudioFormat& format = queue.getFormat();
+    const size_t frames = std::max<size_t>(
+        static_cast<size_t>(format.sampleRate) * std::max(config_.bufferSizeMs, 1) / 1000, 1);
+    const auto period = std::chrono::microseconds(static_cast<int64_t>(frames * 1000000 / format.sampleRate));
+    std::vector<int16_t> block(frames * format.channels);
+    auto due = std::chrono::steady_clock::now();
+    
+    while (playbackRunning_) {
+        if (!queue.isActive()) {
+            std::unique_lock<std::mutex> lock(playbackWakeMutex_);
+            playbackWake_.wait_for(lock, period, [this, &queue]() {
+                return !playbackRunning_ || queue.isActive();
+            });
+            due = std::chrono::steady_clock::now();
+            continue;
+        }
+        
+        const size_t rendered = renderPlayback(block.data(), block.size());
+        if (rendered > 0) {
+            writePlaybackDevice(AudioSampleView(block.data(), rendered));
+        }
+        
+        // A real device takes one period per block, whether or not it was full;
+        // otherwise only wait while the jitter buffer fills
+        if (isPlaybackRealTime()) {
+            due += period;
+        } else if (rendered == 0) {
+            due = std::chrono::steady_clock::now() + period;
+        } else {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(playbackWakeMutex_);
+        playbackWake_.wait_until(lock, due, [this]() { return !playbackRunning_; });
+    }
+}
+
 #ifdef _WIN32
 // Windows implementation
 
@@ -54,6 +498,7 @@ public:
     
     ~WindowsAudioManager() override {
         stopRecording();
+        shutdownPlayback();
     }
     
     bool startRecording(AudioSampleCallback callback) override {
@@ -62,6 +507,7 @@ public:
         }
         
         callback_ = std::move(callback);
+        prepareCaptureBuffer();
         
         // TODO: Implement Windows audio recording with waveIn API
         std::cout << "Windows audio recording started" << std::endl;
@@ -111,6 +557,7 @@ public:
     
     ~MacOSAudioManager() override {
         stopRecording();
+        shutdownPlayback();
     }
     
     bool startRecording(AudioSampleCallback callback) override {
@@ -119,6 +566,7 @@ public:
         }
         
         callback_ = std::move(callback);
+        prepareCaptureBuffer();
         
         // TODO: Implement macOS audio recording with CoreAudio
         std::cout << "macOS audio recording started" << std::endl;
@@ -164,57 +612,382 @@ public:
     LinuxAudioManager(const AudioConfig& config)
         : AudioManager(config) {
     }
-    
+
     ~LinuxAudioManager() override {
         stopRecording();
+        shutdownPlayback();
+        shutdownContext();
     }
-    
+
     bool startRecording(AudioSampleCallback callback) override {
         if (recording_) {
             return false;
         }
-        
+
+        if (!ensureContext()) {
+            return false;
+        }
+
         callback_ = std::move(callback);
-        
-        // TODO: Implement Linux audio recording with PulseAudio
+        prepareCaptureBuffer();
+
+        pa_sample_spec spec = sampleSpec(config_.format);
+        pa_buffer_attr attr = bufferAttributes(spec);
+
+        pa_threaded_mainloop_lock(mainloop_);
+
+        recordStream_ = pa_stream_new(context_, "Voice Assistant Capture", &spec, nullptr);
+        if (!recordStream_) {
+            std::cerr << "Failed to create PulseAudio record stream: " << contextError() << std::endl;
+            pa_threaded_mainloop_unlock(mainloop_);
+            return false;
+        }
+
+        pa_stream_set_state_callback(recordStream_, &LinuxAudioManager::onStreamState, this);
+        pa_stream_set_read_callback(recordStream_, &LinuxAudioManager::onStreamRead, this);
+
+        // ADJUST_LATENCY makes the server size the source buffer to our fragment,
+        // which is what allows fragments of 10 ms or less
+        if (pa_stream_connect_record(recordStream_, nullptr, &attr, PA_STREAM_ADJUST_LATENCY) < 0 ||
+            !waitForStreamReady(recordStream_)) {
+            std::cerr << "Failed to connect PulseAudio record stream: " << contextError() << std::endl;
+            releaseStream(recordStream_);
+            pa_threaded_mainloop_unlock(mainloop_);
+            return false;
+        }
+
+        pa_threaded_mainloop_unlock(mainloop_);
+
+        captureRunning_ = true;
+        captureThread_ = std::thread(&LinuxAudioManager::captureLoop, this);
+
         std::cout << "Linux audio recording started" << std::endl;
         recording_ = true;
-        
-        // This is just a placeholder implementation
-        
+
         return true;
     }
-    
+
     void stopRecording() override {
         if (!recording_) {
             return;
         }
-        
-        // TODO: Stop Linux audio recording
-        
+
+        // Disconnect first so the read callback stops producing
+        pa_threaded_mainloop_lock(mainloop_);
+        releaseStream(recordStream_);
+        pa_threaded_mainloop_unlock(mainloop_);
+
+        {
+            std::lock_guard<std::mutex> lock(captureMutex_);
+            captureRunning_ = false;
+        }
+        captureReady_.notify_one();
+        if (captureThread_.joinable()) {
+            captureThread_.join();
+        }
+
         std::cout << "Linux audio recording stopped" << std::endl;
         recording_ = false;
     }
-    
-    bool playAudio(const std::vector<int16_t>& audioData, const AudioFormat& format) override {
-        // TODO: Implement Linux audio playback with PulseAudio
-        std::cout << "Playing audio on Linux (simulated)" << std::endl;
-        return true;
-    }
-    
+
     bool speak(const std::string& text, const std::string& voice) override {
         // TODO: Implement Linux text-to-speech using Speech-Dispatcher or espeak
         std::cout << "Speaking on Linux (simulated): " << text << std::endl;
         return true;
     }
-    
+
+protected:
+    bool startPlaybackDevice(const AudioFormat& format) override {
+        if (!ensureContext()) {
+            return false;
+        }
+
+        pa_sample_spec spec = sampleSpec(format);
+        pa_buffer_attr attr = bufferAttributes(spec);
+        playbackFrameBytes_ = pa_frame_size(&spec);
+
+        pa_threaded_mainloop_lock(mainloop_);
+
+        playbackStream_ = pa_stream_new(context_, "Voice Assistant Playback", &spec, nullptr);
+        if (!playbackStream_) {
+            std::cerr << "Failed to create PulseAudio playback stream: " << contextError() << std::endl;
+            pa_threaded_mainloop_unlock(mainloop_);
+            return false;
+        }
+
+        // The stream stays connected and plays silence between clips; the
+        // write callback pulls whatever the playback queue holds
+        pa_stream_set_state_callback(playbackStream_, &LinuxAudioManager::onStreamState, this);
+        pa_stream_set_write_callback(playbackStream_, &LinuxAudioManager::onPlaybackWrite, this);
+
+        if (pa_stream_connect_playback(playbackStream_, nullptr, &attr, PA_STREAM_ADJUST_LATENCY, nullptr, nullptr) < 0 ||
+            !waitForStreamReady(playbackStream_)) {
+            std::cerr << "Failed to connect PulseAudio playback stream: " << contextError() << std::endl;
+            releaseStream(playbackStream_);
+            pa_threaded_mainloop_unlock(mainloop_);
+            return false;
+        }
+
+        pa_threaded_mainloop_unlock(mainloop_);
+        return true;
+    }
+
+    void stopPlaybackDevice() override {
+        if (!mainloop_) {
+            return;
+        }
+        pa_threaded_mainloop_lock(mainloop_);
+        releaseStream(playbackStream_);
+        pa_threaded_mainloop_unlock(mainloop_);
+    }
+
+    void onPlaybackFlushed() override {
+        if (!mainloop_) {
+            return;
+        }
+        // Also drop what the server has buffered, so output stops within one period
+        pa_threaded_mainloop_lock(mainloop_);
+        if (playbackStream_) {
+            pa_operation* operation = pa_stream_flush(playbackStream_, nullptr, nullptr);
+            if (operation) {
+                pa_operation_unref(operation);
+            }
+        }
+        pa_threaded_mainloop_unlock(mainloop_);
+    }
+
 private:
-    // Linux-specific members
+    pa_threaded_mainloop* mainloop_ = nullptr;
+    pa_context* context_ = nullptr;
+    pa_stream* recordStream_ = nullptr;
+    pa_stream* playbackStream_ = nullptr;
+    size_t playbackFrameBytes_ = sizeof(int16_t);
+
+    std::thread captureThread_;
+    std::atomic<bool> captureRunning_{false};
+    std::mutex captureMutex_;
+    std::condition_variable captureReady_;
+
+    static pa_sample_spec sampleSpec(const AudioFormat& format) {
+        pa_sample_spec spec;
+        spec.format = PA_SAMPLE_S16NE;
+        spec.rate = static_cast<uint32_t>(format.sampleRate);
+        spec.channels = static_cast<uint8_t>(format.channels);
+        return spec;
+    }
+
+    pa_buffer_attr bufferAttributes(const pa_sample_spec& spec) const {
+        const pa_usec_t latency = static_cast<pa_usec_t>(std::max(config_.bufferSizeMs, 1)) * PA_USEC_PER_MSEC;
+        const uint32_t bytes = static_cast<uint32_t>(pa_usec_to_bytes(latency, &spec));
+
+        pa_buffer_attr attr;
+        attr.maxlength = static_cast<uint32_t>(-1);
+        attr.tlength = bytes;
+        attr.prebuf = static_cast<uint32_t>(-1);
+        attr.minreq = static_cast<uint32_t>(-1);
+        attr.fragsize = bytes;
+        return attr;
+    }
+
+    std::string contextError() const {
+        return context_ ? pa_strerror(pa_context_errno(context_)) : "no context";
+    }
+
+    bool ensureContext() {
+        if (context_) {
+            return true;
+        }
+
+        mainloop_ = pa_threaded_mainloop_new();
+        if (!mainloop_) {
+            std::cerr << "Failed to create PulseAudio mainloop" << std::endl;
+            return false;
+        }
+
+        context_ = pa_context_new(pa_threaded_mainloop_get_api(mainloop_), "Voice Assistant");
+        if (!context_) {
+            std::cerr << "Failed to create PulseAudio context" << std::endl;
+            shutdownContext();
+            return false;
+        }
+
+        pa_context_set_state_callback(context_, &LinuxAudioManager::onContextState, this);
+
+        pa_threaded_mainloop_lock(mainloop_);
+        bool connected = pa_context_connect(context_, nullptr, PA_CONTEXT_NOFLAGS, nullptr) >= 0 &&
+                         pa_threaded_mainloop_start(mainloop_) >= 0;
+
+        while (connected) {
+            pa_context_state_t state = pa_context_get_state(context_);
+            if (state == PA_CONTEXT_READY) {
+                break;
+            }
+            if (!PA_CONTEXT_IS_GOOD(state)) {
+                connected = false;
+                break;
+            }
+            pa_threaded_mainloop_wait(mainloop_);
+        }
+        pa_threaded_mainloop_unlock(mainloop_);
+
+        if (!connected) {
+            std::cerr << "Failed to connect to PulseAudio: " << contextError() << std::endl;
+            shutdownContext();
+            return false;
+        }
+
+        return true;
+    }
+
+    void shutdownContext() {
+        if (!mainloop_) {
+            return;
+        }
+
+        pa_threaded_mainloop_lock(mainloop_);
+        if (context_) {
+            pa_context_disconnect(context_);
+            pa_context_unref(context_);
+            context_ = nullptr;
+        }
+        pa_threaded_mainloop_unlock(mainloop_);
+
+        pa_threaded_mainloop_stop(mainloop_);
+        pa_threaded_mainloop_free(mainloop_);
+        mainloop_ = nullptr;
+    }
+
+    // Must be called with the mainloop lock held
+    bool waitForStreamReady(pa_stream* stream) {
+        while (true) {
+            pa_stream_state_t state = pa_stream_get_state(stream);
+            if (state == PA_STREAM_READY) {
+                return true;
+            }
+            if (!PA_STREAM_IS_GOOD(state)) {
+                return false;
+            }
+            pa_threaded_mainloop_wait(mainloop_);
+        }
+    }
+
+    // Must be called with the mainloop lock held
+    void releaseStream(pa_stream*& stream) {
+        if (!stream) {
+            return;
+        }
+        pa_stream_set_state_callback(stream, nullptr, nullptr);
+        pa_stream_set_read_callback(stream, nullptr, nullptr);
+        pa_stream_set_write_callback(stream, nullptr, nullptr);
+        pa_stream_disconnect(stream);
+        pa_stream_unref(stream);
+        stream = nullptr;
+    }
+
+    void captureLoop() {
+        // Allow one period of scheduling jitter before calling it an underrun
+        const auto deadline = std::chrono::milliseconds(2 * std::max(config_.bufferSizeMs, 1));
+
+        while (captureRunning_) {
+            bool ready;
+            {
+                std::unique_lock<std::mutex> lock(captureMutex_);
+                ready = captureReady_.wait_for(lock, deadline, [this]() {
+                    return !captureRunning_ || hasCaptureFrame();
+                });
+            }
+
+            if (!captureRunning_) {
+                break;
+            }
+            if (!ready) {
+                deliverCaptureFrame();
+                continue;
+            }
+            while (hasCaptureFrame()) {
+                deliverCaptureFrame();
+            }
+        }
+
+        // Flush the tail of the recording
+        while (hasCaptureFrame()) {
+            deliverCaptureFrame();
+        }
+        deliverCaptureFrame(true);
+    }
+
+    static void onContextState(pa_context*, void* userdata) {
+        auto* self = static_cast<LinuxAudioManager*>(userdata);
+        pa_threaded_mainloop_signal(self->mainloop_, 0);
+    }
+
+    static void onStreamState(pa_stream*, void* userdata) {
+        auto* self = static_cast<LinuxAudioManager*>(userdata);
+        pa_threaded_mainloop_signal(self->mainloop_, 0);
+    }
+
+    // Runs on the PulseAudio mainloop thread; renders straight into the server's buffer
+    static void onPlaybackWrite(pa_stream* stream, size_t bytes, void* userdata) {
+        auto* self = static_cast<LinuxAudioManager*>(userdata);
+
+        while (bytes >= self->playbackFrameBytes_) {
+            void* buffer = nullptr;
+            size_t length = bytes;
+            if (pa_stream_begin_write(stream, &buffer, &length) < 0 || !buffer) {
+                break;
+            }
+            length = std::min(length, bytes) / self->playbackFrameBytes_ * self->playbackFrameBytes_;
+            if (length == 0) {
+                pa_stream_cancel_write(stream);
+                break;
+            }
+
+            self->renderPlayback(static_cast<int16_t*>(buffer), length / sizeof(int16_t));
+            if (pa_stream_write(stream, buffer, length, nullptr, 0, PA_SEEK_RELATIVE) < 0) {
+                break;
+            }
+            bytes -= length;
+        }
+    }
+
+    // Runs on the PulseAudio mainloop thread; must never wait on the consumer
+    static void onStreamRead(pa_stream* stream, size_t, void* userdata) {
+        auto* self = static_cast<LinuxAudioManager*>(userdata);
+
+        while (pa_stream_readable_size(stream) > 0) {
+            const void* data = nullptr;
+            size_t length = 0;
+            if (pa_stream_peek(stream, &data, &length) < 0 || length == 0) {
+                break;
+            }
+            // A null pointer with a non-zero length is a hole in the stream;
+            // it is filled with silence so the echo canceller's pairing of
+            // capture and far-end audio does not slip
+            if (data) {
+                self->pushCaptureSamples(static_cast<const int16_t*>(data), length / sizeof(int16_t));
+            } else {
+                self->pushCaptureSilence(length / sizeof(int16_t));
+            }
+            pa_stream_drop(stream);
+        }
+
+        // Taking the lock orders the push before a consumer that has just
+        // checked for a frame goes to sleep, so the wakeup is not lost. The
+        // consumer holds it only to check, so this never waits on its work.
+        {
+            std::lock_guard<std::mutex> lock(self->captureMutex_);
+        }
+        self->captureReady_.notify_one();
+    }
 };
 
 #endif
 
 std::unique_ptr<AudioManager> createAudioManager(const AudioConfig& config) {
+    if (config.backend == AudioBackend::FILE) {
+        return std::make_unique<FileAudioManager>(config);
+    }
+    
 #ifdef _WIN32
     return std::make_unique<WindowsAudioManager>(config);
 #elif __APPLE__
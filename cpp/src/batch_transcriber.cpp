@@ -0,0 +1,203 @@
+#include "batch_transcriber.h"
+#include "file_audio_manager.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace voice_assist {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool isAudioFile(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav" || extension == ".raw" || extension == ".pcm";
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+BatchTranscriber::BatchTranscriber(const BatchConfig& config)
+    : config_(config) {
+    // Files are read as fast as the recognizer takes them; there is no
+    // playback to cancel and nobody who could start a turn late
+    config_.audio.backend = AudioBackend::FILE;
+    config_.audio.outputFile.clear();
+    config_.audio.fileRealTime = false;
+    config_.audio.echoCancellation = false;
+    config_.audio.preRollMs = 0;
+    // One engine per worker; a standby for each would double the cost
+    config_.recognizer.recoverFailures = false;
+    config_.features.sampleRate = config_.audio.format.sampleRate;
+}
+
+std::vector<std::string> BatchTranscriber::collectInputs(const std::string& path) {
+    std::vector<std::string> files;
+    std::error_code error;
+
+    if (fs::is_directory(path, error)) {
+        for (fs::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file(error) && isAudioFile(it->path())) {
+                files.push_back(it->path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::ifstream manifest(path);
+    if (!manifest) {
+        return files;
+    }
+    const fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        // Tolerate CRLF manifests and surrounding whitespace
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        const size_t last = line.find_last_not_of(" \t\r");
+        const fs::path entry = line.substr(first, last - first + 1);
+        files.push_back(entry.is_absolute() ? entry.string() : (base / entry).string());
+    }
+    return files;
+}
+
+size_t BatchTranscriber::run(const std::vector<std::string>& files, const ResultCallback& onResult) {
+    size_t workers = config_.workers > 0 ? static_cast<size_t>(config_.workers)
+                                         : std::max(std::thread::hardware_concurrency(), 1u);
+    workers = std::min(workers, files.size());
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> succeeded{0};
+    std::mutex resultMutex;
+
+    auto worker = [&]() {
+        std::unique_ptr<VoiceRecognizer> recognizer = createVoiceRecognizer(config_.recognizer);
+        std::unique_ptr<FeatureFrontend> frontend;
+        if (config_.audio.format.channels == 1) {
+            frontend = std::make_unique<FeatureFrontend>(config_.features);
+        }
+
+        for (size_t index = next++; index < files.size(); index = next++) {
+            BatchResult result;
+            if (recognizer && recognizer->acceptsPushedAudio()) {
+                result = transcribeFile(files[index], *recognizer, frontend.get());
+            } else {
+                result.file = files[index];
+                result.error = recognizer ? "Voice recognizer cannot transcribe recorded audio"
+                                          : "Failed to create voice recognizer";
+            }
+            if (result.ok) {
+                ++succeeded;
+            }
+            if (onResult) {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                onResult(result);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        pool.emplace_back(worker);
+    }
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return succeeded;
+}
+
+std::string BatchTranscriber::toJsonLine(const BatchResult& result) {
+    nlohmann::json line = {
+        {"file", result.file},
+        {"text", result.text},
+        {"audio_ms", result.audioMs},
+        {"elapsed_ms", result.elapsedMs},
+        {"real_time_factor", result.audioMs > 0.0 ? result.elapsedMs / result.audioMs : 0.0}
+    };
+    if (!result.ok) {
+        line["error"] = result.error;
+    }
+    // Recordings named in other encodings must not abort the whole run
+    return line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+BatchResult BatchTranscriber::transcribeFile(const std::string& path, VoiceRecognizer& recognizer,
+                                             FeatureFrontend* frontend) {
+    BatchResult result;
+    result.file = path;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Final results may arrive on an engine thread
+    std::mutex textMutex;
+    std::string text;
+    if (!recognizer.startListening([&](const std::string& transcript, bool isFinal) {
+        if (!isFinal || transcript.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(textMutex);
+        text += text.empty() ? transcript : " " + transcript;
+    })) {
+        result.error = "Failed to start voice recognition";
+        result.elapsedMs = millisecondsSince(start);
+        return result;
+    }
+
+    AudioConfig fileConfig = config_.audio;
+    fileConfig.inputFile = path;
+    FileAudioManager reader(fileConfig);
+    if (frontend) {
+        frontend->reset();
+    }
+
+    size_t samples = 0;
+    const bool opened = reader.startRecording([&](AudioSampleView audioData, bool) {
+        samples += audioData.size;
+        recognizer.processAudio(audioData);
+        if (frontend) {
+            const uint64_t firstFrame = frontend->features().frameCount();
+            const size_t frames = frontend->process(audioData);
+            if (frames > 0) {
+                recognizer.processFeatures(frontend->features(), firstFrame, frames);
+            }
+        }
+    });
+    if (opened) {
+        reader.waitForInputEnd();
+        reader.stopRecording();
+        recognizer.finalizeUtterance();
+    }
+    // Engines deliver outstanding final results before stopListening() returns
+    recognizer.stopListening();
+
+    const AudioFormat& format = fileConfig.format;
+    result.audioMs = 1000.0 * samples / (static_cast<double>(format.sampleRate) * format.channels);
+    result.elapsedMs = millisecondsSince(start);
+    if (!opened) {
+        result.error = "Cannot read audio file";
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(textMutex);
+    result.text = std::move(text);
+    result.ok = true;
+    return result;
+}
+
+} // namespace voice_assist
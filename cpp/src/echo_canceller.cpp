@@ -0,0 +1,199 @@
+#include "echo_canceller.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace voice_assist {
+
+namespace {
+
+// Samples converted to float per pass through process()
+constexpr size_t kChunkSamples = 256;
+// NLMS step size; 0.5 trades some steady-state misadjustment for fast convergence
+constexpr float kStepSize = 0.5f;
+// Regularizes the step when the far end is quiet, per tap (about -50 dBFS)
+constexpr float kRegularization = 1e-5f;
+// Far-end samples below this are treated as silence
+constexpr float kSilenceLevel = 1.0f / 32768.0f;
+// Samples over which the two filters' residuals are compared
+constexpr size_t kCompareBlockSamples = 256;
+// Adaptation errors beyond this many typical errors are clipped, so bursts
+// of near-end speech nudge the weights rather than throwing them off
+constexpr float kErrorClip = 1.5f;
+constexpr float kErrorScaleRise = 0.0005f;
+constexpr float kErrorScaleFall = 0.005f;
+constexpr float kInitialErrorScale = 0.05f;
+// A block is double talk when the input exceeds twice the echo expected from
+// the far-end power and the learned coupling. Until the foreground filter
+// removes at least 10 dB of the input, +6 dB coupling is assumed, so loud
+// echo paths still adapt; a filter that is still converging predicts only
+// part of the echo and would make the coupling look low enough to flag
+// every later block
+constexpr float kDoubleTalkRatio = 2.0f;
+constexpr float kInitialCoupling = 4.0f;
+constexpr float kCouplingSmoothing = 0.1f;
+constexpr float kCouplingErle = 0.1f;
+// Background weights are adopted when their residual beats the foreground by
+// ~1 dB and removes at least 3 dB of the input, and discarded once they are
+// 3 dB worse than both the foreground and the input
+constexpr float kAdoptRatio = 0.8f;
+constexpr float kMinErle = 0.5f;
+constexpr float kDivergeRatio = 2.0f;
+
+} // namespace
+
+EchoCanceller::EchoCanceller(int sampleRate, int tailMs, int queueMs)
+    : taps_(std::max<size_t>(static_cast<size_t>(sampleRate) * std::max(tailMs, 1) / 1000, 16)),
+      farEndQueue_(static_cast<size_t>(sampleRate) * std::max(queueMs, tailMs) / 1000) {
+    foreground_.resize(taps_);
+    background_.resize(taps_);
+    history_.resize(2 * taps_);
+    farScratch_.resize(kChunkSamples);
+    nearScratch_.resize(kChunkSamples);
+    farFloat_.resize(kChunkSamples);
+
+    reset();
+}
+
+size_t EchoCanceller::pushFarEnd(const int16_t* samples, size_t count) {
+    return farEndQueue_.write(samples, count);
+}
+
+void EchoCanceller::process(const int16_t* in, int16_t* out, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        const size_t chunk = std::min(count - done, kChunkSamples);
+        processChunk(in + done, out + done, chunk);
+        done += chunk;
+    }
+}
+
+void EchoCanceller::reset() {
+    farEndQueue_.clear();
+    foreground_.clear();
+    background_.clear();
+    history_.clear();
+    position_ = 0;
+    silentSamples_ = taps_;
+    farEnergy_ = 0.0f;
+    errorScale_ = kInitialErrorScale;
+    coupling_ = kInitialCoupling;
+    blockFill_ = 0;
+    farPower_ = 0.0f;
+    echoPower_ = 0.0f;
+    nearPower_ = 0.0f;
+    foregroundPower_ = 0.0f;
+    backgroundPower_ = 0.0f;
+}
+
+size_t EchoCanceller::tailSamples() const {
+    return taps_;
+}
+
+void EchoCanceller::processChunk(const int16_t* in, int16_t* out, size_t count) {
+    // Pair each near-end sample with the next queued far-end sample; silence
+    // stands in when playback has nothing queued
+    int16_t* farSamples = farScratch_.data();
+    const size_t queued = farEndQueue_.read(farSamples, count);
+    std::fill(farSamples + queued, farSamples + count, int16_t(0));
+
+    if (queued == 0 && silentSamples_ >= taps_) {
+        // Nothing in the filter window, so there is no echo to predict
+        if (in != out) {
+            std::copy(in, in + count, out);
+        }
+        return;
+    }
+
+    float* farFloat = farFloat_.data();
+    float* nearFloat = nearScratch_.data();
+    kernels::int16ToFloat(farSamples, farFloat, count);
+    kernels::int16ToFloat(in, nearFloat, count);
+
+    float* foreground = foreground_.data();
+    float* background = background_.data();
+    for (size_t n = 0; n < count; ++n) {
+        pushHistory(farFloat[n]);
+
+        const float nearSample = nearFloat[n];
+        if (silentSamples_ >= taps_) {
+            continue;
+        }
+
+        // The background filter adapts; the foreground filter produces the
+        // output and only takes over background weights once they have proven
+        // better, so near-end speech cannot corrupt the output path
+        const float* window = history_.data() + position_;
+        const float foregroundError = nearSample - kernels::dotProduct(foreground, window, taps_);
+        const float backgroundError = nearSample - kernels::dotProduct(background, window, taps_);
+        nearFloat[n] = foregroundError;
+
+        const float magnitude = std::fabs(backgroundError);
+        const float limit = kErrorClip * errorScale_;
+        const float clipped = magnitude > limit ? std::copysign(limit, backgroundError) : backgroundError;
+        errorScale_ += (magnitude > errorScale_ ? kErrorScaleRise : kErrorScaleFall) * (magnitude - errorScale_);
+
+        const float step = kStepSize * clipped / (farEnergy_ + kRegularization * taps_);
+        kernels::multiplyAdd(background, window, step, taps_);
+
+        const float echo = nearSample - foregroundError;
+        farPower_ += farFloat[n] * farFloat[n];
+        echoPower_ += echo * echo;
+        nearPower_ += nearSample * nearSample;
+        foregroundPower_ += foregroundError * foregroundError;
+        backgroundPower_ += backgroundError * backgroundError;
+        if (++blockFill_ == kCompareBlockSamples) {
+            compareFilters();
+        }
+    }
+
+    kernels::floatToInt16(nearFloat, out, count);
+}
+
+void EchoCanceller::pushHistory(float sample) {
+    float* history = history_.data();
+
+    // Step back one slot; the slot being overwritten holds the sample leaving the window
+    position_ = position_ == 0 ? taps_ - 1 : position_ - 1;
+    const float leaving = history[position_];
+    history[position_] = sample;
+    history[position_ + taps_] = sample;
+
+    if (position_ == 0) {
+        // Resum once per pass to stop the running energy from drifting
+        farEnergy_ = kernels::dotProduct(history, history, taps_);
+    } else {
+        farEnergy_ = std::max(farEnergy_ + sample * sample - leaving * leaving, 0.0f);
+    }
+
+    silentSamples_ = std::fabs(sample) < kSilenceLevel ? silentSamples_ + 1 : 0;
+}
+
+void EchoCanceller::compareFilters() {
+    const size_t bytes = taps_ * sizeof(float);
+    if (nearPower_ > kDoubleTalkRatio * coupling_ * farPower_) {
+        // Near-end speech; undo whatever the background learned from it
+        std::memcpy(background_.data(), foreground_.data(), bytes);
+    } else {
+        if (backgroundPower_ < kAdoptRatio * foregroundPower_ && backgroundPower_ < kMinErle * nearPower_) {
+            std::memcpy(foreground_.data(), background_.data(), bytes);
+        } else if (backgroundPower_ > kDivergeRatio * foregroundPower_ &&
+                   backgroundPower_ > kDivergeRatio * nearPower_) {
+            // Undetected near-end speech has pulled the background off the echo path
+            std::memcpy(background_.data(), foreground_.data(), bytes);
+        }
+        if (foregroundPower_ < kCouplingErle * nearPower_ && farPower_ > 0.0f) {
+            coupling_ += kCouplingSmoothing * (echoPower_ / farPower_ - coupling_);
+        }
+    }
+
+    blockFill_ = 0;
+    farPower_ = 0.0f;
+    echoPower_ = 0.0f;
+    nearPower_ = 0.0f;
+    foregroundPower_ = 0.0f;
+    backgroundPower_ = 0.0f;
+}
+
+} // namespace voice_assist
@@ -0,0 +1,238 @@
+#include "endpoint_router.h"
+#include <algorithm>
+#include <chrono>
+
+namespace voice_assist {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Weight of each new sample in the moving averages
+constexpr double kLatencyWeight = 0.2;
+constexpr double kErrorWeight = 0.1;
+// A fully failing endpoint looks this many times slower than it is, plus
+// this much. One that failed without ever answering is scored from the
+// slowest measured latency, or from kErrorCostMs when there is none, so
+// that it does not look fast.
+constexpr double kErrorPenalty = 4.0;
+constexpr double kErrorCostMs = 1000.0;
+// Recent latencies kept for the p95, and how many it needs to mean anything
+constexpr size_t kSampleWindow = 64;
+constexpr size_t kMinSamples = 10;
+// An endpoint not heard from for this long is tried again
+constexpr auto kStaleAfter = std::chrono::seconds(30);
+// Failures in a row before an endpoint cools down, and the cooldown bounds
+constexpr int kFailuresBeforeCooldown = 3;
+constexpr auto kFirstCooldown = std::chrono::seconds(1);
+constexpr auto kMaxCooldown = std::chrono::seconds(30);
+
+double percentile95(std::vector<double>& samples) {
+    const size_t rank = samples.size() * 95 / 100;
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return samples[rank];
+}
+
+} // namespace
+
+struct EndpointRouter::Endpoint {
+    explicit Endpoint(const std::string& url)
+        : baseUrl(url) {
+    }
+
+    const std::string baseUrl;
+    bool measured = false;
+    double latencyMs = 0.0;
+    double errorRate = 0.0;
+    bool reported = false;
+    Clock::time_point reportedAt;       // Last latency or result
+    std::vector<double> samples;        // Ring of recent latencies
+    size_t nextSample = 0;
+    int consecutiveFailures = 0;
+    Clock::duration cooldown{};
+    Clock::time_point retryAt;          // End of the cooldown, or of the probe that follows it
+    uint64_t attempts = 0;
+    uint64_t failures = 0;
+    uint64_t wins = 0;
+};
+
+EndpointRouter::EndpointRouter(const std::vector<std::string>& baseUrls) {
+    setEndpoints(baseUrls);
+}
+
+EndpointRouter::~EndpointRouter() = default;
+
+void EndpointRouter::setEndpoints(const std::vector<std::string>& baseUrls) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<EndpointPtr> endpoints;
+    endpoints.reserve(baseUrls.size());
+    for (const std::string& url : baseUrls) {
+        auto known = std::find_if(endpoints_.begin(), endpoints_.end(),
+                                  [&url](const EndpointPtr& endpoint) { return endpoint->baseUrl == url; });
+        endpoints.push_back(known != endpoints_.end() ? *known : std::make_shared<Endpoint>(url));
+    }
+    endpoints_.swap(endpoints);
+}
+
+EndpointRouter::EndpointPtr EndpointRouter::choose(const EndpointPtr& exclude) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t count = endpoints_.size();
+    if (count == 0) {
+        return nullptr;
+    }
+    const Clock::time_point now = Clock::now();
+    const size_t first = next_++ % count;
+
+    double unmeasuredMs = 0.0;
+    for (const EndpointPtr& endpoint : endpoints_) {
+        if (endpoint->measured) {
+            unmeasuredMs = std::max(unmeasuredMs, endpoint->latencyMs);
+        }
+    }
+    if (unmeasuredMs == 0.0) {
+        unmeasuredMs = kErrorCostMs;
+    }
+
+    EndpointPtr best;
+    double bestScore = 0.0;
+    EndpointPtr soonest;  // Fallback when every endpoint is cooling down
+    for (size_t i = 0; i < count; ++i) {
+        const EndpointPtr& endpoint = endpoints_[(first + i) % count];
+        if (endpoint == exclude) {
+            continue;
+        }
+        if (!healthy(*endpoint)) {
+            if (!soonest || endpoint->retryAt < soonest->retryAt) {
+                soonest = endpoint;
+            }
+            continue;
+        }
+        // Unknown and stale endpoints go first, in turn
+        const bool known = endpoint->reported && now - endpoint->reportedAt < kStaleAfter;
+        const double latencyMs = endpoint->measured ? endpoint->latencyMs : unmeasuredMs;
+        const double score = known
+            ? latencyMs * (1.0 + kErrorPenalty * endpoint->errorRate) + kErrorCostMs * endpoint->errorRate
+            : -1.0;
+        if (!best || score < bestScore) {
+            best = endpoint;
+            bestScore = score;
+        }
+    }
+    // A hedge is only worth sending to a healthy endpoint
+    if (!best && !exclude) {
+        best = soonest;
+    }
+    if (best && best->consecutiveFailures >= kFailuresBeforeCooldown) {
+        // This request probes it; others wait for the outcome
+        best->retryAt = now + best->cooldown;
+    }
+    return best;
+}
+
+const std::string& EndpointRouter::baseUrl(const EndpointPtr& endpoint) {
+    return endpoint->baseUrl;
+}
+
+double EndpointRouter::hedgeDelayMs(const EndpointPtr& endpoint, double fallbackMs) {
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (endpoint->samples.size() < kMinSamples) {
+            return fallbackMs;
+        }
+        samples = endpoint->samples;
+    }
+    return percentile95(samples);
+}
+
+void EndpointRouter::reportLatency(const EndpointPtr& endpoint, double ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    addSample(*endpoint, ms);
+}
+
+void EndpointRouter::reportResult(const EndpointPtr& endpoint, bool failed, bool won) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++endpoint->attempts;
+    endpoint->reported = true;
+    endpoint->reportedAt = Clock::now();
+    endpoint->errorRate += kErrorWeight * ((failed ? 1.0 : 0.0) - endpoint->errorRate);
+    if (won) {
+        ++endpoint->wins;
+    }
+    if (!failed) {
+        endpoint->consecutiveFailures = 0;
+        endpoint->cooldown = Clock::duration::zero();
+        return;
+    }
+    ++endpoint->failures;
+    if (++endpoint->consecutiveFailures >= kFailuresBeforeCooldown) {
+        endpoint->cooldown = endpoint->cooldown == Clock::duration::zero()
+            ? Clock::duration(kFirstCooldown)
+            : std::min<Clock::duration>(endpoint->cooldown * 2, kMaxCooldown);
+        endpoint->retryAt = Clock::now() + endpoint->cooldown;
+    }
+}
+
+void EndpointRouter::reportLoss(const EndpointPtr& endpoint, double waitedMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++endpoint->attempts;
+    // Only a wait beyond the estimate says anything new
+    if (endpoint->measured && waitedMs > endpoint->latencyMs) {
+        addSample(*endpoint, waitedMs);
+    }
+}
+
+size_t EndpointRouter::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return endpoints_.size();
+}
+
+std::vector<EndpointStats> EndpointRouter::getStats() const {
+    std::vector<std::pair<EndpointStats, std::vector<double>>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const EndpointPtr& endpoint : endpoints_) {
+            EndpointStats stats;
+            stats.baseUrl = endpoint->baseUrl;
+            stats.latencyMs = endpoint->latencyMs;
+            stats.errorRate = endpoint->errorRate;
+            stats.attempts = endpoint->attempts;
+            stats.failures = endpoint->failures;
+            stats.wins = endpoint->wins;
+            stats.healthy = healthy(*endpoint);
+            snapshot.emplace_back(std::move(stats), endpoint->samples);
+        }
+    }
+
+    std::vector<EndpointStats> result;
+    result.reserve(snapshot.size());
+    for (auto& entry : snapshot) {
+        std::vector<double>& samples = entry.second;
+        if (samples.size() >= kMinSamples) {
+            entry.first.p95Ms = percentile95(samples);
+        }
+        result.push_back(std::move(entry.first));
+    }
+    return result;
+}
+
+void EndpointRouter::addSample(Endpoint& endpoint, double ms) {
+    // Called with mutex_ held
+    endpoint.latencyMs = endpoint.measured ? endpoint.latencyMs + kLatencyWeight * (ms - endpoint.latencyMs) : ms;
+    endpoint.measured = true;
+    endpoint.reported = true;
+    endpoint.reportedAt = Clock::now();
+    if (endpoint.samples.size() < kSampleWindow) {
+        endpoint.samples.push_back(ms);
+    } else {
+        endpoint.samples[endpoint.nextSample] = ms;
+        endpoint.nextSample = (endpoint.nextSample + 1) % kSampleWindow;
+    }
+}
+
+bool EndpointRouter::healthy(const Endpoint& endpoint) const {
+    // Called with mutex_ held
+    return endpoint.consecutiveFailures < kFailuresBeforeCooldown || Clock::now() >= endpoint.retryAt;
+}
+
+} // namespace voice_assist
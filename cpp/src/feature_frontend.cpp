@@ -0,0 +1,261 @@
+#include "feature_frontend.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace voice_assist {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr float kMinFrequency = 20.0f;
+constexpr float kMaxFrequency = 7600.0f;
+// Keeps log() finite on digital silence
+constexpr float kEnergyFloor = 1e-10f;
+constexpr float kSilenceDb = -96.0f;
+// Rows and DCT vectors are padded to whole cache lines
+constexpr size_t kFloatsPerLine = 64 / sizeof(float);
+
+size_t paddedSize(size_t count) {
+    return (count + kFloatsPerLine - 1) / kFloatsPerLine * kFloatsPerLine;
+}
+
+float hzToMel(float hz) {
+    return 2595.0f * std::log10(1.0f + hz / 700.0f);
+}
+
+float melToHz(float mel) {
+    return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+} // namespace
+
+FeatureMatrix::FeatureMatrix(size_t dimension, size_t capacity)
+    : dimension_(dimension),
+      stride_(paddedSize(dimension)),
+      capacity_(std::max<size_t>(capacity, 1)),
+      rows_(stride_ * capacity_),
+      levels_(capacity_, kSilenceDb) {
+}
+
+size_t FeatureMatrix::dimension() const {
+    return dimension_;
+}
+
+size_t FeatureMatrix::stride() const {
+    return stride_;
+}
+
+size_t FeatureMatrix::capacity() const {
+    return capacity_;
+}
+
+uint64_t FeatureMatrix::frameCount() const {
+    return frameCount_;
+}
+
+uint64_t FeatureMatrix::oldestFrame() const {
+    return frameCount_ > capacity_ ? frameCount_ - capacity_ : 0;
+}
+
+const float* FeatureMatrix::row(uint64_t frame) const {
+    return rows_.data() + (frame % capacity_) * stride_;
+}
+
+float FeatureMatrix::levelDb(uint64_t frame) const {
+    return levels_[frame % capacity_];
+}
+
+void FeatureMatrix::clear() {
+    frameCount_ = 0;
+    rows_.clear();
+    std::fill(levels_.begin(), levels_.end(), kSilenceDb);
+}
+
+float* FeatureMatrix::appendRow(float levelDb) {
+    const size_t slot = frameCount_ % capacity_;
+    levels_[slot] = levelDb;
+    ++frameCount_;
+    return rows_.data() + slot * stride_;
+}
+
+FeatureFrontend::FeatureFrontend(const FeatureConfig& config, size_t historyFrames)
+    : config_(config),
+      hop_(std::max<size_t>(static_cast<size_t>(std::max(config.sampleRate, 1)) / 100, 16)),
+      window_(std::max<size_t>(static_cast<size_t>(std::max(config.sampleRate, 1)) / 40, hop_)),
+      fft_(Fft::nextPowerOfTwo(window_)),
+      matrix_(std::max<size_t>(config.melBands, 1) + config.cepstra, historyFrames) {
+    config_.sampleRate = std::max(config_.sampleRate, 1);
+    config_.melBands = std::max<size_t>(config_.melBands, 1);
+    const int sampleRate = config_.sampleRate;
+    const size_t bands = config_.melBands;
+
+    hann_.resize(window_);
+    for (size_t i = 0; i < window_; ++i) {
+        hann_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / window_));
+    }
+
+    const size_t bins = fft_.bins();
+    history_.resize(window_);
+    frame_.resize(fft_.size());
+    real_.resize(bins);
+    imag_.resize(bins);
+    power_.resize(bins);
+    hopInput_.resize(hop_);
+
+    // Triangular filters with edges equally spaced on the mel scale
+    const float nyquist = 0.5f * sampleRate;
+    const float lowMel = hzToMel(kMinFrequency);
+    const float highMel = hzToMel(std::min(kMaxFrequency, nyquist));
+    const float binHz = static_cast<float>(sampleRate) / fft_.size();
+    std::vector<float> edges(bands + 2);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        edges[i] = melToHz(lowMel + (highMel - lowMel) * i / (bands + 1)) / binHz;
+    }
+
+    std::vector<float> weights;
+    melFirstBin_.resize(bands);
+    melBinCount_.resize(bands);
+    melOffset_.resize(bands);
+    for (size_t band = 0; band < bands; ++band) {
+        const float left = edges[band];
+        const float center = edges[band + 1];
+        const float right = edges[band + 2];
+        const size_t first = static_cast<size_t>(std::ceil(left));
+        const size_t last = std::min(static_cast<size_t>(std::floor(right)), bins - 1);
+
+        melFirstBin_[band] = static_cast<uint32_t>(first);
+        melOffset_[band] = static_cast<uint32_t>(weights.size());
+        for (size_t bin = first; bin <= last; ++bin) {
+            const float position = static_cast<float>(bin);
+            const float weight = position <= center
+                ? (position - left) / std::max(center - left, 1e-6f)
+                : (right - position) / std::max(right - center, 1e-6f);
+            weights.push_back(std::max(weight, 0.0f));
+        }
+        // Bands narrower than one bin still take the nearest one
+        if (weights.size() == melOffset_[band]) {
+            melFirstBin_[band] = static_cast<uint32_t>(std::min(static_cast<size_t>(std::lround(center)), bins - 1));
+            weights.push_back(1.0f);
+        }
+        melBinCount_[band] = static_cast<uint32_t>(weights.size() - melOffset_[band]);
+    }
+    melWeights_.resize(weights.size());
+    std::copy(weights.begin(), weights.end(), melWeights_.data());
+
+    // Orthonormal DCT-II rows, each padded so it starts on a cache line
+    bandStride_ = paddedSize(bands);
+    dct_.resize(config_.cepstra * bandStride_);
+    for (size_t k = 0; k < config_.cepstra; ++k) {
+        const double scale = std::sqrt((k == 0 ? 1.0 : 2.0) / bands);
+        for (size_t band = 0; band < bands; ++band) {
+            dct_[k * bandStride_ + band] = static_cast<float>(scale * std::cos(kPi * k * (band + 0.5) / bands));
+        }
+    }
+
+    reset();
+}
+
+const FeatureConfig& FeatureFrontend::getConfig() const {
+    return config_;
+}
+
+size_t FeatureFrontend::bands() const {
+    return config_.melBands;
+}
+
+size_t FeatureFrontend::dimension() const {
+    return matrix_.dimension();
+}
+
+size_t FeatureFrontend::hopSamples() const {
+    return hop_;
+}
+
+const FeatureMatrix& FeatureFrontend::features() const {
+    return matrix_;
+}
+
+size_t FeatureFrontend::process(AudioSampleView samples, const FrameCallback& onFrame) {
+    size_t frames = 0;
+    size_t done = 0;
+    while (done < samples.size) {
+        const size_t chunk = std::min(samples.size - done, hop_ - hopFill_);
+        std::memcpy(hopInput_.data() + hopFill_, samples.data + done, chunk * sizeof(int16_t));
+        hopFill_ += chunk;
+        done += chunk;
+
+        if (hopFill_ == hop_) {
+            const double meanSquare = static_cast<double>(kernels::sumSquares(hopInput_.data(), hop_)) / hop_;
+            const float levelDb = meanSquare > 0.0
+                ? static_cast<float>(10.0 * std::log10(meanSquare / (32768.0 * 32768.0)))
+                : kSilenceDb;
+            float* row = matrix_.appendRow(levelDb);
+            processHop(row);
+            hopFill_ = 0;
+            ++frames;
+            if (onFrame) {
+                onFrame(row);
+            }
+        }
+    }
+    return frames;
+}
+
+void FeatureFrontend::reset() {
+    hopFill_ = 0;
+    lastSample_ = 0.0f;
+    history_.clear();
+    matrix_.clear();
+}
+
+void FeatureFrontend::processHop(float* out) {
+    float* history = history_.data();
+    float* frame = frame_.data();
+    float* real = real_.data();
+    float* imag = imag_.data();
+    float* power = power_.data();
+    const float* window = hann_.data();
+    const size_t bins = fft_.bins();
+
+    std::memmove(history, history + hop_, (window_ - hop_) * sizeof(float));
+    float* incoming = history + window_ - hop_;
+    kernels::int16ToFloat(hopInput_.data(), incoming, hop_);
+    if (config_.preEmphasis != 0.0f) {
+        // Lifts the high bands that voiced speech leaves 20-30 dB down
+        float previous = lastSample_;
+        for (size_t i = 0; i < hop_; ++i) {
+            const float sample = incoming[i];
+            incoming[i] = sample - config_.preEmphasis * previous;
+            previous = sample;
+        }
+        lastSample_ = previous;
+    }
+
+    for (size_t i = 0; i < window_; ++i) {
+        frame[i] = history[i] * window[i];
+    }
+    std::fill(frame + window_, frame + fft_.size(), 0.0f);
+
+    fft_.forward(frame, real, imag);
+    for (size_t k = 0; k < bins; ++k) {
+        power[k] = real[k] * real[k] + imag[k] * imag[k];
+    }
+
+    const size_t bands = config_.melBands;
+    const float* weights = melWeights_.data();
+    for (size_t band = 0; band < bands; ++band) {
+        const float energy = kernels::dotProduct(power + melFirstBin_[band], weights + melOffset_[band],
+                                                 melBinCount_[band]);
+        out[band] = std::log(std::max(energy, kEnergyFloor));
+    }
+
+    float* cepstra = out + bands;
+    for (size_t k = 0; k < config_.cepstra; ++k) {
+        cepstra[k] = kernels::dotProduct(out, dct_.data() + k * bandStride_, bands);
+    }
+}
+
+} // namespace voice_assist
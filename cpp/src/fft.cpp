@@ -0,0 +1,150 @@
+#include "fft.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace voice_assist {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+} // namespace
+
+Fft::Fft(size_t size)
+    : size_(size), half_(size / 2) {
+    if (size < 4 || (size & (size - 1)) != 0) {
+        throw std::invalid_argument("FFT size must be a power of two of at least 4");
+    }
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < half_) {
+        ++bits;
+    }
+
+    bitReverse_.resize(half_);
+    for (size_t i = 0; i < half_; ++i) {
+        uint32_t reversed = 0;
+        for (size_t bit = 0; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1u) << (bits - 1 - bit);
+        }
+        bitReverse_[i] = reversed;
+    }
+
+    twiddleReal_.resize(half_ / 2);
+    twiddleImag_.resize(half_ / 2);
+    for (size_t k = 0; k < half_ / 2; ++k) {
+        const double angle = -2.0 * kPi * k / half_;
+        twiddleReal_[k] = static_cast<float>(std::cos(angle));
+        twiddleImag_[k] = static_cast<float>(std::sin(angle));
+    }
+
+    splitReal_.resize(half_ + 1);
+    splitImag_.resize(half_ + 1);
+    for (size_t k = 0; k <= half_; ++k) {
+        const double angle = -2.0 * kPi * k / size_;
+        splitReal_[k] = static_cast<float>(std::cos(angle));
+        splitImag_[k] = static_cast<float>(std::sin(angle));
+    }
+
+    workReal_.resize(half_);
+    workImag_.resize(half_);
+}
+
+size_t Fft::size() const {
+    return size_;
+}
+
+size_t Fft::bins() const {
+    return half_ + 1;
+}
+
+size_t Fft::nextPowerOfTwo(size_t minimum) {
+    size_t size = 1;
+    while (size < minimum) {
+        size <<= 1;
+    }
+    return size;
+}
+
+void Fft::forward(const float* input, float* real, float* imag) {
+    float* zr = workReal_.data();
+    float* zi = workImag_.data();
+
+    // Pack even/odd samples as one complex sequence of half the length
+    for (size_t k = 0; k < half_; ++k) {
+        const uint32_t target = bitReverse_[k];
+        zr[target] = input[2 * k];
+        zi[target] = input[2 * k + 1];
+    }
+
+    transform(zr, zi);
+
+    // Separate the even and odd spectra and combine them into the real spectrum
+    for (size_t k = 0; k <= half_; ++k) {
+        const size_t a = k % half_;
+        const size_t b = (half_ - k) % half_;
+        const float evenReal = 0.5f * (zr[a] + zr[b]);
+        const float evenImag = 0.5f * (zi[a] - zi[b]);
+        const float oddReal = 0.5f * (zi[a] + zi[b]);
+        const float oddImag = -0.5f * (zr[a] - zr[b]);
+
+        real[k] = evenReal + splitReal_[k] * oddReal - splitImag_[k] * oddImag;
+        imag[k] = evenImag + splitReal_[k] * oddImag + splitImag_[k] * oddReal;
+    }
+}
+
+void Fft::inverse(const float* real, const float* imag, float* output) {
+    float* zr = workReal_.data();
+    float* zi = workImag_.data();
+
+    // Rebuild the half-length complex spectrum, conjugated so the forward
+    // kernel computes the inverse
+    for (size_t k = 0; k < half_; ++k) {
+        const size_t m = half_ - k;
+        const float evenReal = 0.5f * (real[k] + real[m]);
+        const float evenImag = 0.5f * (imag[k] - imag[m]);
+        const float diffReal = 0.5f * (real[k] - real[m]);
+        const float diffImag = 0.5f * (imag[k] + imag[m]);
+        // odd = diff * conj(split twiddle)
+        const float oddReal = diffReal * splitReal_[k] + diffImag * splitImag_[k];
+        const float oddImag = diffImag * splitReal_[k] - diffReal * splitImag_[k];
+
+        const uint32_t target = bitReverse_[k];
+        zr[target] = evenReal - oddImag;
+        zi[target] = -(evenImag + oddReal);
+    }
+
+    transform(zr, zi);
+
+    const float scale = 1.0f / half_;
+    for (size_t k = 0; k < half_; ++k) {
+        output[2 * k] = zr[k] * scale;
+        output[2 * k + 1] = -zi[k] * scale;
+    }
+}
+
+void Fft::transform(float* real, float* imag) {
+    // Iterative radix-2 decimation in time; input is already bit-reversed
+    for (size_t length = 2; length <= half_; length <<= 1) {
+        const size_t halfLength = length / 2;
+        const size_t stride = half_ / length;
+
+        for (size_t start = 0; start < half_; start += length) {
+            for (size_t j = 0; j < halfLength; ++j) {
+                const float wr = twiddleReal_[j * stride];
+                const float wi = twiddleImag_[j * stride];
+                const size_t top = start + j;
+                const size_t bottom = top + halfLength;
+
+                const float tr = real[bottom] * wr - imag[bottom] * wi;
+                const float ti = real[bottom] * wi + imag[bottom] * wr;
+                real[bottom] = real[top] - tr;
+                imag[bottom] = imag[top] - ti;
+                real[top] += tr;
+                imag[top] += ti;
+            }
+        }
+    }
+}
+
+} // namespace voice_assist
@@ -0,0 +1,354 @@
+#include "file_audio_manager.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace voice_assist {
+
+namespace {
+
+constexpr size_t kWavHeaderSize = 44;
+
+uint16_t readLe16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t readLe32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+void writeLe16(uint8_t* data, uint16_t value) {
+    data[0] = static_cast<uint8_t>(value);
+    data[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLe32(uint8_t* data, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void writeWavHeader(uint8_t* header, const AudioFormat& format, size_t dataBytes) {
+    const uint16_t blockAlign = static_cast<uint16_t>(format.channels * format.bitsPerSample / 8);
+
+    std::memcpy(header, "RIFF", 4);
+    writeLe32(header + 4, static_cast<uint32_t>(36 + dataBytes));
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + 12, "fmt ", 4);
+    writeLe32(header + 16, 16);
+    writeLe16(header + 20, 1); // PCM
+    writeLe16(header + 22, static_cast<uint16_t>(format.channels));
+    writeLe32(header + 24, static_cast<uint32_t>(format.sampleRate));
+    writeLe32(header + 28, static_cast<uint32_t>(format.sampleRate) * blockAlign);
+    writeLe16(header + 32, blockAlign);
+    writeLe16(header + 34, static_cast<uint16_t>(format.bitsPerSample));
+    std::memcpy(header + 36, "data", 4);
+    writeLe32(header + 40, static_cast<uint32_t>(dataBytes));
+}
+
+/**
+ * @brief Locates the PCM payload of a RIFF/WAVE file
+ */
+bool parseWav(const uint8_t* data, size_t size, AudioFormat& format, size_t& dataOffset, size_t& dataBytes) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    bool haveFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* chunk = data + offset;
+        const size_t chunkSize = readLe32(chunk + 4);
+        const size_t body = offset + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && body + 16 <= size) {
+            const uint16_t encoding = readLe16(data + body);
+            format.channels = readLe16(data + body + 2);
+            format.sampleRate = static_cast<int>(readLe32(data + body + 4));
+            format.bitsPerSample = readLe16(data + body + 14);
+            // 1 = PCM, 0xFFFE = WAVE_FORMAT_EXTENSIBLE
+            if ((encoding != 1 && encoding != 0xFFFE) || format.bitsPerSample != 16 || format.channels == 0) {
+                std::cerr << "Unsupported WAV encoding; only 16-bit PCM is supported" << std::endl;
+                return false;
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                return false;
+            }
+            dataOffset = body;
+            // Streams that were never finalized often carry a bogus length
+            dataBytes = std::min(chunkSize, size - body);
+            return true;
+        }
+
+        // Chunks are padded to an even length
+        offset = body + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+} // namespace
+
+FileAudioManager::FileAudioManager(const AudioConfig& config)
+    : AudioManager(config) {
+}
+
+FileAudioManager::~FileAudioManager() {
+    stopRecording();
+    shutdownPlayback();
+    finalizeOutput();
+}
+
+bool FileAudioManager::startRecording(AudioSampleCallback callback) {
+    if (recording_) {
+        return false;
+    }
+
+    if (!openInput()) {
+        return false;
+    }
+
+    callback_ = std::move(callback);
+    prepareCaptureBuffer();
+
+    {
+        std::lock_guard<std::mutex> lock(streamMutex_);
+        inputFinished_ = false;
+        streaming_ = true;
+    }
+    streamThread_ = std::thread(&FileAudioManager::streamLoop, this);
+
+    recording_ = true;
+    return true;
+}
+
+void FileAudioManager::stopRecording() {
+    if (!recording_) {
+        return;
+    }
+
+    {
+        // Set under the lock, so a waiter cannot miss it between checking
+        // its predicate and going to sleep
+        std::lock_guard<std::mutex> lock(streamMutex_);
+        streaming_ = false;
+    }
+    streamCondition_.notify_all();
+    if (streamThread_.joinable()) {
+        streamThread_.join();
+    }
+
+    unalignedCopy_.clear();
+    inputConverter_.reset();
+    inputSamples_ = nullptr;
+    inputSampleCount_ = 0;
+    input_.close();
+
+    recording_ = false;
+}
+
+bool FileAudioManager::startPlaybackDevice(const AudioFormat& format) {
+    {
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        outputFormat_ = format;
+    }
+    return AudioManager::startPlaybackDevice(format);
+}
+
+void FileAudioManager::writePlaybackDevice(AudioSampleView samples) {
+    if (config_.outputFile.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    if (outputFailed_) {
+        return;
+    }
+    if (!output_.isOpen() && !openOutput(outputFormat_)) {
+        outputFailed_ = true;
+        return;
+    }
+
+    // The queue already converted every stream to the first one's format.
+    // A failed resize closes the file; what was written stays valid, as the
+    // header is updated with every write.
+    const size_t bytes = samples.size * sizeof(int16_t);
+    const size_t required = kWavHeaderSize + outputDataBytes_ + bytes;
+    if (required > output_.size() && !output_.resize(std::max(required, output_.size() * 2))) {
+        outputFailed_ = true;
+        return;
+    }
+    if (!output_.data()) {
+        return;
+    }
+
+    std::memcpy(output_.data() + kWavHeaderSize + outputDataBytes_, samples.data, bytes);
+    outputDataBytes_ += bytes;
+    writeWavHeader(output_.data(), outputFormat_, outputDataBytes_);
+}
+
+bool FileAudioManager::isPlaybackRealTime() const {
+    // Take as long as a real device would, in step with the input file
+    return config_.fileRealTime;
+}
+
+bool FileAudioManager::speak(const std::string& text, const std::string& voice) {
+    std::cout << "Speaking (file backend" << (voice.empty() ? "" : ", voice " + voice) << "): " << text << std::endl;
+    return true;
+}
+
+const AudioFormat& FileAudioManager::getInputFormat() const {
+    return inputFormat_;
+}
+
+bool FileAudioManager::isInputFinished() const {
+    return inputFinished_;
+}
+
+void FileAudioManager::waitForInputEnd() {
+    std::unique_lock<std::mutex> lock(streamMutex_);
+    streamCondition_.wait(lock, [this]() {
+        return inputFinished_ || !streaming_;
+    });
+}
+
+bool FileAudioManager::openInput() {
+    if (config_.inputFile.empty()) {
+        std::cerr << "No input file configured for the file audio backend" << std::endl;
+        return false;
+    }
+
+    if (!input_.open(config_.inputFile, MappedFile::Mode::READ_ONLY)) {
+        return false;
+    }
+
+    const uint8_t* data = input_.data();
+    size_t dataOffset = 0;
+    size_t dataBytes = input_.size();
+    inputFormat_ = config_.format;
+
+    if (data && !parseWav(data, input_.size(), inputFormat_, dataOffset, dataBytes)) {
+        if (input_.size() >= 4 && std::memcmp(data, "RIFF", 4) == 0) {
+            std::cerr << "Invalid WAV file: " << config_.inputFile << std::endl;
+            input_.close();
+            return false;
+        }
+        // Anything that is not RIFF is treated as raw PCM in the configured format
+        inputFormat_ = config_.format;
+        dataOffset = 0;
+        dataBytes = input_.size();
+    }
+
+    inputConverter_.reset();
+    if (inputFormat_.sampleRate <= 0 || inputFormat_.channels <= 0) {
+        std::cerr << "Invalid input format in " << config_.inputFile << std::endl;
+        input_.close();
+        return false;
+    }
+    if (inputFormat_.sampleRate != config_.format.sampleRate ||
+        inputFormat_.channels != config_.format.channels) {
+        inputConverter_ = std::make_unique<FormatConverter>(inputFormat_, config_.format);
+    }
+
+    inputSampleCount_ = dataBytes / sizeof(int16_t);
+    const uint8_t* samples = data ? data + dataOffset : nullptr;
+    if (reinterpret_cast<uintptr_t>(samples) % alignof(int16_t) != 0) {
+        // Odd chunk layouts leave the payload misaligned; copy once up front
+        unalignedCopy_.resize(inputSampleCount_);
+        std::memcpy(unalignedCopy_.data(), samples, inputSampleCount_ * sizeof(int16_t));
+        inputSamples_ = unalignedCopy_.data();
+    } else {
+        inputSamples_ = reinterpret_cast<const int16_t*>(samples);
+    }
+
+    return true;
+}
+
+size_t FileAudioManager::captureChunkSamples() const {
+    // Called after openInput(); the converter may stretch a frame and add
+    // the resampler's tail to the last one
+    const size_t frameSamples = inputFrameSamples();
+    return inputConverter_ ? inputConverter_->maxOutputSamples(frameSamples) : frameSamples;
+}
+
+size_t FileAudioManager::inputFrameSamples() const {
+    // Frames are cut in the file's format; conversion may shift each by a sample
+    return std::max<size_t>(
+        static_cast<size_t>(inputFormat_.sampleRate) * inputFormat_.channels * config_.bufferSizeMs / 1000,
+        inputFormat_.channels);
+}
+
+void FileAudioManager::streamLoop() {
+    const size_t frameSamples = inputFrameSamples();
+    const size_t samplesPerSecond = static_cast<size_t>(inputFormat_.sampleRate) * inputFormat_.channels;
+    const auto start = std::chrono::steady_clock::now();
+    size_t position = 0;
+    bool finalDelivered = false;
+
+    while (streaming_ && position < inputSampleCount_) {
+        const size_t count = std::min(frameSamples, inputSampleCount_ - position);
+
+        if (config_.fileRealTime && samplesPerSecond > 0) {
+            // Release each frame once the time it would take to record it has passed
+            const auto due = start + std::chrono::microseconds(
+                static_cast<int64_t>((position + count) * 1000000 / samplesPerSecond));
+            std::unique_lock<std::mutex> lock(streamMutex_);
+            if (streamCondition_.wait_until(lock, due, [this]() { return !streaming_; })) {
+                break;
+            }
+        }
+
+        const bool last = position + count >= inputSampleCount_;
+        AudioSampleView samples(inputSamples_ + position, count);
+        if (inputConverter_) {
+            samples = inputConverter_->convert(samples, last);
+        }
+        // Without conversion the mapping is handed out directly; nothing is copied per frame
+        dispatchCaptureSamples(samples, last);
+        position += count;
+        finalDelivered = last;
+    }
+
+    if (!finalDelivered) {
+        dispatchCaptureSamples(AudioSampleView(), true);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(streamMutex_);
+        inputFinished_ = true;
+    }
+    streamCondition_.notify_all();
+}
+
+bool FileAudioManager::openOutput(const AudioFormat& format) {
+    outputFormat_ = format;
+    outputDataBytes_ = 0;
+
+    // Start with one second of audio and grow geometrically
+    const size_t initialBytes = kWavHeaderSize +
+        static_cast<size_t>(format.sampleRate) * format.channels * sizeof(int16_t);
+    if (!output_.open(config_.outputFile, MappedFile::Mode::CREATE, initialBytes)) {
+        return false;
+    }
+
+    writeWavHeader(output_.data(), outputFormat_, 0);
+    return true;
+}
+
+void FileAudioManager::finalizeOutput() {
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    if (!output_.isOpen()) {
+        return;
+    }
+
+    // Trim the preallocated tail so the file length matches the header
+    if (output_.resize(kWavHeaderSize + outputDataBytes_)) {
+        writeWavHeader(output_.data(), outputFormat_, outputDataBytes_);
+    }
+    output_.close();
+}
+
+} // namespace voice_assist
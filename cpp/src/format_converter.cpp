@@ -0,0 +1,115 @@
+#include "format_converter.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace voice_assist {
+
+namespace {
+
+// Input frames mixed per pass; bounds the scratch buffers
+constexpr size_t kChunkFrames = 1024;
+
+} // namespace
+
+FormatConverter::FormatConverter(const AudioFormat& from, const AudioFormat& to)
+    : from_(from), to_(to),
+      resampleChannels_(static_cast<size_t>(std::max(std::min(from.channels, to.channels), 1))) {
+    if (from.sampleRate <= 0 || to.sampleRate <= 0 || from.channels <= 0 || to.channels <= 0) {
+        throw std::invalid_argument("Audio formats must have positive rates and channel counts");
+    }
+
+    if (from_.sampleRate != to_.sampleRate) {
+        resampler_ = std::make_unique<Resampler>(from_.sampleRate, to_.sampleRate,
+                                                 static_cast<int>(resampleChannels_));
+    }
+    if (to_.channels < from_.channels) {
+        mixed_.resize(kChunkFrames * resampleChannels_);
+    }
+    if (resampler_ && to_.channels > from_.channels) {
+        resampled_.resize(resampler_->maxOutputFrames(kChunkFrames) * resampleChannels_);
+    }
+}
+
+bool FormatConverter::isPassthrough() const {
+    return from_.sampleRate == to_.sampleRate && from_.channels == to_.channels;
+}
+
+const AudioFormat& FormatConverter::inputFormat() const {
+    return from_;
+}
+
+const AudioFormat& FormatConverter::outputFormat() const {
+    return to_;
+}
+
+size_t FormatConverter::maxOutputSamples(size_t inputSamples) const {
+    const size_t frames = inputSamples / static_cast<size_t>(from_.channels);
+    if (isPassthrough()) {
+        return frames * static_cast<size_t>(from_.channels);
+    }
+    return (resampler_ ? resampler_->maxOutputFrames(frames) : frames) * static_cast<size_t>(to_.channels);
+}
+
+AudioSampleView FormatConverter::convert(AudioSampleView input, bool isFinal) {
+    const size_t inChannels = static_cast<size_t>(from_.channels);
+    const size_t outChannels = static_cast<size_t>(to_.channels);
+    const size_t frames = input.size / inChannels;
+
+    if (isPassthrough()) {
+        return AudioSampleView(input.data, frames * inChannels);
+    }
+
+    // Size the output once for the whole call, including what a flush can add
+    const size_t maxFrames = resampler_ ? resampler_->maxOutputFrames(frames) : frames;
+    if (output_.size() < maxFrames * outChannels) {
+        output_.resize(maxFrames * outChannels);
+    }
+
+    const bool downmix = outChannels < inChannels;
+    const bool upmix = outChannels > inChannels;
+    size_t produced = 0;
+
+    // Resamples (or copies) one chunk at resampleChannels_ and upmixes it into the output
+    auto emit = [&](const int16_t* samples, size_t chunkFrames, bool flush) {
+        int16_t* target = output_.data() + produced * outChannels;
+        int16_t* resampleTarget = upmix ? resampled_.data() : target;
+        size_t count = chunkFrames;
+
+        if (resampler_) {
+            count = flush ? resampler_->flush(resampleTarget) : resampler_->process(samples, chunkFrames, resampleTarget);
+            samples = resampleTarget;
+        }
+        if (upmix) {
+            kernels::mixChannels(samples, inChannels, target, outChannels, count);
+        } else if (samples != target) {
+            std::memcpy(target, samples, count * outChannels * sizeof(int16_t));
+        }
+        produced += count;
+    };
+
+    for (size_t done = 0; done < frames; done += kChunkFrames) {
+        const size_t chunk = std::min(frames - done, kChunkFrames);
+        const int16_t* samples = input.data + done * inChannels;
+        if (downmix) {
+            kernels::mixChannels(samples, inChannels, mixed_.data(), outChannels, chunk);
+            samples = mixed_.data();
+        }
+        emit(samples, chunk, false);
+    }
+
+    if (isFinal && resampler_) {
+        emit(nullptr, 0, true);
+    }
+
+    return AudioSampleView(output_.data(), produced * outChannels);
+}
+
+void FormatConverter::reset() {
+    if (resampler_) {
+        resampler_->reset();
+    }
+}
+
+} // namespace voice_assist
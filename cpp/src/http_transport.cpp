@@ -0,0 +1,301 @@
+#include "http_transport.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace voice_assist {
+
+namespace {
+
+// Handles kept for reuse; more than this many concurrent requests is unusual
+constexpr size_t kMaxIdleHandles = 16;
+// Bounds parallel connections per host when a server refuses HTTP/2
+constexpr long kMaxHostConnections = 8;
+
+} // namespace
+
+struct HttpTransport::Transfer {
+    RequestId id = 0;
+    HttpRequest request;
+    HttpResponse response;
+    CompletionCallback onComplete;
+    CURL* curl = nullptr;
+    curl_slist* headers = nullptr;
+    std::chrono::steady_clock::time_point submittedAt = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point sendAt = submittedAt;  // submittedAt plus the delay
+    bool started = false;  // The body began arriving
+
+    static size_t receive(char* data, size_t size, size_t count, void* userData) {
+        Transfer* transfer = static_cast<Transfer*>(userData);
+        const size_t bytes = size * count;
+        long status = 0;
+        if (transfer->request.onData || !transfer->started) {
+            curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &status);
+        }
+        const bool success = status >= 200 && status < 300;
+        if (!transfer->started) {
+            transfer->started = true;
+            if (success && transfer->request.onResponseStart) {
+                transfer->request.onResponseStart();
+            }
+        }
+        // Error bodies are collected for the error message instead
+        if (transfer->request.onData && success) {
+            return transfer->request.onData(data, bytes) ? bytes : 0;
+        }
+        transfer->response.body.append(data, bytes);
+        return bytes;
+    }
+
+    void complete() {
+        if (request.onData) {
+            request.onData(nullptr, 0);
+        }
+        response.totalMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - submittedAt).count();
+        onComplete(std::move(response));
+    }
+};
+
+HttpTransport& HttpTransport::instance() {
+    static HttpTransport* transport = new HttpTransport();
+    return *transport;
+}
+
+HttpTransport::HttpTransport() {
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        std::cerr << "Failed to initialize CURL" << std::endl;
+        return;
+    }
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, kMaxHostConnections);
+
+    // Only the I/O thread uses the share, so it needs no lock callbacks
+    share_ = curl_share_init();
+    if (share_) {
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    ioThread_ = std::thread(&HttpTransport::ioLoop, this);
+}
+
+HttpTransport::RequestId HttpTransport::submit(HttpRequest request, CompletionCallback onComplete) {
+    auto transfer = std::make_unique<Transfer>();
+    transfer->request = std::move(request);
+    transfer->onComplete = std::move(onComplete);
+
+    RequestId id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        transfer->id = id;
+        if (multi_) {
+            pending_.push_back(std::move(transfer));
+        }
+    }
+    if (transfer) {
+        transfer->response.error = "Failed to initialize CURL";
+        transfer->complete();
+        return id;
+    }
+    curl_multi_wakeup(multi_);
+    return id;
+}
+
+std::future<HttpResponse> HttpTransport::submit(HttpRequest request) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    std::future<HttpResponse> result = promise->get_future();
+    submit(std::move(request), [promise](HttpResponse response) {
+        promise->set_value(std::move(response));
+    });
+    return result;
+}
+
+void HttpTransport::cancel(RequestId id) {
+    if (!multi_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        canceled_.push_back(id);
+    }
+    curl_multi_wakeup(multi_);
+}
+
+HttpResponse HttpTransport::perform(HttpRequest request) {
+    return submit(std::move(request)).get();
+}
+
+void HttpTransport::ioLoop() {
+    std::vector<std::unique_ptr<Transfer>> starting;
+    std::vector<RequestId> canceling;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            starting.swap(pending_);
+            canceling.swap(canceled_);
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& transfer : starting) {
+            if (transfer->request.delayMs > 0) {
+                transfer->sendAt = transfer->submittedAt + std::chrono::milliseconds(transfer->request.delayMs);
+                delayed_.push_back(std::move(transfer));
+            } else {
+                start(std::move(transfer));
+            }
+        }
+        starting.clear();
+        for (size_t i = 0; i < delayed_.size();) {
+            if (delayed_[i]->sendAt <= now) {
+                std::unique_ptr<Transfer> transfer = std::move(delayed_[i]);
+                delayed_.erase(delayed_.begin() + static_cast<std::ptrdiff_t>(i));
+                start(std::move(transfer));
+            } else {
+                ++i;
+            }
+        }
+
+        // Requests are started before cancellations are handled, so one
+        // canceled right after submission is found here
+        for (RequestId id : canceling) {
+            std::unique_ptr<Transfer> transfer;
+            auto it = active_.find(id);
+            if (it != active_.end()) {
+                transfer = retire(it->second);
+            } else {
+                auto waiting = std::find_if(delayed_.begin(), delayed_.end(),
+                                            [id](const std::unique_ptr<Transfer>& delayed) { return delayed->id == id; });
+                if (waiting == delayed_.end()) {
+                    continue;
+                }
+                transfer = std::move(*waiting);
+                delayed_.erase(waiting);
+            }
+            transfer->response.error = "Request canceled";
+            transfer->complete();
+        }
+        canceling.clear();
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+
+        int queued = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi_, &queued)) {
+            if (message->msg == CURLMSG_DONE) {
+                finish(message->easy_handle, message->data.result);
+            }
+        }
+
+        // Sleeps until a socket is ready, a timeout or delayed request is
+        // due, or submit() wakes it
+        long timeoutMs = 1000;
+        for (const auto& transfer : delayed_) {
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                transfer->sendAt - std::chrono::steady_clock::now()).count();
+            timeoutMs = std::max(0L, std::min(timeoutMs, static_cast<long>(wait) + 1));
+        }
+        curl_multi_poll(multi_, nullptr, 0, static_cast<int>(timeoutMs), nullptr);
+    }
+}
+
+void HttpTransport::start(std::unique_ptr<Transfer> transfer) {
+    CURL* curl = nullptr;
+    if (!idleHandles_.empty()) {
+        curl = idleHandles_.back();
+        idleHandles_.pop_back();
+        // Clears the options but keeps the handle's buffers
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+    }
+    if (!curl) {
+        transfer->response.error = "Failed to initialize CURL";
+        transfer->complete();
+        return;
+    }
+
+    transfer->curl = curl;
+    const HttpRequest& request = transfer->request;
+    for (const std::string& header : request.headers) {
+        transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, request.timeoutSeconds);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &Transfer::receive);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    // Prefer HTTP/2 over TLS, and wait for a connection that is still being
+    // set up rather than opening a second one, so requests share it
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    // Keeps idle connections from being silently dropped by NAT between turns
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
+    if (share_) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+    if (curl_multi_add_handle(multi_, curl) != CURLM_OK) {
+        curl_slist_free_all(transfer->headers);
+        curl_easy_cleanup(curl);
+        transfer->response.error = "Failed to queue request";
+        transfer->complete();
+        return;
+    }
+    // Owned by the handle until retire()
+    active_.emplace(transfer->id, curl);
+    transfer.release();
+}
+
+void HttpTransport::finish(void* handle, int result) {
+    CURL* curl = handle;
+    const CURLcode code = static_cast<CURLcode>(result);
+    HttpResponse response;
+    if (code == CURLE_OK) {
+        response.ok = true;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+        long connects = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+        response.reusedConnection = connects == 0;
+    } else {
+        response.error = "CURL error: " + std::string(curl_easy_strerror(code));
+    }
+
+    std::unique_ptr<Transfer> transfer = retire(curl);
+    response.body = std::move(transfer->response.body);
+    transfer->response = std::move(response);
+    transfer->complete();
+}
+
+std::unique_ptr<HttpTransport::Transfer> HttpTransport::retire(void* handle) {
+    CURL* curl = handle;
+    Transfer* raw = nullptr;
+    curl_easy_getinfo(curl, CURLINFO_PRIVATE, &raw);
+    std::unique_ptr<Transfer> transfer(raw);
+    active_.erase(transfer->id);
+
+    // The connection stays in the multi handle's cache for the next request
+    curl_multi_remove_handle(multi_, curl);
+    curl_slist_free_all(transfer->headers);
+    transfer->headers = nullptr;
+    if (idleHandles_.size() < kMaxIdleHandles) {
+        idleHandles_.push_back(curl);
+    } else {
+        curl_easy_cleanup(curl);
+    }
+    return transfer;
+}
+
+} // namespace voice_assist
@@ -0,0 +1,512 @@
+#include "intent_matcher.h"
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+namespace voice_assist {
+
+namespace {
+
+// Commands are short; longer utterances go to the LLM without a search
+constexpr size_t kMaxTokens = 48;
+// Bounds the patterns one rule line may expand into
+constexpr size_t kMaxExpansions = 1024;
+
+/**
+ * @brief Splits text into lower-case words
+ *
+ * Apostrophes are dropped so "what's" and "whats" agree; any other
+ * punctuation separates words, so "twenty-five" is two.
+ */
+std::vector<std::string> tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string current;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c >= 0x80) {
+            current += static_cast<char>(std::tolower(c));
+        } else if (c != '\'') {
+            if (!current.empty()) {
+                tokens.push_back(std::move(current));
+                current.clear();
+            }
+        }
+    }
+    if (!current.empty()) {
+        tokens.push_back(std::move(current));
+    }
+    return tokens;
+}
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    const size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+enum class NumberWord {
+    NONE,
+    UNIT,
+    TEN,
+    HUNDRED,
+    THOUSAND,
+    AND,
+    A
+};
+
+NumberWord classifyNumberWord(const std::string& word, int& value) {
+    static const char* const units[] = {
+        "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine", "ten",
+        "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen"
+    };
+    static const char* const tens[] = {
+        "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"
+    };
+    for (int i = 0; i < 20; ++i) {
+        if (word == units[i]) {
+            value = i;
+            return NumberWord::UNIT;
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        if (word == tens[i]) {
+            value = (i + 2) * 10;
+            return NumberWord::TEN;
+        }
+    }
+    if (word == "hundred") {
+        return NumberWord::HUNDRED;
+    }
+    if (word == "thousand") {
+        return NumberWord::THOUSAND;
+    }
+    if (word == "and") {
+        return NumberWord::AND;
+    }
+    if (word == "a") {
+        return NumberWord::A;
+    }
+    return NumberWord::NONE;
+}
+
+bool isDigits(const std::string& word) {
+    return !word.empty() && word.size() <= 9 &&
+           std::all_of(word.begin(), word.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+/**
+ * @brief Reads tokens [begin, end) as one number, in digits or in words
+ */
+bool parseNumber(const std::vector<std::string>& tokens, size_t begin, size_t end, long& value) {
+    if (end - begin == 1 && isDigits(tokens[begin])) {
+        value = std::stol(tokens[begin]);
+        return true;
+    }
+
+    long total = 0;
+    long current = 0;
+    NumberWord last = NumberWord::NONE;
+    for (size_t i = begin; i < end; ++i) {
+        int wordValue = 0;
+        const NumberWord kind = classifyNumberWord(tokens[i], wordValue);
+        switch (kind) {
+            case NumberWord::UNIT:
+                // "twenty five" but not "five five" or "twenty fifteen"
+                if (last == NumberWord::UNIT || (last == NumberWord::TEN && wordValue >= 10) ||
+                    last == NumberWord::A) {
+                    return false;
+                }
+                current += wordValue;
+                break;
+            case NumberWord::TEN:
+                if (last == NumberWord::UNIT || last == NumberWord::TEN || last == NumberWord::A) {
+                    return false;
+                }
+                current += wordValue;
+                break;
+            case NumberWord::HUNDRED:
+                if (last != NumberWord::UNIT && last != NumberWord::A) {
+                    return false;
+                }
+                current = (last == NumberWord::A ? 1 : current) * 100;
+                break;
+            case NumberWord::THOUSAND:
+                if (total != 0 || last == NumberWord::NONE || last == NumberWord::AND) {
+                    return false;
+                }
+                total = (last == NumberWord::A ? 1 : current) * 1000;
+                current = 0;
+                break;
+            case NumberWord::AND:
+                if (last != NumberWord::HUNDRED && last != NumberWord::THOUSAND) {
+                    return false;
+                }
+                break;
+            case NumberWord::A:
+                if (last != NumberWord::NONE) {
+                    return false;
+                }
+                break;
+            case NumberWord::NONE:
+                return false;
+        }
+        last = kind;
+    }
+    if (last == NumberWord::NONE || last == NumberWord::AND || last == NumberWord::A) {
+        return false;
+    }
+    value = total + current;
+    return true;
+}
+
+bool isNumberToken(const std::string& word) {
+    int value = 0;
+    return isDigits(word) || classifyNumberWord(word, value) != NumberWord::NONE;
+}
+
+std::string formatNow(const char* format) {
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char buffer[64];
+    const size_t length = std::strftime(buffer, sizeof(buffer), format, &local);
+    return std::string(buffer, length);
+}
+
+} // namespace
+
+std::string IntentMatch::slot(const std::string& name) const {
+    for (const auto& entry : slots) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    return std::string();
+}
+
+IntentMatcher::IntentMatcher() {
+    nodes_.emplace_back();
+}
+
+bool IntentMatcher::loadRules(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open intent rules: " << path << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        const size_t colon = line.find(':');
+        std::string intent = colon == std::string::npos ? std::string() : trim(line.substr(0, colon));
+        if (intent.empty() || intent.find_first_of(" \t{([") != std::string::npos) {
+            std::cerr << path << ":" << lineNumber << ": expected 'intent: pattern'" << std::endl;
+            ok = false;
+            continue;
+        }
+
+        std::string pattern = line.substr(colon + 1);
+        std::string reply;
+        const size_t arrow = pattern.find("=>");
+        if (arrow != std::string::npos) {
+            reply = trim(pattern.substr(arrow + 2));
+            pattern = pattern.substr(0, arrow);
+        }
+        if (!addRule(intent, pattern, reply)) {
+            std::cerr << path << ":" << lineNumber << ": invalid pattern" << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool IntentMatcher::addRule(const std::string& intent, const std::string& pattern, const std::string& reply) {
+    // A pattern is a sequence of elements, each a set of alternative
+    // sequences; a word or a slot is an element with one alternative
+    struct Token {
+        bool isSlot;
+        SlotType type;
+        uint32_t id;
+    };
+    using Sequence = std::vector<Token>;
+    std::vector<std::vector<Sequence>> elements;
+
+    auto words = [this](const std::string& text) {
+        Sequence sequence;
+        for (const std::string& word : tokenize(text)) {
+            sequence.push_back({false, SlotType::WORD, internWord(word)});
+        }
+        return sequence;
+    };
+
+    for (size_t i = 0; i < pattern.size();) {
+        const char c = pattern[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (c == '{') {
+            const size_t close = pattern.find('}', i);
+            if (close == std::string::npos) {
+                return false;
+            }
+            std::string name = pattern.substr(i + 1, close - i - 1);
+            SlotType type = SlotType::WORD;
+            const size_t colon = name.find(':');
+            if (colon != std::string::npos) {
+                const std::string typeName = trim(name.substr(colon + 1));
+                if (typeName == "number") {
+                    type = SlotType::NUMBER;
+                } else if (typeName == "text") {
+                    type = SlotType::TEXT;
+                } else if (typeName != "word") {
+                    return false;
+                }
+                name = name.substr(0, colon);
+            }
+            name = trim(name);
+            if (name.empty()) {
+                return false;
+            }
+            elements.push_back({Sequence{{true, type, internSlot(name)}}});
+            i = close + 1;
+        } else if (c == '(' || c == '[') {
+            const size_t close = pattern.find(c == '(' ? ')' : ']', i);
+            if (close == std::string::npos) {
+                return false;
+            }
+            const std::string body = pattern.substr(i + 1, close - i - 1);
+            if (body.find_first_of("{}()[]") != std::string::npos) {
+                return false;
+            }
+            std::vector<Sequence> alternatives;
+            size_t start = 0;
+            while (true) {
+                const size_t bar = body.find('|', start);
+                alternatives.push_back(words(body.substr(start, bar - start)));
+                if (bar == std::string::npos) {
+                    break;
+                }
+                start = bar + 1;
+            }
+            if (c == '[') {
+                alternatives.push_back(Sequence());
+            }
+            elements.push_back(std::move(alternatives));
+            i = close + 1;
+        } else if (std::string("{}()[]|").find(c) != std::string::npos) {
+            return false;
+        } else {
+            const size_t end = pattern.find_first_of(" \t{}()[]|", i);
+            Sequence sequence = words(pattern.substr(i, end - i));
+            if (!sequence.empty()) {
+                elements.push_back({std::move(sequence)});
+            }
+            i = end == std::string::npos ? pattern.size() : end;
+        }
+    }
+
+    // Expand the alternatives and add every resulting sequence to the trie
+    size_t expansions = 1;
+    for (const auto& alternatives : elements) {
+        expansions *= alternatives.size();
+        if (expansions > kMaxExpansions) {
+            return false;
+        }
+    }
+
+    const int32_t ruleIndex = static_cast<int32_t>(rules_.size());
+    bool added = false;
+    std::vector<size_t> choice(elements.size(), 0);
+    for (size_t n = 0; n < expansions; ++n) {
+        uint32_t node = 0;
+        bool empty = true;
+        for (size_t e = 0; e < elements.size(); ++e) {
+            for (const Token& token : elements[e][choice[e]]) {
+                node = token.isSlot ? addSlotEdge(node, token.type, token.id) : addWordEdge(node, token.id);
+                empty = false;
+            }
+        }
+        // The first rule to reach a node keeps it
+        if (!empty && nodes_[node].rule < 0) {
+            nodes_[node].rule = ruleIndex;
+            added = true;
+        }
+
+        for (size_t e = elements.size(); e-- > 0;) {
+            if (++choice[e] < elements[e].size()) {
+                break;
+            }
+            choice[e] = 0;
+        }
+    }
+
+    if (!added) {
+        return false;
+    }
+    rules_.push_back({intent, reply});
+    return true;
+}
+
+size_t IntentMatcher::ruleCount() const {
+    return rules_.size();
+}
+
+bool IntentMatcher::match(const std::string& text, IntentMatch& match) const {
+    const std::vector<std::string> tokens = tokenize(text);
+    if (tokens.empty() || tokens.size() > kMaxTokens || rules_.empty()) {
+        return false;
+    }
+
+    // Words the rules never mention cannot match a literal edge
+    std::vector<uint32_t> ids(tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        auto it = vocabulary_.find(tokens[i]);
+        ids[i] = it == vocabulary_.end() ? UINT32_MAX : it->second;
+    }
+
+    std::vector<Capture> captures;
+    int32_t ruleIndex = -1;
+    if (!walk(0, 0, tokens, ids, captures, ruleIndex)) {
+        return false;
+    }
+
+    const Rule& rule = rules_[ruleIndex];
+    match.intent = rule.intent;
+    match.slots.clear();
+    for (const Capture& capture : captures) {
+        std::string value;
+        long number = 0;
+        if (capture.type == SlotType::NUMBER && parseNumber(tokens, capture.begin, capture.end, number)) {
+            value = std::to_string(number);
+        } else {
+            for (size_t i = capture.begin; i < capture.end; ++i) {
+                value += value.empty() ? tokens[i] : " " + tokens[i];
+            }
+        }
+        match.slots.emplace_back(slotNames_[capture.name], std::move(value));
+    }
+
+    match.reply.clear();
+    for (size_t i = 0; i < rule.reply.size();) {
+        const size_t close = rule.reply[i] == '{' ? rule.reply.find('}', i) : std::string::npos;
+        if (close == std::string::npos) {
+            match.reply += rule.reply[i++];
+            continue;
+        }
+        const std::string name = rule.reply.substr(i + 1, close - i - 1);
+        auto slot = std::find_if(match.slots.begin(), match.slots.end(),
+                                 [&name](const auto& entry) { return entry.first == name; });
+        if (slot != match.slots.end()) {
+            match.reply += slot->second;
+        } else if (name == "time") {
+            match.reply += formatNow("%H:%M");
+        } else if (name == "date") {
+            match.reply += formatNow("%A, %B %d");
+        } else {
+            match.reply += rule.reply.substr(i, close - i + 1);
+        }
+        i = close + 1;
+    }
+    return true;
+}
+
+uint32_t IntentMatcher::internWord(const std::string& word) {
+    auto it = vocabulary_.emplace(word, static_cast<uint32_t>(vocabulary_.size())).first;
+    return it->second;
+}
+
+uint32_t IntentMatcher::internSlot(const std::string& name) {
+    auto it = std::find(slotNames_.begin(), slotNames_.end(), name);
+    if (it != slotNames_.end()) {
+        return static_cast<uint32_t>(it - slotNames_.begin());
+    }
+    slotNames_.push_back(name);
+    return static_cast<uint32_t>(slotNames_.size() - 1);
+}
+
+uint32_t IntentMatcher::addWordEdge(uint32_t node, uint32_t word) {
+    auto& edges = nodes_[node].words;
+    auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(word, 0u));
+    if (it != edges.end() && it->first == word) {
+        return it->second;
+    }
+    const uint32_t child = static_cast<uint32_t>(nodes_.size());
+    edges.insert(it, std::make_pair(word, child));
+    // May reallocate nodes_, so edges is not used after this
+    nodes_.emplace_back();
+    return child;
+}
+
+uint32_t IntentMatcher::addSlotEdge(uint32_t node, SlotType type, uint32_t name) {
+    for (const SlotEdge& edge : nodes_[node].slots) {
+        if (edge.type == type && edge.name == name) {
+            return edge.child;
+        }
+    }
+    const uint32_t child = static_cast<uint32_t>(nodes_.size());
+    nodes_[node].slots.push_back({type, name, child});
+    nodes_.emplace_back();
+    return child;
+}
+
+bool IntentMatcher::walk(uint32_t node, size_t position, const std::vector<std::string>& tokens,
+                         const std::vector<uint32_t>& ids, std::vector<Capture>& captures, int32_t& rule) const {
+    const Node& current = nodes_[node];
+    if (position == tokens.size()) {
+        rule = current.rule;
+        return rule >= 0;
+    }
+
+    // Literal words first, so "stop" beats a rule that takes any one word
+    auto it = std::lower_bound(current.words.begin(), current.words.end(), std::make_pair(ids[position], 0u));
+    if (it != current.words.end() && it->first == ids[position] &&
+        walk(it->second, position + 1, tokens, ids, captures, rule)) {
+        return true;
+    }
+
+    for (const SlotEdge& edge : current.slots) {
+        size_t first = position + 1;
+        size_t last = position + 1;
+        if (edge.type == SlotType::NUMBER) {
+            // Longest number first: "twenty five" rather than "twenty"
+            while (last < tokens.size() && isNumberToken(tokens[last])) {
+                ++last;
+            }
+            if (!isNumberToken(tokens[position])) {
+                continue;
+            }
+        } else if (edge.type == SlotType::TEXT) {
+            last = tokens.size();
+        }
+
+        for (size_t k = 0; k <= last - first; ++k) {
+            // Numbers shrink from the longest span; text grows from the shortest
+            const size_t end = edge.type == SlotType::NUMBER ? last - k : first + k;
+            long number = 0;
+            if (edge.type == SlotType::NUMBER && !parseNumber(tokens, position, end, number)) {
+                continue;
+            }
+            captures.push_back({edge.name, edge.type, position, end});
+            if (walk(edge.child, end, tokens, ids, captures, rule)) {
+                return true;
+            }
+            captures.pop_back();
+        }
+    }
+    return false;
+}
+
+} // namespace voice_assist
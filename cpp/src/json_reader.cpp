@@ -0,0 +1,373 @@
+#include "json_reader.h"
+#include "json_writer.h"
+#include <cstring>
+
+namespace voice_assist {
+
+namespace {
+
+// Deeper documents are not worth skipping without a DOM
+constexpr int kMaxDepth = 256;
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xc0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xe0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+} // namespace
+
+JsonReader::JsonReader(const char* data, size_t size)
+    : position_(data), end_(data + size) {
+}
+
+JsonReader::Type JsonReader::peek() {
+    skipWhitespace();
+    if (failed_ || position_ == end_) {
+        return Type::INVALID;
+    }
+    switch (*position_) {
+        case '{': return Type::OBJECT;
+        case '[': return Type::ARRAY;
+        case '"': return Type::STRING;
+        case 't':
+        case 'f': return Type::BOOLEAN;
+        case 'n': return Type::NUL;
+        default:
+            return *position_ == '-' || isDigit(*position_) ? Type::NUMBER : Type::INVALID;
+    }
+}
+
+bool JsonReader::beginObject() {
+    if (!expect('{')) {
+        return false;
+    }
+    first_ = true;
+    return true;
+}
+
+bool JsonReader::nextKey(std::string& key) {
+    return nextMember(&key);
+}
+
+bool JsonReader::beginArray() {
+    if (!expect('[')) {
+        return false;
+    }
+    first_ = true;
+    return true;
+}
+
+bool JsonReader::nextElement() {
+    skipWhitespace();
+    if (position_ == end_) {
+        return fail();
+    }
+    if (*position_ == ']') {
+        ++position_;
+        first_ = false;
+        return false;
+    }
+    if (!first_ && !expect(',')) {
+        return false;
+    }
+    first_ = false;
+    return true;
+}
+
+bool JsonReader::readString(std::string& out) {
+    out.clear();
+    if (!expect('"')) {
+        return false;
+    }
+    while (true) {
+        const size_t run = findJsonEscape(position_, static_cast<size_t>(end_ - position_));
+        out.append(position_, run);
+        position_ += run;
+        if (position_ == end_) {
+            return fail();
+        }
+
+        const char c = *position_++;
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\' || position_ == end_) {
+            // Raw control characters are not allowed in strings
+            return fail();
+        }
+        switch (*position_++) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!readCodePoint(codePoint)) {
+                    return false;
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return fail();
+        }
+    }
+}
+
+bool JsonReader::readInteger(int64_t& value) {
+    skipWhitespace();
+    const char* start = position_;
+    const bool negative = position_ != end_ && *position_ == '-';
+    if (negative) {
+        ++position_;
+    }
+    uint64_t magnitude = 0;
+    int digits = 0;
+    for (; position_ != end_ && isDigit(*position_); ++position_, ++digits) {
+        magnitude = magnitude * 10 + static_cast<uint64_t>(*position_ - '0');
+    }
+    // Fractions, exponents and anything that might overflow are not integers here
+    if (digits == 0 || digits > 18 ||
+        (position_ != end_ && (*position_ == '.' || *position_ == 'e' || *position_ == 'E'))) {
+        position_ = start;
+        return fail();
+    }
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+bool JsonReader::skipValue() {
+    return skipValue(0);
+}
+
+bool JsonReader::atEnd() {
+    skipWhitespace();
+    return !failed_ && position_ == end_;
+}
+
+bool JsonReader::failed() const {
+    return failed_;
+}
+
+void JsonReader::skipWhitespace() {
+    while (position_ != end_ &&
+           (*position_ == ' ' || *position_ == '\n' || *position_ == '\r' || *position_ == '\t')) {
+        ++position_;
+    }
+}
+
+bool JsonReader::fail() {
+    failed_ = true;
+    return false;
+}
+
+bool JsonReader::expect(char c) {
+    skipWhitespace();
+    if (failed_ || position_ == end_ || *position_ != c) {
+        return fail();
+    }
+    ++position_;
+    return true;
+}
+
+bool JsonReader::nextMember(std::string* key) {
+    skipWhitespace();
+    if (position_ == end_) {
+        return fail();
+    }
+    if (*position_ == '}') {
+        ++position_;
+        // Back in the enclosing container, just after a value
+        first_ = false;
+        return false;
+    }
+    if (!first_ && !expect(',')) {
+        return false;
+    }
+    first_ = false;
+    if (!(key ? readString(*key) : skipString())) {
+        return false;
+    }
+    return expect(':');
+}
+
+bool JsonReader::readCodePoint(uint32_t& codePoint) {
+    auto readHex = [this](uint32_t& unit) {
+        if (end_ - position_ < 4) {
+            return false;
+        }
+        unit = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int digit = hexValue(position_[i]);
+            if (digit < 0) {
+                return false;
+            }
+            unit = (unit << 4) | static_cast<uint32_t>(digit);
+        }
+        position_ += 4;
+        return true;
+    };
+
+    if (!readHex(codePoint)) {
+        return fail();
+    }
+    if (codePoint >= 0xdc00 && codePoint <= 0xdfff) {
+        return fail();
+    }
+    if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+        // A high surrogate must be followed by an escaped low one
+        uint32_t low = 0;
+        if (end_ - position_ < 2 || position_[0] != '\\' || position_[1] != 'u') {
+            return fail();
+        }
+        position_ += 2;
+        if (!readHex(low) || low < 0xdc00 || low > 0xdfff) {
+            return fail();
+        }
+        codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+    }
+    return true;
+}
+
+bool JsonReader::skipValue(int depth) {
+    if (depth > kMaxDepth) {
+        return fail();
+    }
+    switch (peek()) {
+        case Type::OBJECT:
+            beginObject();
+            while (nextMember(nullptr)) {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            }
+            return !failed_;
+        case Type::ARRAY:
+            beginArray();
+            while (nextElement()) {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            }
+            return !failed_;
+        case Type::STRING:
+            return skipString();
+        case Type::NUMBER:
+            return skipNumber();
+        case Type::BOOLEAN:
+            return *position_ == 't' ? skipLiteral("true", 4) : skipLiteral("false", 5);
+        case Type::NUL:
+            return skipLiteral("null", 4);
+        case Type::INVALID:
+            break;
+    }
+    return fail();
+}
+
+bool JsonReader::skipString() {
+    // Escapes are checked but not decoded
+    if (!expect('"')) {
+        return false;
+    }
+    while (true) {
+        position_ += findJsonEscape(position_, static_cast<size_t>(end_ - position_));
+        if (position_ == end_) {
+            return fail();
+        }
+        const char c = *position_++;
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\' || position_ == end_) {
+            return fail();
+        }
+        const char escape = *position_++;
+        if (escape == 'u') {
+            uint32_t codePoint = 0;
+            if (!readCodePoint(codePoint)) {
+                return false;
+            }
+        } else if (!std::strchr("\"\\/bfnrt", escape) || escape == '\0') {
+            return fail();
+        }
+    }
+}
+
+bool JsonReader::skipNumber() {
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    auto digits = [this]() {
+        const char* start = position_;
+        while (position_ != end_ && isDigit(*position_)) {
+            ++position_;
+        }
+        return position_ != start;
+    };
+    if (*position_ == '-') {
+        ++position_;
+    }
+    if (position_ != end_ && *position_ == '0') {
+        ++position_;
+    } else if (!digits()) {
+        return fail();
+    }
+    if (position_ != end_ && *position_ == '.') {
+        ++position_;
+        if (!digits()) {
+            return fail();
+        }
+    }
+    if (position_ != end_ && (*position_ == 'e' || *position_ == 'E')) {
+        ++position_;
+        if (position_ != end_ && (*position_ == '+' || *position_ == '-')) {
+            ++position_;
+        }
+        if (!digits()) {
+            return fail();
+        }
+    }
+    return true;
+}
+
+bool JsonReader::skipLiteral(const char* literal, size_t length) {
+    if (static_cast<size_t>(end_ - position_) < length || std::memcmp(position_, literal, length) != 0) {
+        return fail();
+    }
+    position_ += length;
+    return true;
+}
+
+} // namespace voice_assist
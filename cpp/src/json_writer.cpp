@@ -0,0 +1,216 @@
+#include "json_writer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Same compile-time selection as the audio kernels
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VOICE_ASSIST_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define VOICE_ASSIST_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace voice_assist {
+
+namespace {
+
+inline bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+template <typename T>
+void appendShortest(std::string& out, T number, int minDigits, int maxDigits) {
+    if (!std::isfinite(number)) {
+        out += "null";
+        return;
+    }
+    char buffer[32];
+    int length = 0;
+    for (int digits = minDigits; digits <= maxDigits; ++digits) {
+        length = std::snprintf(buffer, sizeof(buffer), "%.*g", digits, static_cast<double>(number));
+        if (static_cast<T>(std::strtod(buffer, nullptr)) == number) {
+            break;
+        }
+    }
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+} // namespace
+
+size_t findJsonEscape(const char* data, size_t size) {
+    size_t i = 0;
+#if defined(VOICE_ASSIST_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Unsigned saturating subtraction leaves zero exactly for bytes <= 0x1f
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+            _mm_cmpeq_epi8(_mm_subs_epu8(bytes, control), zero));
+        if (_mm_movemask_epi8(hits) != 0) {
+            break;
+        }
+    }
+#elif defined(VOICE_ASSIST_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t control = vdupq_n_u8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        const uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(bytes, quote), vceqq_u8(bytes, backslash)),
+                                         vcltq_u8(bytes, control));
+        const uint64x2_t lanes = vreinterpretq_u64_u8(hits);
+        if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0) {
+            break;
+        }
+    }
+#endif
+    // The block that matched, and the tail
+    for (; i < size; ++i) {
+        if (needsEscape(static_cast<unsigned char>(data[i]))) {
+            return i;
+        }
+    }
+    return size;
+}
+
+void appendJsonString(std::string& out, const char* data, size_t size) {
+    static const char kHex[] = "0123456789abcdef";
+
+    out += '"';
+    size_t start = 0;
+    while (start < size) {
+        const size_t end = start + findJsonEscape(data + start, size - start);
+        out.append(data + start, end - start);
+        if (end == size) {
+            break;
+        }
+
+        const unsigned char c = static_cast<unsigned char>(data[end]);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                const char escape[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xf]};
+                out.append(escape, sizeof(escape));
+                break;
+            }
+        }
+        start = end + 1;
+    }
+    out += '"';
+}
+
+JsonWriter::JsonWriter(std::string& out)
+    : out_(out) {
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_ += '{';
+    needComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out_ += '}';
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_ += '[';
+    needComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out_ += ']';
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    separate();
+    appendJsonString(out_, name.data(), name.size());
+    out_ += ':';
+    // The value follows without a comma
+    needComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& text) {
+    return value(text.data(), text.size());
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    return value(text, std::strlen(text));
+}
+
+JsonWriter& JsonWriter::value(const char* data, size_t size) {
+    separate();
+    appendJsonString(out_, data, size);
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out_ += flag ? "true" : "false";
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int number) {
+    return value(static_cast<int64_t>(number));
+}
+
+JsonWriter& JsonWriter::value(int64_t number) {
+    separate();
+    char buffer[24];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(number));
+    out_.append(buffer, static_cast<size_t>(length));
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(float number) {
+    separate();
+    appendShortest(out_, number, 6, 9);
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separate();
+    appendShortest(out_, number, 15, 17);
+    needComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(const std::string& json) {
+    separate();
+    out_ += json;
+    needComma_ = true;
+    return *this;
+}
+
+void JsonWriter::separate() {
+    if (needComma_) {
+        out_ += ',';
+    }
+}
+
+} // namespace voice_assist
@@ -1,16 +1,386 @@
 #include "llm_client.h"
-#include <curl/curl.h>
+#include "http_transport.h"
+#include "json_reader.h"
+#include "json_writer.h"
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <sstream>
-#include <thread>
 
 namespace voice_assist {
 
-// Helper function for CURL write callback
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
+namespace {
+
+/**
+ * @brief Splits a server-sent event stream into events as bytes arrive
+ *
+ * Only data fields matter here; event names, ids and comments are skipped.
+ */
+class SseParser {
+public:
+    /**
+     * @brief Consumes a chunk and calls onEvent with the data of each completed event
+     */
+    template <typename EventCallback>
+    void feed(const char* data, size_t size, EventCallback&& onEvent) {
+        while (size > 0) {
+            const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+            if (!newline) {
+                line_.append(data, size);
+                return;
+            }
+            line_.append(data, newline - data);
+            size -= newline - data + 1;
+            data = newline + 1;
+            
+            if (!line_.empty() && line_.back() == '\r') {
+                line_.pop_back();
+            }
+            if (line_.empty()) {
+                // A blank line ends the event
+                if (hasData_) {
+                    onEvent(event_);
+                }
+                event_.clear();
+                hasData_ = false;
+            } else if (line_.compare(0, 5, "data:") == 0) {
+                const size_t value = line_.size() > 5 && line_[5] == ' ' ? 6 : 5;
+                if (hasData_) {
+                    event_ += '\n';
+                }
+                event_.append(line_, value, std::string::npos);
+                hasData_ = true;
+            }
+            line_.clear();
+        }
+    }
+    
+private:
+    std::string line_;
+    std::string event_;
+    bool hasData_ = false;
+};
+
+/**
+ * @brief The fields of a completion, or of one streamed chunk, that the client uses
+ */
+struct Completion {
+    std::string content;        // message.content, or delta.content when streaming
+    bool hasContent = false;
+    std::string finishReason;   // Empty until the API reports one
+    bool hasUsage = false;
+    int64_t promptTokens = 0;
+    int64_t completionTokens = 0;
+};
+
+/**
+ * @brief Shortens a payload quoted in an error message
+ */
+std::string excerpt(const std::string& text) {
+    constexpr size_t kMaxLength = 200;
+    return text.size() <= kMaxLength ? text : text.substr(0, kMaxLength) + "...";
+}
+
+bool readUsage(JsonReader& reader, Completion& completion) {
+    std::string key;
+    if (!reader.beginObject()) {
+        return false;
+    }
+    completion.hasUsage = true;
+    while (reader.nextKey(key)) {
+        if (key == "prompt_tokens") {
+            if (!reader.readInteger(completion.promptTokens)) {
+                return false;
+            }
+        } else if (key == "completion_tokens") {
+            if (!reader.readInteger(completion.completionTokens)) {
+                return false;
+            }
+        } else if (!reader.skipValue()) {
+            return false;
+        }
+    }
+    return !reader.failed();
+}
+
+bool readChoice(JsonReader& reader, const char* messageKey, Completion& completion) {
+    std::string key;
+    if (!reader.beginObject()) {
+        return false;
+    }
+    while (reader.nextKey(key)) {
+        if (key == messageKey) {
+            if (!reader.beginObject()) {
+                return false;
+            }
+            while (reader.nextKey(key)) {
+                if (key == "content" && reader.peek() == JsonReader::Type::STRING) {
+                    if (!reader.readString(completion.content)) {
+                        return false;
+                    }
+                    completion.hasContent = true;
+                } else if (key == "content" && reader.peek() != JsonReader::Type::NUL) {
+                    return false;
+                } else if (!reader.skipValue()) {
+                    return false;
+                }
+            }
+        } else if (key == "finish_reason" && reader.peek() == JsonReader::Type::STRING) {
+            if (!reader.readString(completion.finishReason)) {
+                return false;
+            }
+        } else if (!reader.skipValue()) {
+            return false;
+        }
+    }
+    return !reader.failed();
+}
+
+/**
+ * @brief Reads the fields without building a DOM
+ *
+ * Only the first choice is read and everything else is skipped.
+ * @return false for anything unusual, which readCompletionDom() then handles
+ */
+bool scanCompletion(const std::string& json, const char* messageKey, Completion& completion) {
+    JsonReader reader(json.data(), json.size());
+    std::string key;
+    if (!reader.beginObject()) {
+        return false;
+    }
+    while (reader.nextKey(key)) {
+        if (key == "choices") {
+            if (!reader.beginArray()) {
+                return false;
+            }
+            for (bool first = true; reader.nextElement(); first = false) {
+                if (first ? !readChoice(reader, messageKey, completion) : !reader.skipValue()) {
+                    return false;
+                }
+            }
+        } else if (key == "usage" && reader.peek() == JsonReader::Type::OBJECT) {
+            if (!readUsage(reader, completion)) {
+                return false;
+            }
+        } else if (key == "error") {
+            // Left to the DOM path, which reports it
+            return false;
+        } else if (!reader.skipValue()) {
+            return false;
+        }
+    }
+    return reader.atEnd();
+}
+
+/**
+ * @brief Reads the fields through a full parse; throws on errors
+ */
+void readCompletionDom(const std::string& json, const char* messageKey, Completion& completion) {
+    completion = Completion();
+    const auto document = nlohmann::json::parse(json, nullptr, false);
+    if (document.is_discarded() || !document.is_object()) {
+        throw std::runtime_error("Invalid JSON: " + excerpt(json));
+    }
+    const auto error = document.find("error");
+    if (error != document.end()) {
+        throw std::runtime_error("API error: " + excerpt(error->dump()));
+    }
+    
+    const auto choices = document.find("choices");
+    if (choices != document.end() && choices->is_array() && !choices->empty() && (*choices)[0].is_object()) {
+        const auto& choice = (*choices)[0];
+        const auto message = choice.find(messageKey);
+        if (message != choice.end() && message->is_object()) {
+            const auto content = message->find("content");
+            if (content != message->end() && content->is_string()) {
+                completion.content = content->get<std::string>();
+                completion.hasContent = true;
+            }
+        }
+        const auto finishReason = choice.find("finish_reason");
+        if (finishReason != choice.end() && finishReason->is_string()) {
+            completion.finishReason = finishReason->get<std::string>();
+        }
+    }
+    
+    const auto usage = document.find("usage");
+    if (usage != document.end() && usage->is_object()) {
+        completion.hasUsage = true;
+        completion.promptTokens = usage->value("prompt_tokens", int64_t(0));
+        completion.completionTokens = usage->value("completion_tokens", int64_t(0));
+    }
+}
+
+void readCompletion(const std::string& json, const char* messageKey, Completion& completion) {
+    completion = Completion();
+    if (!scanCompletion(json, messageKey, completion)) {
+        readCompletionDom(json, messageKey, completion);
+    }
+}
+
+/**
+ * @brief Extracts the reply from a complete response body
+ */
+Completion parseResponse(const std::string& body) {
+    Completion completion;
+    readCompletion(body, "message", completion);
+    if (!completion.hasContent) {
+        throw std::runtime_error("Invalid response format: " + excerpt(body));
+    }
+    return completion;
+}
+
+/**
+ * @brief Extracts the text and any finish reason or usage of one streamed chunk
+ * @return false once the stream reports that it is complete
+ */
+bool readStreamEvent(const std::string& event, Completion& chunk) {
+    if (event == "[DONE]") {
+        chunk = Completion();
+        return false;
+    }
+    readCompletion(event, "delta", chunk);
+    return true;
+}
+
+std::vector<std::string> endpointUrls(const LlmClientConfig& config) {
+    return config.endpoints.empty() ? std::vector<std::string>{config.baseUrl} : config.endpoints;
+}
+
+} // namespace
+
+/**
+ * @brief One send of a request to one endpoint
+ */
+struct LlmAttempt {
+    EndpointRouter::EndpointPtr endpoint;
+    std::chrono::steady_clock::time_point sendAt;   // After any hedge delay
+    std::atomic<HttpTransport::RequestId> transportId{0};
+    bool done = false;                              // Completed; I/O thread only
+};
+
+/**
+ * @brief State of one request from submission to its callback
+ */
+struct LlmRequestState {
+    std::string body;
+    bool stream = false;
+    LlmClient::DeltaCallback onDelta;
+    LlmClient::ResponseCallback callback;
+    std::promise<std::string> promise;
+    std::atomic<bool> resolved{false};  // The promise has been set
+    LlmAttempt attempts[2];             // The first choice and, when hedged, the second
+    std::atomic<int> attemptCount{0};   // Set, like the attempts, before any is sent
+    std::atomic<int> winner{-1};        // Attempt whose response is used
+    std::atomic<bool> aborted{false};   // Stops the transfers
+    std::atomic<bool> canceled{false};  // Nobody wants the result; skip the callbacks
+    bool cached = false;                // content came from the response cache
+    bool cacheable = false;             // Store a successful result under cacheKey
+    ResponseCache::Key cacheKey;
+    
+    // Handed over from the I/O thread; drained by one pool task at a time,
+    // which keeps deltas and the final callback in order
+    std::mutex mutex;
+    std::string data;
+    HttpResponse response;
+    int outstanding = 0;                // Attempts not yet completed
+    bool ended = false;
+    bool scheduled = false;
+    
+    // Taken by cancel() and around every delta, so that none runs once
+    // cancel() returns. Recursive, as the callbacks may cancel.
+    std::recursive_mutex deliveryMutex;
+    bool delivering = false;            // The final callback is about to run; too late to cancel
+    
+    // Only touched by the draining task
+    SseParser parser;
+    std::string content;
+    bool finished = false;              // The stream reported [DONE]
+    Completion chunk;                   // Last event read
+    Completion outcome;                 // Finish reason and usage as reported; the text is in content
+    std::string error;
+    
+    /**
+     * @brief Claims the right to set the promise; true for exactly one caller
+     */
+    bool resolve() {
+        return !resolved.exchange(true);
+    }
+    
+    void fail(const std::string& message) {
+        if (resolve()) {
+            promise.set_exception(std::make_exception_ptr(std::runtime_error(message)));
+        }
+    }
+    
+    /**
+     * @brief Makes an attempt the one whose response is used; true if it is
+     */
+    bool claim(int index) {
+        int expected = -1;
+        return winner.compare_exchange_strong(expected, index) || expected == index;
+    }
+    
+    /**
+     * @brief Checks whether another attempt's response is used instead
+     */
+    bool lost(int index) const {
+        const int current = winner;
+        return current >= 0 && current != index;
+    }
+    
+    /**
+     * @brief Stops the transfers; their completions still run, as errors
+     */
+    void abort() {
+        aborted = true;
+        for (int i = 0; i < attemptCount; ++i) {
+            if (HttpTransport::RequestId id = attempts[i].transportId) {
+                HttpTransport::instance().cancel(id);
+            }
+        }
+    }
+    
+    /**
+     * @brief Passes text to onDelta unless the request was canceled
+     */
+    void deliver(const std::string& text) {
+        std::lock_guard<std::recursive_mutex> lock(deliveryMutex);
+        if (!canceled) {
+            onDelta(text);
+        }
+    }
+    
+    void cancel() {
+        {
+            // Waits out a delta in progress; the final callback is either
+            // skipped or already on its way
+            std::lock_guard<std::recursive_mutex> lock(deliveryMutex);
+            if (resolved || delivering) {
+                return;
+            }
+            canceled = true;
+        }
+        abort();
+        fail("LLM API error: Request canceled");
+    }
+};
+
+void LlmRequest::cancel() {
+    if (state_) {
+        state_->cancel();
+    }
+}
+
+bool LlmRequest::valid() const {
+    return state_ != nullptr;
+}
+
+std::future<std::string>& LlmRequest::response() {
+    return response_;
 }
 
 // Constructor for Message
@@ -19,73 +389,410 @@ Message::Message(Role role, const std::string& content)
     // Generate a unique ID
     static size_t counter = 0;
     id = "msg_" + std::to_string(counter++);
+    
+    const char* roleName = "user";
+    switch (role) {
+        case Role::SYSTEM:
+            roleName = "system";
+            break;
+        case Role::USER:
+            roleName = "user";
+            break;
+        case Role::ASSISTANT:
+            roleName = "assistant";
+            break;
+    }
+    auto encoded = std::make_shared<std::string>();
+    encoded->reserve(content.size() + 40);
+    JsonWriter(*encoded).beginObject()
+        .key("role").value(roleName)
+        .key("content").value(content)
+        .endObject();
+    json_ = std::move(encoded);
+}
+
+const std::string& Message::json() const {
+    return *json_;
 }
 
 LlmClient::LlmClient(const LlmClientConfig& config)
-    : config_(config), cancelRequested_(false) {
-    // Initialize curl globally (should be done only once in the application)
-    curl_global_init(CURL_GLOBAL_ALL);
+    : config_(config),
+      callbacks_(std::make_unique<WorkerPool>(static_cast<size_t>(std::max(config.callbackThreads, 1)))),
+      router_(std::make_unique<EndpointRouter>(endpointUrls(config))) {
+    if (config_.cache.enabled) {
+        cache_ = std::make_unique<ResponseCache>(config_.cache);
+    }
 }
 
 LlmClient::~LlmClient() {
-    // Clean up curl
-    curl_global_cleanup();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shuttingDown_ = true;
+    }
+    cancelPendingRequests();
+    
+    // Canceled transfers complete promptly; then the pool finishes the
+    // tasks it still holds
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this]() { return active_.empty(); });
+    }
+    callbacks_.reset();
 }
 
-std::future<std::string> LlmClient::sendConversation(
+LlmRequest LlmClient::sendConversation(
     const std::vector<Message>& messages,
     ResponseCallback callback
 ) {
-    // Reset cancel flag
+    return startRequest(messages, nullptr, std::move(callback));
+}
+
+LlmRequest LlmClient::streamConversation(
+    const std::vector<Message>& messages,
+    DeltaCallback onDelta,
+    ResponseCallback callback
+) {
+    return startRequest(messages, std::move(onDelta), std::move(callback));
+}
+
+LlmRequest LlmClient::startRequest(
+    const std::vector<Message>& messages,
+    DeltaCallback onDelta,
+    ResponseCallback callback
+) {
+    auto request = std::make_shared<Request>();
+    request->stream = onDelta != nullptr;
+    request->onDelta = std::move(onDelta);
+    request->callback = std::move(callback);
+    
+    LlmRequest handle;
+    handle.state_ = request;
+    handle.response_ = request->promise.get_future();
+    
     std::lock_guard<std::mutex> lock(mutex_);
-    cancelRequested_ = false;
+    if (cache_ && !shuttingDown_) {
+        request->cacheKey = cacheKey(messages);
+        request->cacheable = true;
+        if (cache_->lookup(request->cacheKey, request->content)) {
+            request->cached = true;
+            if (!callbacks_->post([this, request]() {
+                if (request->stream) {
+                    request->deliver(request->content);
+                }
+                complete(request);
+            })) {
+                request->fail("LLM API error: Request canceled");
+            }
+            return handle;
+        }
+    }
+    request->body = buildRequestBody(messages, request->stream);
     
-    // Create a promise for the result
-    auto promise = std::make_shared<std::promise<std::string>>();
+    // Canceled requests give up their queue slots here rather than when
+    // they reach the front
+    queued_.erase(std::remove_if(queued_.begin(), queued_.end(),
+                                 [](const std::shared_ptr<Request>& queued) { return queued->canceled.load(); }),
+                  queued_.end());
     
-    // Launch in a separate thread
-    std::thread t([this, promise, messages, callback]() {
-        try {
-            // Build request body
-            std::string requestBody = buildRequestBody(messages);
-            
-            // Perform the request
-            std::string response = performRequest("chat/completions", requestBody);
-            
-            // Parse the response
-            std::string result = parseResponse(response);
-            
-            // Call the callback if provided
-            if (callback) {
-                callback(result, false);
+    if (shuttingDown_) {
+        request->cancel();
+        return handle;
+    } else if (active_.size() < static_cast<size_t>(std::max(config_.maxConcurrentRequests, 1))) {
+        dispatch(request);
+        return handle;
+    } else if (queued_.size() < static_cast<size_t>(std::max(config_.maxQueuedRequests, 0))) {
+        queued_.push_back(request);
+        return handle;
+    }
+    
+    // Rejected: reported from the pool like any other outcome, never from
+    // the caller's thread, which may be holding locks of its own
+    request->error = "Too many pending requests";
+    if (!callbacks_->post([this, request]() { complete(request); })) {
+        request->fail(request->error);
+    }
+    return handle;
+}
+
+void LlmClient::dispatch(const std::shared_ptr<Request>& request) {
+    // Called with mutex_ held
+    active_.push_back(request);
+    
+    const EndpointRouter::EndpointPtr primary = router_->choose();
+    const EndpointRouter::EndpointPtr hedge = config_.hedgeRequests ? router_->choose(primary) : nullptr;
+    // The hedge is held back in the transport, and canceled unsent if the
+    // first attempt starts answering in time
+    const long delayMs = hedge
+        ? static_cast<long>(router_->hedgeDelayMs(primary, static_cast<double>(std::max(config_.hedgeDelayMs, 0))))
+        : 0;
+    const auto now = std::chrono::steady_clock::now();
+    request->attempts[0].endpoint = primary;
+    request->attempts[0].sendAt = now;
+    request->attempts[1].endpoint = hedge;
+    request->attempts[1].sendAt = now + std::chrono::milliseconds(delayMs);
+    request->attemptCount = hedge ? 2 : 1;
+    request->outstanding = request->attemptCount;
+    
+    std::string body = std::move(request->body);
+    if (hedge) {
+        sendAttempt(request, 0, body, 0);
+        sendAttempt(request, 1, std::move(body), delayMs);
+    } else {
+        sendAttempt(request, 0, std::move(body), 0);
+    }
+}
+
+void LlmClient::sendAttempt(const std::shared_ptr<Request>& request, int index, std::string body, long delayMs) {
+    // Called with mutex_ held. Every callback runs on the I/O thread, so
+    // the attempts of one request never race each other; the request stays
+    // in active_ until all of them complete, which keeps this alive for
+    // them.
+    LlmAttempt& attempt = request->attempts[index];
+    
+    HttpRequest httpRequest;
+    httpRequest.url = EndpointRouter::baseUrl(attempt.endpoint) + "chat/completions";
+    httpRequest.headers = {
+        "Content-Type: application/json",
+        "Authorization: Bearer " + config_.apiKey
+    };
+    httpRequest.onResponseStart = [this, request, index]() {
+        claimAttempt(request, index);
+    };
+    if (request->stream) {
+        httpRequest.headers.push_back("Accept: text/event-stream");
+        // The I/O thread only queues the bytes; parsing and the delta
+        // callback run on the pool, so a slow consumer never holds up
+        // other transfers
+        httpRequest.onData = [this, request, index](const char* data, size_t size) {
+            if (request->lost(index)) {
+                return false;
+            }
+            if (size > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(request->mutex);
+                    request->data.append(data, size);
+                }
+                schedule(request);
+            }
+            return !request->aborted;
+        };
+    }
+    httpRequest.body = std::move(body);
+    httpRequest.timeoutSeconds = config_.timeout;
+    httpRequest.delayMs = delayMs;
+    
+    attempt.transportId = HttpTransport::instance().submit(
+        std::move(httpRequest),
+        [this, request, index](HttpResponse response) {
+            LlmAttempt& attempt = request->attempts[index];
+            attempt.done = true;
+            // A 2xx response with an empty body never started answering
+            if (response.ok && response.status >= 200 && response.status < 300) {
+                claimAttempt(request, index);
+            }
+            // Canceled attempts say nothing about their endpoint
+            if (!request->lost(index) && !request->aborted) {
+                const bool failed = !response.ok || response.status == 429 || response.status >= 500;
+                router_->reportResult(attempt.endpoint, failed, !failed && request->winner == index);
             }
             
-            // Set the promise value
-            promise->set_value(result);
-        } catch (const std::exception& e) {
-            std::string errorMsg = "LLM API error: " + std::string(e.what());
-            std::cerr << errorMsg << std::endl;
-            
-            // Call the callback with the error if provided
-            if (callback) {
-                callback(errorMsg, true);
+            // The winner's response is used; without one, a failed attempt
+            // leaves the request to the other, and the last failure is
+            // reported
+            bool ended = false;
+            {
+                std::lock_guard<std::mutex> lock(request->mutex);
+                if (!request->lost(index)) {
+                    request->response = std::move(response);
+                }
+                ended = --request->outstanding == 0;
+                request->ended = ended;
+            }
+            if (ended) {
+                schedule(request);
+            }
+        }
+    );
+    // A cancel() or a win that came before the id was known could not stop
+    // the transfer
+    if (request->aborted || request->lost(index)) {
+        HttpTransport::instance().cancel(attempt.transportId);
+    }
+}
+
+void LlmClient::claimAttempt(const std::shared_ptr<Request>& request, int index) {
+    // On the I/O thread
+    if (request->winner == index || !request->claim(index)) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    LlmAttempt& winner = request->attempts[index];
+    router_->reportLatency(winner.endpoint,
+                           std::chrono::duration<double, std::milli>(now - winner.sendAt).count());
+    
+    // The other attempt lost: stop it, and charge its endpoint for the wait
+    const int other = 1 - index;
+    if (other >= request->attemptCount || request->attempts[other].done) {
+        return;
+    }
+    LlmAttempt& loser = request->attempts[other];
+    if (loser.sendAt < now) {
+        router_->reportLoss(loser.endpoint, std::chrono::duration<double, std::milli>(now - loser.sendAt).count());
+    }
+    if (HttpTransport::RequestId id = loser.transportId) {
+        HttpTransport::instance().cancel(id);
+    }
+}
+
+void LlmClient::schedule(const std::shared_ptr<Request>& request) {
+    {
+        std::lock_guard<std::mutex> lock(request->mutex);
+        if (request->scheduled) {
+            return;
+        }
+        request->scheduled = true;
+    }
+    callbacks_->post([this, request]() { drain(request); });
+}
+
+void LlmClient::drain(const std::shared_ptr<Request>& request) {
+    std::string chunk;
+    while (true) {
+        bool ended = false;
+        {
+            std::lock_guard<std::mutex> lock(request->mutex);
+            chunk.swap(request->data);
+            ended = request->ended;
+            if (chunk.empty() && !ended) {
+                request->scheduled = false;
+                return;
+            }
+        }
+        
+        if (request->stream && !request->finished && request->error.empty() && !request->canceled) {
+            try {
+                request->parser.feed(chunk.data(), chunk.size(), [&](const std::string& event) {
+                    if (request->finished) {
+                        return;
+                    }
+                    Completion& chunk = request->chunk;
+                    request->finished = !readStreamEvent(event, chunk);
+                    if (!chunk.finishReason.empty()) {
+                        request->outcome.finishReason = chunk.finishReason;
+                    }
+                    if (chunk.hasUsage) {
+                        request->outcome.hasUsage = true;
+                        request->outcome.promptTokens = chunk.promptTokens;
+                        request->outcome.completionTokens = chunk.completionTokens;
+                    }
+                    if (!chunk.content.empty()) {
+                        request->content += chunk.content;
+                        request->deliver(chunk.content);
+                    }
+                });
+            } catch (const std::exception& e) {
+                request->error = e.what();
+                request->abort();
+            }
+        }
+        chunk.clear();
+        
+        // Everything the transfer delivered came before its completion
+        if (ended) {
+            complete(request);
+            return;
+        }
+    }
+}
+
+void LlmClient::complete(const std::shared_ptr<Request>& request) {
+    std::string result;
+    bool isError = false;
+    try {
+        const HttpResponse& response = request->response;
+        if (!request->error.empty()) {
+            throw std::runtime_error(request->error);
+        }
+        if (request->cached) {
+            result = std::move(request->content);
+        } else {
+            // A transfer error after the stream reported [DONE] loses nothing
+            if (!response.ok && !request->finished) {
+                throw std::runtime_error(response.error);
+            }
+            if (response.status < 200 || response.status >= 300) {
+                std::ostringstream errorMsg;
+                errorMsg << "HTTP error " << response.status << ": " << excerpt(response.body);
+                throw std::runtime_error(errorMsg.str());
+            }
+            if (request->stream) {
+                result = std::move(request->content);
+            } else {
+                request->outcome = parseResponse(response.body);
+                result = std::move(request->outcome.content);
+            }
+            if (request->cacheable) {
+                cache_->store(request->cacheKey, result);
             }
             
-            // Set the promise exception
-            promise->set_exception(std::make_exception_ptr(std::runtime_error(errorMsg)));
+            const Completion& outcome = request->outcome;
+            std::lock_guard<std::mutex> lock(usageMutex_);
+            ++usage_.responses;
+            if (outcome.hasUsage) {
+                usage_.promptTokens += static_cast<uint64_t>(std::max<int64_t>(outcome.promptTokens, 0));
+                usage_.completionTokens += static_cast<uint64_t>(std::max<int64_t>(outcome.completionTokens, 0));
+            }
+            if (outcome.finishReason == "length") {
+                ++usage_.truncated;
+            }
         }
-    });
+    } catch (const std::exception& e) {
+        result = "LLM API error: " + std::string(e.what());
+        isError = true;
+    }
     
-    // Detach the thread
-    t.detach();
+    // Free the slot before the callback, which may well send the next request
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_.erase(std::remove(active_.begin(), active_.end(), request), active_.end());
+        while (!shuttingDown_ && !queued_.empty() &&
+               active_.size() < static_cast<size_t>(std::max(config_.maxConcurrentRequests, 1))) {
+            std::shared_ptr<Request> next = std::move(queued_.front());
+            queued_.pop_front();
+            if (!next->canceled) {
+                dispatch(next);
+            }
+        }
+    }
+    idle_.notify_all();
     
-    // Return the future from the promise
-    return promise->get_future();
+    // A canceled request already failed its future when it was canceled.
+    // Decided under the delivery mutex, so a cancel() that returns before
+    // this point is never followed by the callback.
+    {
+        std::lock_guard<std::recursive_mutex> lock(request->deliveryMutex);
+        if (request->canceled) {
+            return;
+        }
+        request->delivering = true;
+    }
+    if (isError) {
+        std::cerr << result << std::endl;
+    }
+    if (request->callback) {
+        request->callback(result, isError);
+    }
+    if (isError) {
+        request->fail(result);
+    } else if (request->resolve()) {
+        request->promise.set_value(result);
+    }
 }
 
 void LlmClient::setConfig(const LlmClientConfig& config) {
     std::lock_guard<std::mutex> lock(mutex_);
     config_ = config;
+    router_->setEndpoints(endpointUrls(config_));
 }
 
 const LlmClientConfig& LlmClient::getConfig() const {
@@ -93,139 +800,89 @@ const LlmClientConfig& LlmClient::getConfig() const {
 }
 
 void LlmClient::cancelPendingRequests() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    cancelRequested_ = true;
-}
-
-std::string LlmClient::buildRequestBody(const std::vector<Message>& messages) {
-    using json = nlohmann::json;
-    
-    // Create the main request object
-    json requestJson = {
-        {"model", config_.model},
-        {"temperature", config_.temperature},
-        {"max_tokens", config_.maxTokens}
-    };
-    
-    // Build the messages array
-    json messagesJson = json::array();
-    for (const auto& message : messages) {
-        // Convert role enum to string
-        std::string roleStr;
-        switch (message.role) {
-            case Message::Role::SYSTEM:
-                roleStr = "system";
-                break;
-            case Message::Role::USER:
-                roleStr = "user";
-                break;
-            case Message::Role::ASSISTANT:
-                roleStr = "assistant";
-                break;
-        }
-        
-        // Add message to array
-        messagesJson.push_back({
-            {"role", roleStr},
-            {"content", message.content}
-        });
+    std::deque<std::shared_ptr<Request>> queued;
+    std::vector<std::shared_ptr<Request>> active;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued.swap(queued_);
+        active = active_;
     }
     
-    // Add messages to request
-    requestJson["messages"] = messagesJson;
-    
-    // Convert to string
-    return requestJson.dump();
+    // In-flight transfers still complete, as errors, to free their slots
+    for (const auto& request : queued) {
+        request->cancel();
+    }
+    for (const auto& request : active) {
+        request->cancel();
+    }
 }
 
-std::string LlmClient::performRequest(const std::string& endpoint, const std::string& body) {
-    // Check if canceled
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (cancelRequested_) {
-            throw std::runtime_error("Request canceled");
-        }
+LlmUsageStats LlmClient::getUsageStats() const {
+    std::lock_guard<std::mutex> lock(usageMutex_);
+    return usage_;
+}
+
+std::vector<EndpointStats> LlmClient::getEndpointStats() const {
+    return router_->getStats();
+}
+
+ResponseCacheStats LlmClient::getCacheStats() const {
+    return cache_ ? cache_->getStats() : ResponseCacheStats();
+}
+
+ResponseCache::Key LlmClient::cacheKey(const std::vector<Message>& messages) const {
+    // Everything that shapes the reply; serialized messages are
+    // self-delimiting, so no two conversations hash the same text
+    const std::vector<std::string> urls = endpointUrls(config_);
+    std::string text;
+    size_t size = config_.model.size() + 64;
+    for (const auto& url : urls) {
+        size += url.size() + 1;
     }
-    
-    // Initialize curl session
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("Failed to initialize CURL");
+    for (const auto& message : messages) {
+        size += message.json().size();
     }
-    
-    // Response string
-    std::string responseString;
-    
-    // Full URL
-    std::string url = config_.baseUrl + endpoint;
-    
-    // Set up the request
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseString);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, config_.timeout);
-    
-    // Set up HTTP headers
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    std::string authHeader = "Authorization: Bearer " + config_.apiKey;
-    headers = curl_slist_append(headers, authHeader.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    
-    // Set the request body
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    
-    // Perform the request
-    CURLcode res = curl_easy_perform(curl);
-    
-    // Check for errors
-    if (res != CURLE_OK) {
-        std::string errorMsg = "CURL error: " + std::string(curl_easy_strerror(res));
-        
-        // Clean up
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        
-        throw std::runtime_error(errorMsg);
+    text.reserve(size);
+    for (const auto& url : urls) {
+        text += url;
+        text += '\n';
     }
-    
-    // Get HTTP response code
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    
-    // Clean up
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    
-    // Check HTTP status
-    if (httpCode < 200 || httpCode >= 300) {
-        std::ostringstream errorMsg;
-        errorMsg << "HTTP error " << httpCode << ": " << responseString;
-        throw std::runtime_error(errorMsg.str());
+    text += config_.model;
+    text += '\n';
+    text += std::to_string(config_.temperature);
+    text += '\n';
+    text += std::to_string(config_.maxTokens);
+    text += '\n';
+    for (const auto& message : messages) {
+        text += message.json();
     }
-    
-    return responseString;
+    return ResponseCache::makeKey(text);
 }
 
-std::string LlmClient::parseResponse(const std::string& jsonResponse) {
-    try {
-        // Parse JSON
-        auto responseJson = nlohmann::json::parse(jsonResponse);
-        
-        // Extract the choice
-        if (responseJson.contains("choices") && 
-            responseJson["choices"].is_array() && 
-            !responseJson["choices"].empty() &&
-            responseJson["choices"][0].contains("message") &&
-            responseJson["choices"][0]["message"].contains("content")) {
-            
-            return responseJson["choices"][0]["message"]["content"];
-        }
-        
-        throw std::runtime_error("Invalid response format: " + jsonResponse);
-    } catch (const nlohmann::json::exception& e) {
-        throw std::runtime_error(std::string("JSON parsing error: ") + e.what());
+std::string LlmClient::buildRequestBody(const std::vector<Message>& messages, bool stream) {
+    // Messages are already serialized, so this is a single allocation and
+    // a copy of each one
+    size_t size = config_.model.size() + 96;
+    for (const auto& message : messages) {
+        size += message.json().size() + 1;
+    }
+    std::string body;
+    body.reserve(size);
+    
+    JsonWriter writer(body);
+    writer.beginObject()
+        .key("model").value(config_.model)
+        .key("temperature").value(config_.temperature)
+        .key("max_tokens").value(config_.maxTokens);
+    if (stream) {
+        writer.key("stream").value(true);
+    }
+    writer.key("messages").beginArray();
+    for (const auto& message : messages) {
+        writer.raw(message.json());
     }
+    writer.endArray().endObject();
+    return body;
 }
 
 } // namespace voice_assist 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "voice_assistant.h"
+#include "batch_transcriber.h"
 #include <iostream>
 #include <string>
 #include <thread>
@@ -6,6 +7,7 @@
 #include <csignal>
 #include <cstdlib>
 #include <atomic>
+#include <fstream>
 
 // Global flag for handling interrupts
 std::atomic<bool> g_running(true);
@@ -20,16 +22,76 @@ void printHelp() {
     std::cout << "Voice Assistant Commands:" << std::endl;
     std::cout << "  listen      - Start listening for voice input" << std::endl;
     std::cout << "  stop        - Stop listening" << std::endl;
+    std::cout << "  quiet       - Stop speaking the current response" << std::endl;
     std::cout << "  type TEXT   - Send text directly to the assistant" << std::endl;
     std::cout << "  clear       - Clear conversation history" << std::endl;
     std::cout << "  api KEY     - Set the API key" << std::endl;
     std::cout << "  model MODEL - Set the LLM model" << std::endl;
     std::cout << "  tts on|off  - Enable/disable text-to-speech" << std::endl;
+    std::cout << "  stats       - Show speculation, cache, token usage and endpoint statistics" << std::endl;
     std::cout << "  help        - Display this help message" << std::endl;
     std::cout << "  exit        - Exit the application" << std::endl;
 }
 
+// Offline mode: transcribe <dir|manifest> [--out FILE] [--jobs N]
+int runTranscribe(int argc, char* argv[]) {
+    std::string input;
+    std::string outputPath = "transcripts.jsonl";
+    voice_assist::BatchConfig config;
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--out" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (option == "--jobs" && i + 1 < argc) {
+            config.workers = std::atoi(argv[++i]);
+        } else if (input.empty() && option.rfind("--", 0) != 0) {
+            input = option;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+    if (input.empty()) {
+        std::cerr << "Usage: " << argv[0] << " transcribe <directory|manifest> [--out FILE] [--jobs N]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> files = voice_assist::BatchTranscriber::collectInputs(input);
+    if (files.empty()) {
+        std::cerr << "No recordings found in " << input << std::endl;
+        return 1;
+    }
+
+    // Engines may print to stdout, so results go to a file
+    std::ofstream output(outputPath);
+    if (!output) {
+        std::cerr << "Cannot write " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Transcribing " << files.size() << " recordings..." << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    double audioMs = 0.0;
+    voice_assist::BatchTranscriber transcriber(config);
+    size_t succeeded = transcriber.run(files, [&](const voice_assist::BatchResult& result) {
+        output << voice_assist::BatchTranscriber::toJsonLine(result) << '\n';
+        audioMs += result.audioMs;
+        if (!result.ok) {
+            std::cerr << result.file << ": " << result.error << std::endl;
+        }
+    });
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << succeeded << "/" << files.size() << " transcribed, " << audioMs / 1000.0 << " s of audio in "
+              << elapsedMs / 1000.0 << " s, results in " << outputPath << std::endl;
+    return succeeded == files.size() ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "transcribe") {
+        return runTranscribe(argc, argv);
+    }
+
     // Set up signal handling
     std::signal(SIGINT, signalHandler);  // Ctrl+C
     std::signal(SIGTERM, signalHandler); // Termination request
@@ -48,6 +110,39 @@ int main(int argc, char* argv[]) {
     voice_assist::VoiceAssistantConfig config;
     config.apiKey = apiKey;
     
+    // Command-line options; the file backend allows running without sound hardware
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--audio-in" && i + 1 < argc) {
+            config.audio.backend = voice_assist::AudioBackend::FILE;
+            config.audio.inputFile = argv[++i];
+        } else if (option == "--audio-out" && i + 1 < argc) {
+            config.audio.backend = voice_assist::AudioBackend::FILE;
+            config.audio.outputFile = argv[++i];
+        } else if (option == "--fast") {
+            config.audio.fileRealTime = false;
+        } else if (option == "--wake-word" && i + 1 < argc) {
+            config.wakeWordRecordings.push_back(argv[++i]);
+        } else if (option == "--speculate" && i + 1 < argc) {
+            config.speculativeStableMs = std::atoi(argv[++i]);
+        } else if (option == "--intents" && i + 1 < argc) {
+            config.intentRulesFile = argv[++i];
+        } else if (option == "--cache") {
+            config.responseCache.enabled = true;
+        } else if (option == "--cache-file" && i + 1 < argc) {
+            config.responseCache.enabled = true;
+            config.responseCache.diskPath = argv[++i];
+        } else if (option == "--endpoint" && i + 1 < argc) {
+            config.llmEndpoints.push_back(argv[++i]);
+        } else if (option == "--hedge") {
+            config.hedgeLlmRequests = true;
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--audio-in FILE] [--audio-out FILE] [--fast] [--wake-word FILE]... [--speculate MS] [--intents FILE] [--cache] [--cache-file FILE] [--endpoint URL]... [--hedge]" << std::endl;
+            return 1;
+        }
+    }
+    
     // Create voice assistant
     std::unique_ptr<voice_assist::VoiceAssistant> assistant;
     try {
@@ -75,10 +170,47 @@ int main(int argc, char* argv[]) {
             std::cout << "You said: " << text << std::endl;
         });
         
+        assistant->setPartialTranscriptionCallback([](const std::string& text) {
+            std::cout << "(hearing) " << text << std::endl;
+        });
+        
         assistant->setResponseCallback([](const std::string& response) {
             std::cout << "Assistant: " << response << std::endl;
         });
         
+        assistant->setVoiceActivityCallback([](bool speaking) {
+            std::cout << (speaking ? "(speech detected)" : "(end of speech)") << std::endl;
+        });
+        
+        assistant->setWakeWordCallback([]() {
+            std::cout << "(wake word)" << std::endl;
+        });
+        
+        assistant->setIntentCallback([](voice_assist::IntentMatch& match) {
+            std::cout << "(command) " << match.intent << std::endl;
+            if (match.intent != "timer") {
+                return true;
+            }
+            
+            // "timer" rules capture {amount:number} and {unit}
+            const std::string unit = match.slot("unit");
+            int seconds = std::atoi(match.slot("amount").c_str());
+            if (unit.rfind("min", 0) == 0) {
+                seconds *= 60;
+            } else if (unit.rfind("hour", 0) == 0) {
+                seconds *= 3600;
+            } else if (unit.rfind("sec", 0) != 0) {
+                return false;
+            }
+            std::thread([seconds]() {
+                std::this_thread::sleep_for(std::chrono::seconds(seconds));
+                if (g_running) {
+                    std::cout << "(timer finished)" << std::endl;
+                }
+            }).detach();
+            return true;
+        });
+        
         assistant->setErrorCallback([](const std::string& error) {
             std::cerr << "Error: " << error << std::endl;
         });
@@ -130,6 +262,9 @@ int main(int argc, char* argv[]) {
         else if (command == "stop") {
             assistant->stopListening();
         } 
+        else if (command == "quiet") {
+            assistant->stopSpeaking();
+        } 
         else if (command == "type") {
             if (arg.empty()) {
                 std::cout << "Please provide text to send" << std::endl;
@@ -178,6 +313,30 @@ int main(int argc, char* argv[]) {
                 std::cout << "Please specify 'on' or 'off'" << std::endl;
             }
         } 
+        else if (command == "stats") {
+            const voice_assist::SpeculationStats stats = assistant->getSpeculationStats();
+            const double hitRate = stats.dispatched > 0 ? 100.0 * stats.hits / stats.dispatched : 0.0;
+            std::cout << "Speculative requests: " << stats.dispatched << " sent, " << stats.hits << " reused ("
+                      << hitRate << "%), " << stats.misses << " discarded" << std::endl;
+            std::cout << "Time saved: " << stats.savedMs << " ms total";
+            if (stats.hits > 0) {
+                std::cout << ", " << stats.savedMs / stats.hits << " ms per reused request";
+            }
+            std::cout << std::endl;
+            const voice_assist::ResponseCacheStats cache = assistant->getResponseCacheStats();
+            std::cout << "Response cache: " << cache.memoryHits << " memory hits, " << cache.diskHits
+                      << " disk hits, " << cache.misses << " misses (" << cache.expired << " expired), "
+                      << cache.stores << " stored, " << cache.evictions << " evicted" << std::endl;
+            const voice_assist::LlmUsageStats usage = assistant->getLlmUsageStats();
+            std::cout << "LLM usage: " << usage.responses << " replies, " << usage.promptTokens << " prompt and "
+                      << usage.completionTokens << " completion tokens, " << usage.truncated << " truncated" << std::endl;
+            for (const voice_assist::EndpointStats& endpoint : assistant->getLlmEndpointStats()) {
+                std::cout << "Endpoint " << endpoint.baseUrl << ": " << endpoint.latencyMs << " ms to first byte (p95 "
+                          << endpoint.p95Ms << " ms), " << endpoint.attempts << " attempts, " << endpoint.failures
+                          << " failed, " << endpoint.wins << " used" << (endpoint.healthy ? "" : ", cooling down")
+                          << std::endl;
+            }
+        } 
         else {
             std::cout << "Unknown command: " << command << std::endl;
             std::cout << "Type 'help' for available commands" << std::endl;
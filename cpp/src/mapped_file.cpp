@@ -0,0 +1,284 @@
+#include "mapped_file.h"
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace voice_assist {
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+        mode_ = other.mode_;
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+        fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+        mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#else
+        fd_ = std::exchange(other.fd_, -1);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::isOpen() const {
+#ifdef _WIN32
+    return fileHandle_ != nullptr;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+bool MappedFile::isWritable() const {
+    return isOpen() && mode_ != Mode::READ_ONLY;
+}
+
+uint8_t* MappedFile::data() {
+    return data_;
+}
+
+const uint8_t* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+const std::string& MappedFile::path() const {
+    return path_;
+}
+
+#ifdef _WIN32
+// Windows implementation
+
+bool MappedFile::open(const std::string& path, Mode mode, size_t size) {
+    close();
+    path_ = path;
+    mode_ = mode;
+
+    DWORD access = mode == Mode::READ_ONLY ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+    DWORD disposition = mode == Mode::READ_ONLY ? OPEN_EXISTING
+                      : mode == Mode::CREATE ? CREATE_ALWAYS : OPEN_ALWAYS;
+
+    HANDLE file = CreateFileA(path.c_str(), access, FILE_SHARE_READ, nullptr, disposition,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open " << path << ": " << GetLastError() << std::endl;
+        return false;
+    }
+    fileHandle_ = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    if (mode != Mode::READ_ONLY && size > size_) {
+        return resize(size);
+    }
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::resize(size_t size) {
+    if (!isWritable()) {
+        return false;
+    }
+
+    unmap();
+
+    LARGE_INTEGER distance;
+    distance.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(fileHandle_, distance, nullptr, FILE_BEGIN) || !SetEndOfFile(fileHandle_)) {
+        std::cerr << "Failed to resize " << path_ << ": " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+    size_ = size;
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::sync() {
+    if (!isWritable() || !data_) {
+        return false;
+    }
+    return FlushViewOfFile(data_, size_) && FlushFileBuffers(fileHandle_);
+}
+
+void MappedFile::close() {
+    unmap();
+    if (fileHandle_) {
+        CloseHandle(fileHandle_);
+        fileHandle_ = nullptr;
+    }
+    size_ = 0;
+}
+
+bool MappedFile::map() {
+    if (size_ == 0) {
+        // Zero-length files cannot be mapped; data() stays null until resize()
+        return true;
+    }
+
+    DWORD protect = mode_ == Mode::READ_ONLY ? PAGE_READONLY : PAGE_READWRITE;
+    mappingHandle_ = CreateFileMappingA(fileHandle_, nullptr, protect, 0, 0, nullptr);
+    if (!mappingHandle_) {
+        std::cerr << "Failed to map " << path_ << ": " << GetLastError() << std::endl;
+        return false;
+    }
+
+    DWORD access = mode_ == Mode::READ_ONLY ? FILE_MAP_READ : FILE_MAP_WRITE;
+    data_ = static_cast<uint8_t*>(MapViewOfFile(mappingHandle_, access, 0, 0, size_));
+    if (!data_) {
+        std::cerr << "Failed to map view of " << path_ << ": " << GetLastError() << std::endl;
+        CloseHandle(mappingHandle_);
+        mappingHandle_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mappingHandle_) {
+        CloseHandle(mappingHandle_);
+        mappingHandle_ = nullptr;
+    }
+}
+
+#else
+// POSIX implementation
+
+bool MappedFile::open(const std::string& path, Mode mode, size_t size) {
+    close();
+    path_ = path;
+    mode_ = mode;
+
+    int flags = O_RDONLY;
+    if (mode == Mode::READ_WRITE) {
+        flags = O_RDWR | O_CREAT;
+    } else if (mode == Mode::CREATE) {
+        flags = O_RDWR | O_CREAT | O_TRUNC;
+    }
+
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    if (mode != Mode::READ_ONLY && size > size_) {
+        return resize(size);
+    }
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::resize(size_t size) {
+    if (!isWritable()) {
+        return false;
+    }
+
+    unmap();
+
+    if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Failed to resize " << path_ << std::endl;
+        close();
+        return false;
+    }
+    size_ = size;
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::sync() {
+    if (!isWritable() || !data_) {
+        return false;
+    }
+    return msync(data_, size_, MS_SYNC) == 0;
+}
+
+void MappedFile::close() {
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
+
+bool MappedFile::map() {
+    if (size_ == 0) {
+        // Zero-length files cannot be mapped; data() stays null until resize()
+        return true;
+    }
+
+    int protection = mode_ == Mode::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* address = mmap(nullptr, size_, protection, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED) {
+        std::cerr << "Failed to map " << path_ << std::endl;
+        return false;
+    }
+
+    data_ = static_cast<uint8_t*>(address);
+    if (mode_ == Mode::READ_ONLY) {
+        madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+}
+
+#endif
+
+} // namespace voice_assist
@@ -0,0 +1,159 @@
+#include "noise_suppressor.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace voice_assist {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Frames averaged to seed the noise estimate
+constexpr size_t kInitialNoiseFrames = 10;
+// Power smoothing applied before noise tracking
+constexpr float kPowerSmoothing = 0.7f;
+// Noise estimate tracks decreases quickly and creeps up by ~2 dB/s
+constexpr float kNoiseFall = 0.2f;
+constexpr float kNoiseRise = 1.005f;
+// Decision-directed a priori SNR weight
+constexpr float kPriorWeight = 0.98f;
+// Never attenuate by more than 20 dB, which keeps musical noise down
+constexpr float kMinGain = 0.1f;
+constexpr float kEpsilon = 1e-12f;
+
+} // namespace
+
+NoiseSuppressor::NoiseSuppressor(int sampleRate)
+    : hop_(std::max<size_t>(static_cast<size_t>(sampleRate) / 100, 16)),
+      window_(2 * hop_),
+      fft_(Fft::nextPowerOfTwo(window_)) {
+    sqrtHann_.resize(window_);
+    for (size_t i = 0; i < window_; ++i) {
+        // Periodic Hann; analysis and synthesis windows multiply back to Hann,
+        // which sums to one at 50% overlap
+        const double hann = 0.5 - 0.5 * std::cos(2.0 * kPi * i / window_);
+        sqrtHann_[i] = static_cast<float>(std::sqrt(hann));
+    }
+
+    const size_t bins = fft_.bins();
+    history_.resize(window_);
+    frame_.resize(fft_.size());
+    real_.resize(bins);
+    imag_.resize(bins);
+    noisePower_.resize(bins);
+    smoothedPower_.resize(bins);
+    previousGain_.resize(bins);
+    previousPosterior_.resize(bins);
+    overlap_.resize(hop_);
+    hopInput_.resize(hop_);
+    hopOutput_.resize(hop_);
+
+    reset();
+}
+
+void NoiseSuppressor::process(const int16_t* in, int16_t* out, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        const size_t chunk = std::min(count - done, hop_ - hopFill_);
+
+        // Read before writing so in and out may alias
+        std::memcpy(hopInput_.data() + hopFill_, in + done, chunk * sizeof(int16_t));
+        std::memcpy(out + done, hopOutput_.data() + hopFill_, chunk * sizeof(int16_t));
+
+        hopFill_ += chunk;
+        done += chunk;
+        if (hopFill_ == hop_) {
+            processHop();
+            hopFill_ = 0;
+        }
+    }
+}
+
+void NoiseSuppressor::reset() {
+    frames_ = 0;
+    hopFill_ = 0;
+    history_.clear();
+    overlap_.clear();
+    hopOutput_.clear();
+    noisePower_.clear();
+    smoothedPower_.clear();
+    previousPosterior_.clear();
+    std::fill(previousGain_.data(), previousGain_.data() + previousGain_.size(), 1.0f);
+}
+
+size_t NoiseSuppressor::latencySamples() const {
+    // One hop of analysis look-ahead plus one hop of buffering
+    return 2 * hop_;
+}
+
+void NoiseSuppressor::processHop() {
+    float* history = history_.data();
+    float* frame = frame_.data();
+    float* real = real_.data();
+    float* imag = imag_.data();
+    const float* window = sqrtHann_.data();
+    const size_t bins = fft_.bins();
+
+    std::memmove(history, history + hop_, (window_ - hop_) * sizeof(float));
+    kernels::int16ToFloat(hopInput_.data(), history + window_ - hop_, hop_);
+
+    for (size_t i = 0; i < window_; ++i) {
+        frame[i] = history[i] * window[i];
+    }
+    std::fill(frame + window_, frame + fft_.size(), 0.0f);
+
+    fft_.forward(frame, real, imag);
+
+    float* noise = noisePower_.data();
+    float* smoothed = smoothedPower_.data();
+    float* previousGain = previousGain_.data();
+    float* previousPosterior = previousPosterior_.data();
+
+    if (frames_ < kInitialNoiseFrames) {
+        // Seed the noise estimate with a running mean of the first frames
+        const float weight = 1.0f / (frames_ + 1);
+        for (size_t k = 0; k < bins; ++k) {
+            const float power = real[k] * real[k] + imag[k] * imag[k];
+            smoothed[k] = frames_ == 0 ? power : kPowerSmoothing * smoothed[k] + (1.0f - kPowerSmoothing) * power;
+            noise[k] += weight * (power - noise[k]);
+        }
+    } else {
+        for (size_t k = 0; k < bins; ++k) {
+            const float power = real[k] * real[k] + imag[k] * imag[k];
+            smoothed[k] = kPowerSmoothing * smoothed[k] + (1.0f - kPowerSmoothing) * power;
+            noise[k] = smoothed[k] < noise[k]
+                ? noise[k] + kNoiseFall * (smoothed[k] - noise[k])
+                : std::min(noise[k] * kNoiseRise, smoothed[k]);
+        }
+    }
+
+    for (size_t k = 0; k < bins; ++k) {
+        const float power = real[k] * real[k] + imag[k] * imag[k];
+        const float posterior = power / (noise[k] + kEpsilon);
+        const float prior = kPriorWeight * previousGain[k] * previousGain[k] * previousPosterior[k] +
+                            (1.0f - kPriorWeight) * std::max(posterior - 1.0f, 0.0f);
+        const float gain = std::min(std::max(prior / (1.0f + prior), kMinGain), 1.0f);
+
+        previousGain[k] = gain;
+        previousPosterior[k] = posterior;
+        real[k] *= gain;
+        imag[k] *= gain;
+    }
+
+    fft_.inverse(real, imag, frame);
+
+    // Overlap-add; the first hop is complete, the second is kept for next time
+    float* overlap = overlap_.data();
+    for (size_t i = 0; i < hop_; ++i) {
+        const float output = overlap[i] + frame[i] * window[i];
+        overlap[i] = frame[hop_ + i] * window[hop_ + i];
+        frame[i] = output;
+    }
+    kernels::floatToInt16(frame, hopOutput_.data(), hop_);
+
+    ++frames_;
+}
+
+} // namespace voice_assist
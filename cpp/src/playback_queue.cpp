@@ -0,0 +1,261 @@
+#include "playback_queue.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace voice_assist {
+
+namespace {
+
+// The device thread signals without taking the lock, so waiters re-check
+// their condition at least this often in case a wakeup slipped past them
+constexpr auto kPollInterval = std::chrono::milliseconds(10);
+// Finished streams kept around so wait() can still report how they ended
+constexpr size_t kMaxFinishedStreams = 64;
+
+bool isValidFormat(const AudioFormat& format) {
+    return format.sampleRate > 0 && format.channels > 0;
+}
+
+} // namespace
+
+PlaybackQueue::PlaybackQueue(const AudioFormat& format, int capacityMs, int prebufferMs)
+    : format_(format) {
+    if (!isValidFormat(format)) {
+        throw std::invalid_argument("Playback format must have a positive rate and channel count");
+    }
+
+    const size_t samplesPerSecond = static_cast<size_t>(format.sampleRate) * format.channels;
+    const size_t capacity = std::max<size_t>(samplesPerSecond * std::max(capacityMs, 1) / 1000, format.channels);
+    ring_.reset(capacity);
+
+    // Never wait for more than half the ring, or a full ring could not start playing
+    const size_t frame = static_cast<size_t>(format.channels);
+    prebufferSamples_ = samplesPerSecond * std::max(prebufferMs, 0) / 1000 / frame * frame;
+    prebufferSamples_ = std::min(prebufferSamples_, ring_.capacity() / 2 / frame * frame);
+}
+
+const AudioFormat& PlaybackQueue::getFormat() const {
+    return format_;
+}
+
+PlaybackHandle PlaybackQueue::open(const AudioFormat& format) {
+    if (!isValidFormat(format)) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    forgetFinishedLocked();
+
+    const PlaybackHandle handle = nextHandle_++;
+    Stream& stream = streams_[handle];
+    stream.end = written_.load(std::memory_order_relaxed);
+    if (format.sampleRate != format_.sampleRate || format.channels != format_.channels) {
+        stream.converter = std::make_unique<FormatConverter>(format, format_);
+    }
+    openStreams_.fetch_add(1, std::memory_order_release);
+    return handle;
+}
+
+bool PlaybackQueue::write(PlaybackHandle handle, AudioSampleView samples, float gain) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = streams_.find(handle);
+    if (it == streams_.end() || !it->second.open) {
+        return false;
+    }
+
+    if (it->second.converter) {
+        samples = it->second.converter->convert(samples);
+    }
+    it->second.gain = gain;
+    return appendLocked(lock, handle, samples, gain);
+}
+
+void PlaybackQueue::close(PlaybackHandle handle) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = streams_.find(handle);
+    if (it == streams_.end() || !it->second.open) {
+        return;
+    }
+
+    // Drain what the resampler still holds back before the stream ends
+    if (it->second.converter) {
+        AudioSampleView tail = it->second.converter->convert(AudioSampleView(), true);
+        if (!appendLocked(lock, handle, tail, it->second.gain)) {
+            return;
+        }
+        it = streams_.find(handle);
+    }
+
+    it->second.open = false;
+    it->second.converter.reset();
+    openStreams_.fetch_sub(1, std::memory_order_release);
+    changed_.notify_all();
+}
+
+bool PlaybackQueue::wait(PlaybackHandle handle, int timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        auto it = streams_.find(handle);
+        if (it == streams_.end()) {
+            return handle != 0 && handle < nextHandle_;
+        }
+        if (isFinishedLocked(it->second)) {
+            return !it->second.cancelled;
+        }
+
+        auto wakeAt = std::chrono::steady_clock::now() + kPollInterval;
+        if (timeoutMs >= 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            wakeAt = std::min(wakeAt, deadline);
+        }
+        changed_.wait_until(lock, wakeAt);
+    }
+}
+
+bool PlaybackQueue::isActive() const {
+    return openStreams_.load(std::memory_order_acquire) > 0 ||
+           written_.load(std::memory_order_acquire) > read_.load(std::memory_order_acquire);
+}
+
+void PlaybackQueue::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : streams_) {
+            Stream& stream = entry.second;
+            if (isFinishedLocked(stream)) {
+                continue;
+            }
+            if (stream.open) {
+                stream.open = false;
+                openStreams_.fetch_sub(1, std::memory_order_release);
+            }
+            stream.cancelled = true;
+            stream.converter.reset();
+        }
+
+        // The device thread owns the read side of the ring, so it performs the
+        // discard itself on its next render() call
+        flushTarget_.store(written_.load(std::memory_order_relaxed), std::memory_order_release);
+        flushes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    changed_.notify_all();
+}
+
+size_t PlaybackQueue::render(int16_t* out, size_t count) {
+    uint64_t read = read_.load(std::memory_order_relaxed);
+    const uint64_t flushTarget = flushTarget_.load(std::memory_order_acquire);
+    if (flushTarget > read) {
+        ring_.consume(static_cast<size_t>(flushTarget - read));
+        read = flushTarget;
+        read_.store(read, std::memory_order_release);
+        buffering_ = true;
+    }
+
+    const bool streaming = openStreams_.load(std::memory_order_acquire) > 0;
+    const size_t available = ring_.readAvailable();
+    if (buffering_ && available > 0 && (available >= prebufferSamples_ || !streaming)) {
+        buffering_ = false;
+    }
+
+    size_t rendered = 0;
+    if (!buffering_) {
+        rendered = ring_.read(out, std::min(count, available));
+        if (rendered < count) {
+            // Ran dry; collect another prebuffer before resuming
+            buffering_ = true;
+            if (streaming) {
+                underruns_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    std::memset(out + rendered, 0, (count - rendered) * sizeof(int16_t));
+
+    if (rendered > 0) {
+        read_.store(read + rendered, std::memory_order_release);
+        played_.fetch_add(rendered, std::memory_order_relaxed);
+        changed_.notify_all();
+    }
+    return rendered;
+}
+
+PlaybackStats PlaybackQueue::getStats() const {
+    PlaybackStats stats;
+    const uint64_t read = read_.load(std::memory_order_acquire);
+    const uint64_t written = written_.load(std::memory_order_acquire);
+    const uint64_t flushTarget = flushTarget_.load(std::memory_order_acquire);
+    stats.queuedSamples = written - std::max(read, std::min(flushTarget, written));
+    stats.playedSamples = played_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.flushes = flushes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool PlaybackQueue::appendLocked(std::unique_lock<std::mutex>& lock, PlaybackHandle handle,
+                                 AudioSampleView samples, float gain) {
+    const size_t frame = static_cast<size_t>(format_.channels);
+    size_t remaining = samples.size / frame * frame;
+    const int16_t* data = samples.data;
+
+    auto it = streams_.find(handle);
+    if (gain != 1.0f && remaining > 0) {
+        std::vector<int16_t>& scratch = it->second.gainScratch;
+        if (scratch.size() < remaining) {
+            scratch.resize(remaining);
+        }
+        kernels::applyGain(data, scratch.data(), remaining, gain);
+        data = scratch.data();
+    }
+
+    while (remaining > 0) {
+        // Whole frames only, so a flush can never leave the channels misaligned
+        const size_t space = ring_.writeAvailable() / frame * frame;
+        const size_t count = ring_.write(data, std::min(remaining, space));
+        data += count;
+        remaining -= count;
+
+        const uint64_t end = written_.load(std::memory_order_relaxed) + count;
+        written_.store(end, std::memory_order_release);
+        it->second.end = end;
+
+        if (remaining > 0) {
+            // The ring is full; wait for the device to make room. The pending
+            // samples live in this stream's buffers, which only a flush frees.
+            changed_.wait_for(lock, kPollInterval);
+            it = streams_.find(handle);
+            if (it == streams_.end() || it->second.cancelled) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool PlaybackQueue::isFinishedLocked(const Stream& stream) const {
+    return stream.cancelled || (!stream.open && read_.load(std::memory_order_acquire) >= stream.end);
+}
+
+void PlaybackQueue::forgetFinishedLocked() {
+    size_t finished = 0;
+    for (const auto& entry : streams_) {
+        finished += isFinishedLocked(entry.second) ? 1 : 0;
+    }
+
+    // Handles increase monotonically, so the oldest finished streams go first
+    for (auto it = streams_.begin(); it != streams_.end() && finished > kMaxFinishedStreams;) {
+        if (isFinishedLocked(it->second)) {
+            it = streams_.erase(it);
+            --finished;
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace voice_assist
@@ -0,0 +1,203 @@
+#include "resampler.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace voice_assist {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Input frames converted per pass; bounds the history and output planes
+constexpr size_t kChunkFrames = 512;
+// Passband edge as a fraction of the lower Nyquist frequency
+constexpr double kRolloff = 0.92;
+// Kaiser window shape, about 80 dB of stopband attenuation
+constexpr double kKaiserBeta = 8.0;
+
+double besselI0(double x) {
+    // Power series; converges quickly for the arguments a window needs
+    double sum = 1.0;
+    double term = 1.0;
+    const double quarterSquare = x * x / 4.0;
+    for (int k = 1; k < 50 && term > sum * 1e-12; ++k) {
+        term *= quarterSquare / (static_cast<double>(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+Resampler::Resampler(int inputRate, int outputRate, int channels, int zeroCrossings)
+    : inputRate_(inputRate), outputRate_(outputRate), channels_(channels) {
+    if (inputRate <= 0 || outputRate <= 0 || channels <= 0) {
+        throw std::invalid_argument("Resampler rates and channel count must be positive");
+    }
+
+    const int divisor = std::gcd(inputRate, outputRate);
+    up_ = static_cast<size_t>(outputRate / divisor);
+    down_ = static_cast<size_t>(inputRate / divisor);
+
+    // Downsampling narrows the cutoff, which needs proportionally more taps
+    const double ratio = std::min(1.0, static_cast<double>(up_) / down_);
+    const double cutoff = 0.5 * ratio * kRolloff;
+    taps_ = roundUp(static_cast<size_t>(std::ceil(2.0 * std::max(zeroCrossings, 2) / ratio)), 8);
+    delay_ = taps_ / 2 - 1;
+
+    // Phase p interpolates at a fraction p / L past the centre tap
+    bank_.resize(up_ * taps_);
+    const double halfWidth = taps_ / 2.0;
+    const double windowNorm = besselI0(kKaiserBeta);
+    for (size_t phase = 0; phase < up_; ++phase) {
+        float* coefficients = bank_.data() + phase * taps_;
+        const double fraction = static_cast<double>(phase) / up_;
+        double sum = 0.0;
+        for (size_t tap = 0; tap < taps_; ++tap) {
+            const double t = static_cast<double>(tap) - delay_ - fraction;
+            const double x = 2.0 * cutoff * t;
+            const double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+            const double position = std::min(std::fabs(t) / halfWidth, 1.0);
+            const double window = besselI0(kKaiserBeta * std::sqrt(1.0 - position * position)) / windowNorm;
+            const double value = 2.0 * cutoff * sinc * window;
+            coefficients[tap] = static_cast<float>(value);
+            sum += value;
+        }
+        // Unity gain at DC for every phase, so there is no phase-dependent ripple
+        for (size_t tap = 0; tap < taps_; ++tap) {
+            coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+        }
+    }
+
+    const size_t maxChunkOutput = maxOutputFrames(kChunkFrames);
+    history_.resize(channels_);
+    output_.resize(channels_);
+    planes_.resize(channels_);
+    planePointers_.resize(channels_);
+    for (int channel = 0; channel < channels_; ++channel) {
+        history_[channel].resize(taps_ + kChunkFrames);
+        output_[channel].resize(maxChunkOutput);
+        planes_[channel].resize(std::max(kChunkFrames, maxChunkOutput));
+        planePointers_[channel] = planes_[channel].data();
+    }
+
+    reset();
+}
+
+int Resampler::inputRate() const {
+    return inputRate_;
+}
+
+int Resampler::outputRate() const {
+    return outputRate_;
+}
+
+int Resampler::channels() const {
+    return channels_;
+}
+
+size_t Resampler::maxOutputFrames(size_t inputFrames) const {
+    // Up to taps_ frames are buffered, and flush() feeds up to taps_ frames of
+    // silence; one more covers phase rounding
+    const uint64_t frames = static_cast<uint64_t>(2 * taps_ + inputFrames) * up_;
+    return static_cast<size_t>((frames + down_ - 1) / down_) + 1;
+}
+
+size_t Resampler::process(const int16_t* in, size_t inputFrames, int16_t* out) {
+    size_t produced = 0;
+    size_t done = 0;
+    while (done < inputFrames) {
+        const size_t chunk = std::min(inputFrames - done, kChunkFrames);
+        produced += processChunk(in + done * channels_, chunk, out + produced * channels_);
+        done += chunk;
+    }
+    inputFrames_ += inputFrames;
+    return produced;
+}
+
+size_t Resampler::flush(int16_t* out) {
+    // Feed silence until the output covers the input duration, then trim
+    const uint64_t expected = (inputFrames_ * up_ + down_ - 1) / down_;
+    size_t produced = 0;
+    while (outputFrames_ < expected) {
+        produced += processChunk(nullptr, std::min(taps_, kChunkFrames), out + produced * channels_);
+    }
+
+    const size_t excess = static_cast<size_t>(outputFrames_ - expected);
+    produced -= std::min(excess, produced);
+    reset();
+    return produced;
+}
+
+void Resampler::reset() {
+    for (auto& plane : history_) {
+        plane.clear();
+    }
+    phase_ = 0;
+    position_ = 0;
+    // Zero padding so the first output is centred on the first input frame
+    fill_ = delay_;
+    inputFrames_ = 0;
+    outputFrames_ = 0;
+}
+
+size_t Resampler::processChunk(const int16_t* in, size_t frames, int16_t* out) {
+    // Append the chunk to each channel's history; nullptr appends silence
+    if (!in) {
+        for (auto& plane : history_) {
+            std::fill(plane.data() + fill_, plane.data() + fill_ + frames, 0.0f);
+        }
+    } else if (channels_ == 1) {
+        kernels::int16ToFloat(in, history_[0].data() + fill_, frames);
+    } else {
+        kernels::deinterleave(in, planePointers_.data(), channels_, frames);
+        for (int channel = 0; channel < channels_; ++channel) {
+            kernels::int16ToFloat(planes_[channel].data(), history_[channel].data() + fill_, frames);
+        }
+    }
+    fill_ += frames;
+
+    size_t produced = 0;
+    while (position_ + taps_ <= fill_) {
+        const float* coefficients = bank_.data() + phase_ * taps_;
+        for (int channel = 0; channel < channels_; ++channel) {
+            output_[channel][produced] = kernels::dotProduct(coefficients, history_[channel].data() + position_, taps_);
+        }
+        ++produced;
+
+        phase_ += down_;
+        position_ += phase_ / up_;
+        phase_ %= up_;
+    }
+
+    // Slide the unconsumed history to the front; when downsampling the
+    // filter may already have stepped past the end of the buffer
+    const size_t consumed = std::min(position_, fill_);
+    for (auto& plane : history_) {
+        std::memmove(plane.data(), plane.data() + consumed, (fill_ - consumed) * sizeof(float));
+    }
+    fill_ -= consumed;
+    position_ -= consumed;
+
+    if (channels_ == 1) {
+        kernels::floatToInt16(output_[0].data(), out, produced);
+    } else {
+        for (int channel = 0; channel < channels_; ++channel) {
+            kernels::floatToInt16(output_[channel].data(), planes_[channel].data(), produced);
+        }
+        kernels::interleave(planePointers_.data(), out, channels_, produced);
+    }
+
+    outputFrames_ += produced;
+    return produced;
+}
+
+} // namespace voice_assist
@@ -0,0 +1,331 @@
+#include "resilient_voice_recognizer.h"
+#include <algorithm>
+#include <iostream>
+
+namespace voice_assist {
+
+ResilientVoiceRecognizer::ResilientVoiceRecognizer(const VoiceRecognizerConfig& config, Factory factory)
+    : VoiceRecognizer(config), factory_(std::move(factory)), jitter_(std::random_device()()) {
+    // The first engine is built up front so startListening() can use it
+    // straight away; the standby follows on the recovery thread
+    active_ = buildEngine();
+    if (!active_) {
+        ++stats_.failedRebuilds;
+        scheduleRebuild();
+    }
+    recoveryThread_ = std::thread(&ResilientVoiceRecognizer::recoveryLoop, this);
+}
+
+ResilientVoiceRecognizer::~ResilientVoiceRecognizer() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (recoveryThread_.joinable()) {
+        recoveryThread_.join();
+    }
+
+    stopListening();
+    active_.reset();
+    standby_.reset();
+}
+
+bool ResilientVoiceRecognizer::startListening(TranscriptionCallback callback) {
+    // Declared before the lock, so engines that failed to start are
+    // destroyed after it is released
+    std::vector<std::unique_ptr<VoiceRecognizer>> retired;
+    std::lock_guard<std::mutex> control(controlMutex_);
+    if (wantListening_) {
+        return false;
+    }
+
+    callback_ = std::move(callback);
+    wantListening_ = true;
+
+    while (true) {
+        VoiceRecognizer* engine = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(engineMutex_);
+            engine = active_.get();
+        }
+        if (!engine) {
+            break;
+        }
+        if (startEngine(*engine)) {
+            return true;
+        }
+
+        // Fall back to the standby right here; this is the caller's thread,
+        // not an engine's
+        {
+            std::lock_guard<std::mutex> lock(engineMutex_);
+            retired.push_back(std::move(active_));
+            active_ = std::move(standby_);
+            ++stats_.failures;
+            if (active_) {
+                ++stats_.standbySwaps;
+            }
+        }
+        {
+            // Its address may be reused by the next engine built
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            failedEngines_.erase(std::remove(failedEngines_.begin(), failedEngines_.end(), retired.back().get()),
+                                 failedEngines_.end());
+        }
+        wakeRecovery();
+    }
+
+    std::cerr << "No speech recognition engine could be started" << std::endl;
+    wantListening_ = false;
+    return false;
+}
+
+void ResilientVoiceRecognizer::stopListening() {
+    std::lock_guard<std::mutex> control(controlMutex_);
+    if (!wantListening_) {
+        return;
+    }
+    wantListening_ = false;
+
+    // Swaps only happen under the control lock, so the engine stays put
+    VoiceRecognizer* engine = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex_);
+        engine = active_.get();
+    }
+    if (engine) {
+        engine->stopListening();
+    }
+}
+
+bool ResilientVoiceRecognizer::isListening() const {
+    return wantListening_;
+}
+
+bool ResilientVoiceRecognizer::acceptsPushedAudio() const {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    return active_ && active_->acceptsPushedAudio();
+}
+
+void ResilientVoiceRecognizer::processAudio(AudioSampleView samples) {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    if (active_) {
+        active_->processAudio(samples);
+    }
+}
+
+void ResilientVoiceRecognizer::processFeatures(const FeatureMatrix& features, uint64_t firstFrame, size_t count) {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    if (active_) {
+        active_->processFeatures(features, firstFrame, count);
+    }
+}
+
+void ResilientVoiceRecognizer::finalizeUtterance() {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    if (active_) {
+        active_->finalizeUtterance();
+    }
+}
+
+void ResilientVoiceRecognizer::setConfig(const VoiceRecognizerConfig& config) {
+    // Under the control lock no swap can move an engine meanwhile
+    std::lock_guard<std::mutex> control(controlMutex_);
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    config_ = config;
+    if (active_) {
+        active_->setConfig(config);
+    }
+    if (standby_) {
+        standby_->setConfig(config);
+    }
+}
+
+bool ResilientVoiceRecognizer::hasStandby() const {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    return standby_ != nullptr;
+}
+
+RecoveryStats ResilientVoiceRecognizer::getRecoveryStats() const {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    return stats_;
+}
+
+std::unique_ptr<VoiceRecognizer> ResilientVoiceRecognizer::buildEngine() {
+    VoiceRecognizerConfig config;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex_);
+        config = config_;
+    }
+    std::unique_ptr<VoiceRecognizer> engine = factory_ ? factory_(config) : nullptr;
+    if (!engine || !engine->prepare()) {
+        return nullptr;
+    }
+
+    VoiceRecognizer* raw = engine.get();
+    engine->setFailureCallback([this, raw](const std::string& reason) {
+        handleFailure(raw, reason);
+    });
+    return engine;
+}
+
+bool ResilientVoiceRecognizer::startEngine(VoiceRecognizer& engine) {
+    return engine.startListening([this](const std::string& text, bool isFinal) {
+        if (callback_) {
+            callback_(text, isFinal);
+        }
+    });
+}
+
+bool ResilientVoiceRecognizer::needsEngine() const {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    return !active_ || (config_.warmStandby && !standby_);
+}
+
+void ResilientVoiceRecognizer::handleFailure(VoiceRecognizer* engine, const std::string& reason) {
+    // May run on the failing engine's own thread: queue it for the recovery
+    // thread and return
+    std::cerr << "Speech recognition engine failed: " << reason << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (stopping_) {
+            return;
+        }
+        failedEngines_.push_back(engine);
+        wakePending_ = true;
+    }
+    wake_.notify_all();
+}
+
+void ResilientVoiceRecognizer::wakeRecovery() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakePending_ = true;
+    }
+    wake_.notify_all();
+}
+
+void ResilientVoiceRecognizer::recoveryLoop() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (!stopping_) {
+        wakePending_ = false;
+        if (!failedEngines_.empty()) {
+            std::vector<VoiceRecognizer*> failed;
+            failed.swap(failedEngines_);
+            lock.unlock();
+            for (VoiceRecognizer* engine : failed) {
+                replaceFailedEngine(engine);
+            }
+            lock.lock();
+            continue;
+        }
+
+        lock.unlock();
+        const bool needed = needsEngine();
+        const bool due = std::chrono::steady_clock::now() >= nextBuild_;
+        if (needed && due) {
+            rebuildEngine();
+        }
+        lock.lock();
+        if (needed && due) {
+            continue;
+        }
+
+        auto ready = [this]() { return stopping_ || wakePending_; };
+        if (needed) {
+            wake_.wait_until(lock, nextBuild_, ready);
+        } else {
+            wake_.wait(lock, ready);
+        }
+    }
+}
+
+void ResilientVoiceRecognizer::replaceFailedEngine(VoiceRecognizer* failed) {
+    std::unique_ptr<VoiceRecognizer> retired;
+    {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        VoiceRecognizer* promoted = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(engineMutex_);
+            if (failed != active_.get()) {
+                // A standby or an engine already retired
+                return;
+            }
+
+            // From here on captured audio goes to the standby
+            ++stats_.failures;
+            retired = std::move(active_);
+            active_ = std::move(standby_);
+            promoted = active_.get();
+            if (promoted) {
+                ++stats_.standbySwaps;
+            }
+        }
+        if (!promoted) {
+            // Nothing to fall back on; back off in case the engine keeps failing
+            scheduleRebuild();
+        }
+
+        // Start the replacement before tearing down the failed engine
+        if (promoted && wantListening_ && !startEngine(*promoted)) {
+            handleFailure(promoted, "Standby engine could not start listening");
+        }
+    }
+
+    // The failed engine's listener thread may take a while to wind down;
+    // nothing else can reach it any more, so no lock is needed
+    retired->stopListening();
+    retired.reset();
+}
+
+void ResilientVoiceRecognizer::rebuildEngine() {
+    // Building can take seconds; no lock is held meanwhile
+    std::unique_ptr<VoiceRecognizer> engine = buildEngine();
+    if (!engine) {
+        {
+            std::lock_guard<std::mutex> lock(engineMutex_);
+            ++stats_.failedRebuilds;
+        }
+        scheduleRebuild();
+        return;
+    }
+
+    std::lock_guard<std::mutex> control(controlMutex_);
+    VoiceRecognizer* started = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex_);
+        ++stats_.rebuilds;
+        if (!active_) {
+            active_ = std::move(engine);
+            started = active_.get();
+        } else if (!standby_) {
+            standby_ = std::move(engine);
+        }
+    }
+    if (!started) {
+        // A standby only gets built while the active engine runs, so the
+        // engine is healthy again
+        backoffMs_ = 0;
+    }
+
+    if (started && wantListening_ && !startEngine(*started)) {
+        handleFailure(started, "Rebuilt engine could not start listening");
+    }
+}
+
+void ResilientVoiceRecognizer::scheduleRebuild() {
+    int firstMs = 0;
+    int maxMs = 0;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex_);
+        firstMs = std::max(config_.recoveryBackoffMs, 1);
+        maxMs = std::max(config_.maxRecoveryBackoffMs, 1);
+    }
+    backoffMs_ = backoffMs_ == 0 ? firstMs : std::min(backoffMs_ * 2, maxMs);
+    // Jitter keeps many clients from retrying a shared service in lockstep
+    std::uniform_int_distribution<int> delay(backoffMs_ / 2, backoffMs_);
+    nextBuild_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay(jitter_));
+}
+
+} // namespace voice_assist
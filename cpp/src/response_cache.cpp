@@ -0,0 +1,300 @@
+#include "response_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace voice_assist {
+
+namespace {
+
+// Disk layout: a header, then records back to back, each padded to 8 bytes.
+// Records past header.used are ignored, so a record interrupted by a crash
+// is never read.
+constexpr char kMagic[8] = {'V', 'A', 'C', 'A', 'C', 'H', 'E', '1'};
+
+struct DiskHeader {
+    char magic[8];
+    uint64_t used;       // Bytes in use, header included
+    uint64_t reserved[2];
+};
+
+struct RecordHeader {
+    uint64_t keyHigh;
+    uint64_t keyLow;
+    int64_t expiresAt;
+    uint32_t length;     // Response bytes that follow
+    uint32_t reserved;
+};
+
+constexpr size_t kInitialDiskBytes = 1 << 20;
+
+size_t recordSize(size_t length) {
+    return (sizeof(RecordHeader) + length + 7) & ~size_t(7);
+}
+
+int64_t secondsNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool isExpired(int64_t expiresAt, int64_t now) {
+    return expiresAt != 0 && expiresAt <= now;
+}
+
+uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t finalize(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(const ResponseCacheConfig& config)
+    : config_(config) {
+    if (!config_.diskPath.empty() && !openDisk()) {
+        std::cerr << "Response cache: keeping responses in memory only" << std::endl;
+        disk_.close();
+    }
+}
+
+ResponseCache::~ResponseCache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (disk_.isOpen()) {
+        disk_.sync();
+    }
+}
+
+ResponseCache::Key ResponseCache::makeKey(const std::string& request) {
+    // Two independent multiply-rotate lanes over 8-byte words
+    constexpr uint64_t k1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t k2 = 0x4cf5ad432745937fULL;
+    constexpr uint64_t k3 = 0x9e3779b97f4a7c15ULL;
+    constexpr uint64_t k4 = 0xd6e8feb86659fd93ULL;
+
+    const char* data = request.data();
+    const size_t size = request.size();
+    uint64_t a = 0x243f6a8885a308d3ULL ^ size;
+    uint64_t b = 0x13198a2e03707344ULL ^ (size * k3);
+
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, 8);
+        a = rotateLeft(a ^ (word * k1), 31) * k2;
+        b = rotateLeft(b ^ (word * k3), 27) * k4;
+    }
+    if (offset < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + offset, size - offset);
+        a = rotateLeft(a ^ (word * k1), 31) * k2;
+        b = rotateLeft(b ^ (word * k3), 27) * k4;
+    }
+
+    Key key;
+    key.high = finalize(a + b);
+    key.low = finalize(b ^ rotateLeft(a, 17));
+    return key;
+}
+
+bool ResponseCache::lookup(const Key& key, std::string& response) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t now = secondsNow();
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        auto entry = it->second;
+        if (!isExpired(entry->expiresAt, now)) {
+            entries_.splice(entries_.begin(), entries_, entry);
+            response = entry->response;
+            ++stats_.memoryHits;
+            return true;
+        }
+        memoryBytes_ -= entry->response.size();
+        entries_.erase(entry);
+        index_.erase(it);
+        diskIndex_.erase(key);
+        ++stats_.expired;
+        ++stats_.misses;
+        return false;
+    }
+
+    int64_t expiresAt = 0;
+    if (readDiskLocked(key, response, expiresAt)) {
+        if (!isExpired(expiresAt, now)) {
+            insertLocked(key, response, expiresAt);
+            ++stats_.diskHits;
+            return true;
+        }
+        diskIndex_.erase(key);
+        ++stats_.expired;
+    }
+    ++stats_.misses;
+    return false;
+}
+
+void ResponseCache::store(const Key& key, const std::string& response) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t expiresAt = config_.ttlSeconds > 0 ? secondsNow() + config_.ttlSeconds : 0;
+    insertLocked(key, response, expiresAt);
+    appendDiskLocked(key, response, expiresAt);
+    ++stats_.stores;
+}
+
+ResponseCacheStats ResponseCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ResponseCache::insertLocked(const Key& key, const std::string& response, int64_t expiresAt) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        memoryBytes_ -= it->second->response.size();
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+    if (response.size() > config_.maxMemoryBytes || config_.maxEntries == 0) {
+        return;
+    }
+
+    while (!entries_.empty() &&
+           (entries_.size() >= config_.maxEntries || memoryBytes_ + response.size() > config_.maxMemoryBytes)) {
+        memoryBytes_ -= entries_.back().response.size();
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+    entries_.push_front(Entry{key, response, expiresAt});
+    index_[key] = entries_.begin();
+    memoryBytes_ += response.size();
+}
+
+bool ResponseCache::openDisk() {
+    if (!disk_.open(config_.diskPath, MappedFile::Mode::READ_WRITE,
+                    std::min(kInitialDiskBytes, config_.maxDiskBytes))) {
+        return false;
+    }
+    if (disk_.size() < sizeof(DiskHeader) && !disk_.resize(sizeof(DiskHeader))) {
+        return false;
+    }
+
+    DiskHeader header;
+    std::memcpy(&header, disk_.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.used < sizeof(DiskHeader) || header.used > disk_.size()) {
+        // New or unrecognized file: start over
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.used = sizeof(DiskHeader);
+        std::memcpy(disk_.data(), &header, sizeof(header));
+    }
+
+    // Later records for a key supersede earlier ones
+    size_t offset = sizeof(DiskHeader);
+    while (offset + sizeof(RecordHeader) <= header.used) {
+        RecordHeader record;
+        std::memcpy(&record, disk_.data() + offset, sizeof(record));
+        const size_t size = recordSize(record.length);
+        if (size > header.used - offset) {
+            break;
+        }
+        diskIndex_[Key{record.keyHigh, record.keyLow}] = offset;
+        offset += size;
+    }
+    diskUsed_ = offset;
+    return true;
+}
+
+bool ResponseCache::readDiskLocked(const Key& key, std::string& response, int64_t& expiresAt) {
+    auto it = diskIndex_.find(key);
+    if (it == diskIndex_.end()) {
+        return false;
+    }
+    RecordHeader record;
+    std::memcpy(&record, disk_.data() + it->second, sizeof(record));
+    response.assign(reinterpret_cast<const char*>(disk_.data() + it->second + sizeof(record)), record.length);
+    expiresAt = record.expiresAt;
+    return true;
+}
+
+void ResponseCache::appendDiskLocked(const Key& key, const std::string& response, int64_t expiresAt) {
+    if (!disk_.isOpen()) {
+        return;
+    }
+    const size_t size = recordSize(response.size());
+    if (size > config_.maxDiskBytes - std::min(config_.maxDiskBytes, sizeof(DiskHeader))) {
+        return;
+    }
+
+    const size_t capacity = std::max(disk_.size(), config_.maxDiskBytes);
+    if (diskUsed_ + size > capacity) {
+        compactDiskLocked(secondsNow());
+        if (diskUsed_ + size > capacity) {
+            // Still full of live responses: start over
+            diskIndex_.clear();
+            diskUsed_ = sizeof(DiskHeader);
+            reinterpret_cast<DiskHeader*>(disk_.data())->used = diskUsed_;
+        }
+    }
+    if (diskUsed_ + size > disk_.size()) {
+        size_t grown = disk_.size();
+        while (grown < diskUsed_ + size) {
+            grown = std::min(grown * 2, capacity);
+        }
+        if (!disk_.resize(grown)) {
+            std::cerr << "Response cache: disabling " << config_.diskPath << std::endl;
+            disk_.close();
+            diskIndex_.clear();
+            return;
+        }
+    }
+
+    RecordHeader record = {key.high, key.low, expiresAt, static_cast<uint32_t>(response.size()), 0};
+    std::memcpy(disk_.data() + diskUsed_, &record, sizeof(record));
+    std::memcpy(disk_.data() + diskUsed_ + sizeof(record), response.data(), response.size());
+    diskIndex_[key] = diskUsed_;
+    diskUsed_ += size;
+
+    // Publish the record only once it is complete
+    DiskHeader* header = reinterpret_cast<DiskHeader*>(disk_.data());
+    header->used = diskUsed_;
+}
+
+void ResponseCache::compactDiskLocked(int64_t now) {
+    // Records are only ever moved towards the start, so copying them in
+    // file order never overwrites one that is still to be moved
+    std::vector<std::pair<size_t, Key>> live;
+    live.reserve(diskIndex_.size());
+    for (const auto& [key, offset] : diskIndex_) {
+        live.emplace_back(offset, key);
+    }
+    std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    // Until it finishes the file holds no records at all
+    diskIndex_.clear();
+    size_t used = sizeof(DiskHeader);
+    reinterpret_cast<DiskHeader*>(disk_.data())->used = used;
+    for (const auto& [offset, key] : live) {
+        RecordHeader record;
+        std::memcpy(&record, disk_.data() + offset, sizeof(record));
+        if (isExpired(record.expiresAt, now)) {
+            continue;
+        }
+        const size_t size = recordSize(record.length);
+        std::memmove(disk_.data() + used, disk_.data() + offset, size);
+        diskIndex_[key] = used;
+        used += size;
+    }
+    diskUsed_ = used;
+    reinterpret_cast<DiskHeader*>(disk_.data())->used = diskUsed_;
+}
+
+} // namespace voice_assist
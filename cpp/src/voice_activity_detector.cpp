@@ -0,0 +1,121 @@
+#include "voice_activity_detector.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace voice_assist {
+
+namespace {
+
+// Level above the noise floor that maps to a score of 1.0
+constexpr float kScoreRangeDb = 30.0f;
+// Frames quieter than this are never speech, however quiet the room is
+constexpr float kMinSpeechDb = -55.0f;
+// Speech must persist this long before an utterance starts
+constexpr float kOnsetMs = 30.0f;
+// Noise floor time constants: falls quickly, rises slowly, and barely
+// moves while someone is talking
+constexpr float kFloorFallMs = 50.0f;
+constexpr float kFloorRiseMs = 2000.0f;
+constexpr float kFloorRiseSpeakingMs = 10000.0f;
+// The floor starts out as the quietest frame of this stretch
+constexpr float kFloorSeedMs = 300.0f;
+constexpr float kSilenceDb = -96.0f;
+
+float smoothingFactor(float durationMs, float timeConstantMs) {
+    return 1.0f - std::exp(-durationMs / timeConstantMs);
+}
+
+} // namespace
+
+VoiceActivityDetector::VoiceActivityDetector(const VoiceRecognizerConfig& config, int sampleRate, int channels)
+    : config_(config), sampleRate_(std::max(sampleRate, 1)), channels_(std::max(channels, 1)) {
+}
+
+VoiceActivityDetector::Event VoiceActivityDetector::processFrame(AudioSampleView frame) {
+    if (frame.empty()) {
+        return Event::NONE;
+    }
+
+    const double meanSquare = static_cast<double>(kernels::sumSquares(frame.data, frame.size)) / frame.size;
+    const float levelDb = meanSquare > 0.0
+        ? static_cast<float>(10.0 * std::log10(meanSquare / (32768.0 * 32768.0)))
+        : kSilenceDb;
+    const float durationMs = 1000.0f * frame.size / (static_cast<float>(sampleRate_) * channels_);
+
+    return processLevel(levelDb, durationMs);
+}
+
+VoiceActivityDetector::Event VoiceActivityDetector::processLevel(float levelDb, float durationMs) {
+    levelDb = std::max(levelDb, kSilenceDb);
+    updateNoiseFloor(levelDb, durationMs);
+
+    const float score = std::min(std::max((levelDb - noiseFloorDb_) / kScoreRangeDb, 0.0f), 1.0f);
+    const bool speechFrame = score >= config_.speechThreshold && levelDb > kMinSpeechDb;
+
+    if (!speaking_) {
+        onsetMs_ = speechFrame ? onsetMs_ + durationMs : 0.0f;
+        if (onsetMs_ >= kOnsetMs) {
+            speaking_ = true;
+            silenceMs_ = 0.0f;
+            utteranceMs_ = onsetMs_;
+            return Event::SPEECH_START;
+        }
+        return Event::NONE;
+    }
+
+    utteranceMs_ += durationMs;
+    silenceMs_ = speechFrame ? 0.0f : silenceMs_ + durationMs;
+
+    if (config_.maxRecordingTimeMs > 0 && utteranceMs_ >= config_.maxRecordingTimeMs) {
+        reset();
+        return Event::MAX_LENGTH_REACHED;
+    }
+    if (silenceMs_ >= config_.silenceTimeoutMs) {
+        reset();
+        return Event::SPEECH_END;
+    }
+    return Event::NONE;
+}
+
+void VoiceActivityDetector::reset() {
+    speaking_ = false;
+    onsetMs_ = 0.0f;
+    silenceMs_ = 0.0f;
+    utteranceMs_ = 0.0f;
+}
+
+bool VoiceActivityDetector::isSpeaking() const {
+    return speaking_;
+}
+
+float VoiceActivityDetector::getNoiseFloorDb() const {
+    return noiseFloorDb_;
+}
+
+void VoiceActivityDetector::setConfig(const VoiceRecognizerConfig& config) {
+    config_ = config;
+}
+
+const VoiceRecognizerConfig& VoiceActivityDetector::getConfig() const {
+    return config_;
+}
+
+void VoiceActivityDetector::updateNoiseFloor(float levelDb, float durationMs) {
+    if (seedMs_ < kFloorSeedMs) {
+        // Audio that opens mid-word would pin a floor seeded from the first
+        // frame at speech level; speech rarely runs this long without a gap
+        noiseFloorDb_ = noiseFloorValid_ ? std::min(noiseFloorDb_, levelDb) : levelDb;
+        noiseFloorValid_ = true;
+        seedMs_ += durationMs;
+        return;
+    }
+
+    float timeConstant = kFloorFallMs;
+    if (levelDb > noiseFloorDb_) {
+        timeConstant = speaking_ ? kFloorRiseSpeakingMs : kFloorRiseMs;
+    }
+    noiseFloorDb_ += smoothingFactor(durationMs, timeConstant) * (levelDb - noiseFloorDb_);
+}
+
+} // namespace voice_assist
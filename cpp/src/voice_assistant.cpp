@@ -1,14 +1,80 @@
 #include "voice_assistant.h"
+#include "file_audio_manager.h"
 #include <iostream>
 #include <algorithm>
+#include <cctype>
 
 namespace voice_assist {
 
+namespace {
+
+// Intent that interrupts whatever is being said
+const char* const kStopIntent = "stop";
+
+/**
+ * @brief Reads a recording through the file backend, converted and processed like live capture
+ */
+bool loadRecording(const std::string& path, const AudioConfig& captureConfig, std::vector<int16_t>& samples) {
+    AudioConfig fileConfig = captureConfig;
+    fileConfig.backend = AudioBackend::FILE;
+    fileConfig.inputFile = path;
+    fileConfig.outputFile.clear();
+    fileConfig.fileRealTime = false;
+    fileConfig.echoCancellation = false;
+    fileConfig.preRollMs = 0;
+    
+    FileAudioManager reader(fileConfig);
+    if (!reader.startRecording([&samples](AudioSampleView audioData, bool) {
+        samples.insert(samples.end(), audioData.begin(), audioData.end());
+    })) {
+        return false;
+    }
+    reader.waitForInputEnd();
+    reader.stopRecording();
+    return !samples.empty();
+}
+
+/**
+ * @brief Lower-cases and strips punctuation, so a final transcript that only
+ *        differs from a partial one in formatting still counts as the same words
+ */
+std::string normalizeTranscript(const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool pendingSpace = false;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c >= 0x80) {
+            if (pendingSpace && !normalized.empty()) {
+                normalized += ' ';
+            }
+            pendingSpace = false;
+            normalized += static_cast<char>(std::tolower(c));
+        } else if (std::isspace(c)) {
+            pendingSpace = true;
+        }
+    }
+    return normalized;
+}
+
+} // namespace
+
 VoiceAssistant::VoiceAssistant(const VoiceAssistantConfig& config)
-    : config_(config), state_(State::IDLE) {
+    : config_(config) {
 }
 
 VoiceAssistant::~VoiceAssistant() {
+    // Nothing is handed off once the recorder stops, and turns and
+    // requests still queued are dropped rather than started
+    shuttingDown_ = true;
+    if (monitoring_) {
+        audioManager_->stopRecording();
+    }
+    controlWorker_.reset();
+    
+    // Outstanding requests are canceled while the members their callbacks
+    // use still exist
+    llmClient_.reset();
+    
     // Stop any ongoing operations
     if (state_ == State::LISTENING) {
         stopListening();
@@ -18,14 +84,14 @@ VoiceAssistant::~VoiceAssistant() {
 bool VoiceAssistant::initialize() {
     try {
         // Create the audio manager
-        audioManager_ = createAudioManager();
+        audioManager_ = createAudioManager(config_.audio);
         if (!audioManager_) {
             reportError("Failed to create audio manager");
             return false;
         }
         
         // Create the voice recognizer
-        VoiceRecognizerConfig voiceConfig;
+        VoiceRecognizerConfig voiceConfig = config_.recognizer;
         voiceConfig.language = config_.language;
         voiceRecognizer_ = createVoiceRecognizer(voiceConfig);
         if (!voiceRecognizer_) {
@@ -33,12 +99,81 @@ bool VoiceAssistant::initialize() {
             return false;
         }
         
+        // Endpointing runs on the capture stream ahead of the recognizer
+        if (config_.useVoiceActivityDetection) {
+            const AudioFormat& format = audioManager_->getConfig().format;
+            voiceActivityDetector_ = std::make_unique<VoiceActivityDetector>(
+                voiceConfig, format.sampleRate, format.channels);
+        }
+        
         // Create the LLM client
         LlmClientConfig llmConfig;
         llmConfig.apiKey = config_.apiKey;
         llmConfig.model = config_.llmModel;
+        llmConfig.cache = config_.responseCache;
+        llmConfig.endpoints = config_.llmEndpoints;
+        llmConfig.hedgeRequests = config_.hedgeLlmRequests;
         llmClient_ = std::make_unique<LlmClient>(llmConfig);
         
+        // Turn starts and speculative requests are handed over here by the
+        // capture thread, which must not wait for them
+        controlWorker_ = std::make_unique<WorkerPool>(1);
+        
+        // Features are computed once per frame on the capture thread and
+        // shared by the detector, the wake-word spotter and the recognizer.
+        // The history covers the pre-roll so the recognizer can catch up.
+        const AudioFormat& captureFormat = audioManager_->getConfig().format;
+        if (captureFormat.channels == 1) {
+            FeatureConfig featureConfig = config_.features;
+            featureConfig.sampleRate = captureFormat.sampleRate;
+            const size_t historyFrames = static_cast<size_t>(std::max(config_.audio.preRollMs, 0)) / 10 + 100;
+            featureFrontend_ = std::make_unique<FeatureFrontend>(featureConfig, historyFrames);
+        }
+        
+        // The wake-word spotter is the only consumer of capture between turns
+        if (!config_.wakeWordRecordings.empty()) {
+            if (!featureFrontend_) {
+                reportError("Wake-word detection is only supported for mono capture");
+            } else {
+                wakeWordSpotter_ = std::make_unique<WakeWordSpotter>(featureFrontend_->getConfig(),
+                                                                     config_.wakeWordThreshold);
+                for (const std::string& path : config_.wakeWordRecordings) {
+                    std::vector<int16_t> recording;
+                    if (!loadRecording(path, audioManager_->getConfig(), recording) ||
+                        !wakeWordSpotter_->addTemplate(AudioSampleView(recording.data(), recording.size()))) {
+                        reportError("Unusable wake-word recording: " + path);
+                    }
+                }
+                if (wakeWordSpotter_->templateCount() == 0) {
+                    wakeWordSpotter_.reset();
+                }
+            }
+        }
+        
+        // Simple commands are answered without a round trip to the LLM
+        if (!config_.intentRulesFile.empty()) {
+            intentMatcher_ = std::make_unique<IntentMatcher>();
+            if (!intentMatcher_->loadRules(config_.intentRulesFile)) {
+                reportError("Problems loading intent rules: " + config_.intentRulesFile);
+            }
+            if (intentMatcher_->ruleCount() == 0) {
+                intentMatcher_.reset();
+            }
+        }
+        
+        // Keep the microphone open between turns so the pre-roll already holds
+        // the start of the next utterance when listening begins. File input is
+        // only consumed once listening starts, so nothing is skipped, unless a
+        // wake word has to be spotted in it.
+        if (wakeWordSpotter_ ||
+            (config_.audio.preRollMs > 0 && config_.audio.backend != AudioBackend::FILE)) {
+            monitoring_ = startRecorder();
+            if (!monitoring_ && wakeWordSpotter_) {
+                reportError("Failed to start audio recording for wake-word detection");
+                wakeWordSpotter_.reset();
+            }
+        }
+        
         // Add a system message to start the conversation
         conversationHistory_.push_back(Message(
             Message::Role::SYSTEM,
@@ -55,32 +190,55 @@ bool VoiceAssistant::initialize() {
 }
 
 bool VoiceAssistant::startListening() {
-    if (state_ != State::IDLE) {
+    // Claimed up front, so a wake word and a caller cannot both start a turn
+    State expected = State::IDLE;
+    if (!state_.compare_exchange_strong(expected, State::LISTENING)) {
         reportError("Cannot start listening in current state");
         return false;
     }
     
-    // Set up the audio sample callback
-    if (!audioManager_->startRecording([this](const std::vector<int16_t>& audioData, bool isFinal) {
-        // This is where audio processing would happen in a real implementation
-    })) {
+    // The user is taking their turn; do not talk over them
+    stopSpeaking();
+    
+    if (!monitoring_ && !startRecorder()) {
+        state_ = State::IDLE;
         reportError("Failed to start audio recording");
         return false;
     }
     
-    // Set up the transcription callback
-    if (!voiceRecognizer_->startListening([this](const std::string& text, bool isFinal) {
+    // Set up the transcription callback; wake-word turns leave the recognizer
+    // running after the previous one
+    if (!voiceRecognizer_->isListening() &&
+        !voiceRecognizer_->startListening([this](const std::string& text, bool isFinal) {
         // This callback is invoked when transcription is available
-        if (isFinal && !text.empty()) {
+        if (text.empty()) {
+            return;
+        }
+        if (isFinal) {
             handleTranscription(text);
+        } else {
+            handlePartialTranscription(text);
         }
     })) {
         // Clean up if voice recognition fails
-        audioManager_->stopRecording();
+        if (!monitoring_) {
+            audioManager_->stopRecording();
+        }
+        state_ = State::IDLE;
         reportError("Failed to start voice recognition");
         return false;
     }
     
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        stablePartial_.clear();
+        discardSpeculationLocked();
+    }
+    
+    // The capture thread picks the turn up with its next frame
+    turnStarting_ = true;
+    capturing_ = true;
+    
     setState(State::LISTENING);
     return true;
 }
@@ -90,8 +248,17 @@ void VoiceAssistant::stopListening() {
         return;
     }
     
+    capturing_ = false;
     voiceRecognizer_->stopListening();
-    audioManager_->stopRecording();
+    if (!monitoring_) {
+        audioManager_->stopRecording();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        stablePartial_.clear();
+        discardSpeculationLocked();
+    }
     
     setState(State::IDLE);
 }
@@ -102,10 +269,44 @@ void VoiceAssistant::sendTextInput(const std::string& text) {
         return;
     }
     
+    stopSpeaking();
+    
     // Process the text as if it was transcribed
     handleTranscription(text);
 }
 
+void VoiceAssistant::stopSpeaking() {
+    // Whatever is still being generated would only be spoken next
+    LlmRequest request;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        if (speculation_.claimed) {
+            request = std::move(speculation_.request);
+            speculation_ = Speculation();
+        }
+    }
+    request.cancel();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        request = std::move(responseRequest_);
+        responseRequest_ = LlmRequest();
+    }
+    request.cancel();
+    
+    if (audioManager_ && audioManager_->isPlaying()) {
+        audioManager_->flushPlayback();
+    }
+    
+    // A canceled request never calls back to finish the turn
+    if (state_ == State::PROCESSING || state_ == State::RESPONDING) {
+        setState(State::IDLE);
+    }
+}
+
+bool VoiceAssistant::isSpeaking() const {
+    return audioManager_ && audioManager_->isPlaying();
+}
+
 VoiceAssistant::State VoiceAssistant::getState() const {
     return state_;
 }
@@ -137,13 +338,19 @@ void VoiceAssistant::setConfig(const VoiceAssistantConfig& config) {
         LlmClientConfig llmConfig = llmClient_->getConfig();
         llmConfig.apiKey = config_.apiKey;
         llmConfig.model = config_.llmModel;
+        llmConfig.endpoints = config_.llmEndpoints;
+        llmConfig.hedgeRequests = config_.hedgeLlmRequests;
         llmClient_->setConfig(llmConfig);
     }
     
     if (voiceRecognizer_) {
-        VoiceRecognizerConfig voiceConfig = voiceRecognizer_->getConfig();
+        VoiceRecognizerConfig voiceConfig = config_.recognizer;
         voiceConfig.language = config_.language;
         voiceRecognizer_->setConfig(voiceConfig);
+        
+        if (voiceActivityDetector_) {
+            voiceActivityDetector_->setConfig(voiceConfig);
+        }
     }
 }
 
@@ -159,6 +366,10 @@ void VoiceAssistant::setTranscriptionCallback(TranscriptionCallback callback) {
     transcriptionCallback_ = std::move(callback);
 }
 
+void VoiceAssistant::setPartialTranscriptionCallback(PartialTranscriptionCallback callback) {
+    partialTranscriptionCallback_ = std::move(callback);
+}
+
 void VoiceAssistant::setResponseCallback(ResponseCallback callback) {
     responseCallback_ = std::move(callback);
 }
@@ -167,11 +378,40 @@ void VoiceAssistant::setErrorCallback(ErrorCallback callback) {
     errorCallback_ = std::move(callback);
 }
 
+void VoiceAssistant::setVoiceActivityCallback(VoiceActivityCallback callback) {
+    voiceActivityCallback_ = std::move(callback);
+}
+
+void VoiceAssistant::setWakeWordCallback(WakeWordCallback callback) {
+    wakeWordCallback_ = std::move(callback);
+}
+
+void VoiceAssistant::setIntentCallback(IntentCallback callback) {
+    intentCallback_ = std::move(callback);
+}
+
 std::vector<Message> VoiceAssistant::getConversationHistory() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return conversationHistory_;
 }
 
+SpeculationStats VoiceAssistant::getSpeculationStats() const {
+    std::lock_guard<std::mutex> lock(speculationMutex_);
+    return speculationStats_;
+}
+
+ResponseCacheStats VoiceAssistant::getResponseCacheStats() const {
+    return llmClient_ ? llmClient_->getCacheStats() : ResponseCacheStats();
+}
+
+LlmUsageStats VoiceAssistant::getLlmUsageStats() const {
+    return llmClient_ ? llmClient_->getUsageStats() : LlmUsageStats();
+}
+
+std::vector<EndpointStats> VoiceAssistant::getLlmEndpointStats() const {
+    return llmClient_ ? llmClient_->getEndpointStats() : std::vector<EndpointStats>();
+}
+
 void VoiceAssistant::setState(State state) {
     state_ = state;
     
@@ -181,12 +421,210 @@ void VoiceAssistant::setState(State state) {
     }
 }
 
+bool VoiceAssistant::startRecorder() {
+    // The pre-roll starts out empty, so the feature history must too; the
+    // capture thread is not running yet
+    if (featureFrontend_) {
+        featureFrontend_->reset();
+    }
+    return audioManager_->startRecording([this](AudioSampleView audioData, bool isFinal) {
+        handleAudioFrame(audioData, isFinal);
+    });
+}
+
+void VoiceAssistant::handleAudioFrame(AudioSampleView samples, bool) {
+    // Runs on the capture thread. Between turns the frames only fill the
+    // audio manager's pre-roll and feed the wake-word spotter. Features are
+    // computed for every frame all the same, so that the feature history
+    // lines up with the pre-roll when a turn catches up on it.
+    const bool capturing = capturing_;
+    uint64_t firstFrame = 0;
+    size_t frames = 0;
+    if (featureFrontend_) {
+        firstFrame = featureFrontend_->features().frameCount();
+        frames = featureFrontend_->process(samples);
+    }
+    const FeatureMatrix* features = featureFrontend_ ? &featureFrontend_->features() : nullptr;
+    
+    if (!capturing) {
+        for (size_t i = 0; wakeWordSpotter_ && i < frames; ++i) {
+            if (wakeWordSpotter_->processFrame(features->row(firstFrame + i))) {
+                handleWakeWord();
+                break;
+            }
+        }
+        return;
+    }
+    
+    if (config_.speculativeStableMs > 0) {
+        maybeSpeculate();
+    }
+    
+    auto feedRecognizer = [&]() {
+        voiceRecognizer_->processAudio(samples);
+        if (frames > 0) {
+            voiceRecognizer_->processFeatures(*features, firstFrame, frames);
+        }
+    };
+    
+    const bool usePreRoll = config_.audio.preRollMs > 0;
+    auto feedPreRoll = [&]() {
+        const size_t drained = audioManager_->drainPreRoll([this](AudioSampleView history) {
+            voiceRecognizer_->processAudio(history);
+        });
+        // The pre-roll ends where this chunk starts, and the frontend saw all
+        // of it, so its frames are the ones just ahead of this chunk's, as far
+        // back as the history reaches
+        if (features) {
+            const uint64_t wanted = drained / featureFrontend_->hopSamples();
+            const uint64_t start = std::max(firstFrame - std::min<uint64_t>(wanted, firstFrame),
+                                            features->oldestFrame());
+            if (start < firstFrame) {
+                voiceRecognizer_->processFeatures(*features, start, static_cast<size_t>(firstFrame - start));
+            }
+        }
+    };
+    
+    if (turnStarting_.exchange(false)) {
+        if (voiceActivityDetector_) {
+            voiceActivityDetector_->reset();
+        } else if (usePreRoll) {
+            // Speech that began before the recognizer was ready
+            feedPreRoll();
+        }
+    }
+    
+    if (!voiceActivityDetector_) {
+        feedRecognizer();
+        return;
+    }
+    
+    // The detector reuses each frame's level when features are available, so
+    // endpoints land on 10 ms hops; the last event in the chunk wins
+    VoiceActivityDetector::Event event = VoiceActivityDetector::Event::NONE;
+    if (features) {
+        const float hopMs = 1000.0f * featureFrontend_->hopSamples() / featureFrontend_->getConfig().sampleRate;
+        for (size_t i = 0; i < frames; ++i) {
+            const VoiceActivityDetector::Event frameEvent =
+                voiceActivityDetector_->processLevel(features->levelDb(firstFrame + i), hopMs);
+            if (frameEvent != VoiceActivityDetector::Event::NONE) {
+                event = frameEvent;
+            }
+        }
+    } else {
+        event = voiceActivityDetector_->processFrame(samples);
+    }
+    
+    // With a pre-roll the recognizer only hears utterances; the onset the
+    // detector needed before it triggered is recovered from the pre-roll
+    if (usePreRoll && event == VoiceActivityDetector::Event::SPEECH_START) {
+        feedPreRoll();
+    }
+    const bool inUtterance = voiceActivityDetector_->isSpeaking() ||
+                             event == VoiceActivityDetector::Event::SPEECH_END ||
+                             event == VoiceActivityDetector::Event::MAX_LENGTH_REACHED;
+    if (!usePreRoll || inUtterance) {
+        feedRecognizer();
+    }
+    
+    switch (event) {
+        case VoiceActivityDetector::Event::SPEECH_START:
+            // Barge-in: with echo cancellation the detector only hears the
+            // user, so speech during a response interrupts it. Canceling and
+            // flushing playback wait on other threads, so the worker does it.
+            if (config_.audio.echoCancellation) {
+                controlWorker_->post([this]() {
+                    if (!shuttingDown_) {
+                        stopSpeaking();
+                    }
+                });
+            }
+            if (voiceActivityCallback_) {
+                voiceActivityCallback_(true);
+            }
+            break;
+        case VoiceActivityDetector::Event::SPEECH_END:
+        case VoiceActivityDetector::Event::MAX_LENGTH_REACHED:
+            // Finalize right away instead of waiting for the engine's own timeout
+            voiceRecognizer_->finalizeUtterance();
+            if (wakeWordSpotter_) {
+                // One utterance per wake word; go back to spotting
+                capturing_ = false;
+            }
+            if (voiceActivityCallback_) {
+                voiceActivityCallback_(false);
+            }
+            break;
+        case VoiceActivityDetector::Event::NONE:
+            break;
+    }
+}
+
+void VoiceAssistant::handleWakeWord() {
+    // The pre-roll holds the wake phrase itself, which the recognizer must not hear
+    audioManager_->drainPreRoll([](AudioSampleView) {});
+    wakeWordSpotter_->reset();
+    
+    // Starting a turn stops playback and may start the recognizer, which
+    // the capture thread must not wait for. Frames captured meanwhile go to
+    // the pre-roll, which the turn starts from.
+    controlWorker_->post([this]() {
+        startWakeWordTurn();
+    });
+}
+
+void VoiceAssistant::startWakeWordTurn() {
+    if (shuttingDown_) {
+        return;
+    }
+    if (wakeWordCallback_) {
+        wakeWordCallback_();
+    }
+    
+    if (state_ == State::LISTENING) {
+        // The recognizer is still open from the previous wake word
+        stopSpeaking();
+        turnStarting_ = true;
+        capturing_ = true;
+    } else {
+        startListening();
+    }
+}
+
+void VoiceAssistant::handlePartialTranscription(const std::string& text) {
+    if (state_ != State::LISTENING) {
+        return;
+    }
+    
+    if (config_.speculativeStableMs > 0) {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        if (text != stablePartial_) {
+            // The user kept talking or the recognizer revised itself; a
+            // request built from the old words is useless now
+            stablePartial_ = text;
+            stablePartialSince_ = std::chrono::steady_clock::now();
+            discardSpeculationLocked();
+        }
+    }
+    if (partialTranscriptionCallback_) {
+        partialTranscriptionCallback_(text);
+    }
+}
+
 void VoiceAssistant::handleTranscription(const std::string& text) {
+    if (wakeWordSpotter_) {
+        capturing_ = false;
+    }
+    
     // Notify callback
     if (transcriptionCallback_) {
         transcriptionCallback_(text);
     }
     
+    if (handleIntent(text)) {
+        return;
+    }
+    
     // Add to conversation history
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -206,6 +644,42 @@ void VoiceAssistant::handleTranscription(const std::string& text) {
     // Set processing state
     setState(State::PROCESSING);
     
+    // A request sent for the same words while the user was finishing is reused
+    if (claimSpeculation(text)) {
+        return;
+    }
+    requestResponse();
+}
+
+bool VoiceAssistant::handleIntent(const std::string& text) {
+    IntentMatch match;
+    if (!intentMatcher_ || !intentMatcher_->match(text, match)) {
+        return false;
+    }
+    if (intentCallback_ && !intentCallback_(match)) {
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        stablePartial_.clear();
+        discardSpeculationLocked();
+    }
+    
+    if (match.intent == kStopIntent) {
+        stopSpeaking();
+    }
+    
+    // Commands stay out of the conversation history, which is LLM context
+    if (match.reply.empty()) {
+        setState(State::IDLE);
+    } else {
+        respond(match.reply);
+    }
+    return true;
+}
+
+void VoiceAssistant::requestResponse() {
     // Get LLM response
     std::vector<Message> currentHistory;
     {
@@ -213,37 +687,294 @@ void VoiceAssistant::handleTranscription(const std::string& text) {
         currentHistory = conversationHistory_;
     }
     
-    llmClient_->sendConversation(
-        currentHistory,
-        [this](const std::string& response, bool isError) {
-            if (isError) {
-                reportError(response);
-                setState(State::IDLE);
-            } else {
-                handleLlmResponse(response);
+    LlmRequest request;
+    if (!config_.streamResponses) {
+        request = llmClient_->sendConversation(
+            currentHistory,
+            [this](const std::string& response, bool isError) {
+                if (isError) {
+                    reportError(response);
+                    setState(State::IDLE);
+                } else {
+                    handleLlmResponse(response);
+                }
+            }
+        );
+    } else {
+        // Both callbacks run in order on the request's thread
+        auto reply = std::make_shared<StreamedReply>();
+        request = llmClient_->streamConversation(
+            currentHistory,
+            [this, reply](const std::string& delta) {
+                handleResponseDelta(*reply, delta);
+            },
+            [this, reply](const std::string& response, bool isError) {
+                if (isError) {
+                    reportError(response);
+                    setState(State::IDLE);
+                } else {
+                    handleLlmResponse(response, reply->spoken);
+                }
             }
+        );
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    responseRequest_ = std::move(request);
+}
+
+void VoiceAssistant::handleResponseDelta(StreamedReply& reply, const std::string& delta) {
+    if (reply.text.empty()) {
+        setState(State::RESPONDING);
+    }
+    reply.text += delta;
+    if (!config_.useTextToSpeech) {
+        return;
+    }
+    
+    // Speak every complete sentence straight away; a terminator only counts
+    // once the following whitespace has arrived, so "3.5" stays whole
+    size_t end = std::string::npos;
+    for (size_t i = reply.text.size(); i-- > reply.spoken + 1;) {
+        const char c = reply.text[i - 1];
+        if ((c == '.' || c == '!' || c == '?' || c == '\n') &&
+            std::isspace(static_cast<unsigned char>(reply.text[i]))) {
+            end = i;
+            break;
         }
-    );
+    }
+    if (end != std::string::npos) {
+        audioManager_->speakAsync(reply.text.substr(reply.spoken, end - reply.spoken), config_.ttsVoice);
+        reply.spoken = end;
+    }
 }
 
-void VoiceAssistant::handleLlmResponse(const std::string& response) {
+void VoiceAssistant::maybeSpeculate() {
+    // Runs on the capture thread, which ticks steadily while the user talks.
+    // It only claims the stable partial; building and sending the request
+    // is left to the control worker.
+    uint64_t id = 0;
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        const auto now = std::chrono::steady_clock::now();
+        if (stablePartial_.empty() || speculation_.id != 0 || state_ != State::LISTENING ||
+            now - stablePartialSince_ < std::chrono::milliseconds(config_.speculativeStableMs)) {
+            return;
+        }
+        // A command will be answered locally; don't pay for a request
+        IntentMatch match;
+        if (intentMatcher_ && intentMatcher_->match(stablePartial_, match)) {
+            return;
+        }
+        
+        id = nextSpeculationId_++;
+        speculation_ = Speculation();
+        speculation_.id = id;
+        speculation_.text = stablePartial_;
+        speculation_.sentAt = now;  // Handed over; the worker sends it within moments
+        if (config_.streamResponses) {
+            speculation_.reply = std::make_shared<StreamedReply>();
+        }
+        ++speculationStats_.dispatched;
+        text = stablePartial_;
+    }
+    
+    controlWorker_->post([this, id, text]() {
+        dispatchSpeculation(id, text);
+    });
+}
+
+void VoiceAssistant::dispatchSpeculation(uint64_t id, const std::string& text) {
+    if (shuttingDown_) {
+        return;
+    }
+    std::vector<Message> history;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        if (speculation_.id != id) {
+            // Discarded before it was sent
+            return;
+        }
+        std::lock_guard<std::mutex> historyLock(mutex_);
+        history = conversationHistory_;
+    }
+    history.push_back(Message(Message::Role::USER, text));
+    
+    auto onResponse = [this, id](const std::string& response, bool isError) {
+        handleSpeculativeResponse(id, response, isError);
+    };
+    LlmRequest request;
+    if (!config_.streamResponses) {
+        request = llmClient_->sendConversation(history, onResponse);
+    } else {
+        // Streamed like an ordinary request, so a claimed speculation
+        // starts speaking as soon as its first sentence is in
+        request = llmClient_->streamConversation(
+            history,
+            [this, id](const std::string& delta) {
+                handleSpeculativeDelta(id, delta);
+            },
+            onResponse
+        );
+    }
+    
+    // Discarded while it was being sent; nobody will cancel it later
+    std::lock_guard<std::mutex> lock(speculationMutex_);
+    if (speculation_.id == id) {
+        speculation_.request = std::move(request);
+    } else {
+        request.cancel();
+    }
+}
+
+void VoiceAssistant::handleSpeculativeDelta(uint64_t id, const std::string& delta) {
+    std::shared_ptr<StreamedReply> reply;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        if (speculation_.id != id) {
+            return;
+        }
+        if (!speculation_.claimed) {
+            // The transcript may still change; nothing is spoken yet
+            speculation_.buffered += delta;
+            return;
+        }
+        reply = speculation_.reply;
+    }
+    
+    // Waits for claimSpeculation() to replay what was buffered
+    std::lock_guard<std::mutex> lock(reply->mutex);
+    handleResponseDelta(*reply, delta);
+}
+
+void VoiceAssistant::handleSpeculativeResponse(uint64_t id, const std::string& response, bool isError) {
+    std::string claimedResponse;
+    std::shared_ptr<StreamedReply> reply;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        if (speculation_.id != id) {
+            // Superseded by a later partial or a different final transcript
+            return;
+        }
+        speculation_.done = true;
+        speculation_.doneAt = std::chrono::steady_clock::now();
+        speculation_.isError = isError;
+        if (!speculation_.claimed) {
+            speculation_.response = response;
+            return;
+        }
+        claimedResponse = response;
+        reply = std::move(speculation_.reply);
+        speculation_ = Speculation();
+    }
+    
+    size_t spoken = 0;
+    bool started = false;
+    if (reply) {
+        std::lock_guard<std::mutex> lock(reply->mutex);
+        spoken = reply->spoken;
+        started = !reply->text.empty();
+    }
+    
+    // The final transcript is already waiting for this response. A failed
+    // speculation is retried like an ordinary request rather than reported,
+    // unless part of its reply has been delivered.
+    if (isError && !started) {
+        requestResponse();
+    } else if (isError) {
+        reportError(claimedResponse);
+        setState(State::IDLE);
+    } else {
+        handleLlmResponse(claimedResponse, spoken);
+    }
+}
+
+bool VoiceAssistant::claimSpeculation(const std::string& text) {
+    std::string response;
+    std::string buffered;
+    std::shared_ptr<StreamedReply> reply;
+    std::unique_lock<std::mutex> replyLock;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex_);
+        stablePartial_.clear();
+        if (speculation_.id == 0) {
+            return false;
+        }
+        if (normalizeTranscript(speculation_.text) != normalizeTranscript(text) ||
+            (speculation_.done && speculation_.isError)) {
+            discardSpeculationLocked();
+            return false;
+        }
+        
+        const auto now = std::chrono::steady_clock::now();
+        const auto overlapEnd = speculation_.done ? std::min(now, speculation_.doneAt) : now;
+        ++speculationStats_.hits;
+        speculationStats_.savedMs +=
+            std::chrono::duration<double, std::milli>(overlapEnd - speculation_.sentAt).count();
+        
+        if (!speculation_.done) {
+            speculation_.claimed = true;
+            if (!speculation_.reply) {
+                return true;
+            }
+            // Locked before the claim is visible, so deltas arriving from
+            // now on queue up behind the replay
+            reply = speculation_.reply;
+            replyLock = std::unique_lock<std::mutex>(reply->mutex);
+            buffered.swap(speculation_.buffered);
+        } else {
+            response = std::move(speculation_.response);
+            speculation_ = Speculation();
+        }
+    }
+    
+    if (reply) {
+        if (!buffered.empty()) {
+            handleResponseDelta(*reply, buffered);
+        }
+        return true;
+    }
+    handleLlmResponse(response);
+    return true;
+}
+
+void VoiceAssistant::discardSpeculationLocked() {
+    // Cancel the request so it stops holding a connection and a slot
+    if (speculation_.id != 0 && !speculation_.claimed) {
+        ++speculationStats_.misses;
+        speculation_.request.cancel();
+        speculation_ = Speculation();
+    }
+}
+
+void VoiceAssistant::handleLlmResponse(const std::string& response, size_t spokenChars) {
     // Add to conversation history
     {
         std::lock_guard<std::mutex> lock(mutex_);
         conversationHistory_.push_back(Message(Message::Role::ASSISTANT, response));
     }
     
+    respond(response, spokenChars);
+}
+
+void VoiceAssistant::respond(const std::string& response, size_t spokenChars) {
     // Notify callback
     if (responseCallback_) {
         responseCallback_(response);
     }
     
-    // Set responding state
-    setState(State::RESPONDING);
+    // Set responding state; a streamed reply is there already
+    if (state_ != State::RESPONDING) {
+        setState(State::RESPONDING);
+    }
     
-    // Text-to-speech if enabled
-    if (config_.useTextToSpeech) {
-        audioManager_->speak(response, config_.ttsVoice);
+    // Text-to-speech if enabled; playback carries on in the background and
+    // is interrupted by the next turn. A streamed reply only has its last
+    // sentence left.
+    if (config_.useTextToSpeech && spokenChars < response.size() &&
+        response.find_first_not_of(" \t\r\n", spokenChars) != std::string::npos) {
+        audioManager_->speakAsync(response.substr(spokenChars), config_.ttsVoice);
     }
     
     // Return to idle state
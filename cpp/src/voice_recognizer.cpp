@@ -1,4 +1,6 @@
 #include "voice_recognizer.h"
+#include "resilient_voice_recognizer.h"
+#include <algorithm>
 #include <iostream>
 
 #ifdef _WIN32
@@ -16,20 +18,61 @@
 
 namespace voice_assist {
 
+namespace {
+
+/**
+ * @brief Longest run of whole words two hypotheses start with
+ */
+std::string commonWordPrefix(const std::string& a, const std::string& b) {
+    const size_t limit = std::min(a.size(), b.size());
+    size_t end = 0;
+    size_t i = 0;
+    while (i < limit && a[i] == b[i]) {
+        ++i;
+        const bool wordEnds = i == a.size() || a[i] == ' ';
+        const bool otherEnds = i == b.size() || b[i] == ' ';
+        if (wordEnds && otherEnds) {
+            end = i;
+        }
+    }
+    return a.substr(0, end);
+}
+
+} // namespace
+
 VoiceRecognizer::VoiceRecognizer(const VoiceRecognizerConfig& config)
     : config_(config), listening_(false) {
 }
 
 VoiceRecognizer::~VoiceRecognizer() {
-    if (listening_) {
-        stopListening();
-    }
+    // Derived classes stop themselves; the pure virtual cannot be called from here
+}
+
+bool VoiceRecognizer::prepare() {
+    return true;
 }
 
 bool VoiceRecognizer::isListening() const {
     return listening_;
 }
 
+bool VoiceRecognizer::acceptsPushedAudio() const {
+    return false;
+}
+
+void VoiceRecognizer::processAudio(AudioSampleView) {
+}
+
+void VoiceRecognizer::processFeatures(const FeatureMatrix&, uint64_t, size_t) {
+}
+
+void VoiceRecognizer::finalizeUtterance() {
+}
+
+void VoiceRecognizer::setFailureCallback(FailureCallback callback) {
+    failureCallback_ = std::move(callback);
+}
+
 void VoiceRecognizer::setConfig(const VoiceRecognizerConfig& config) {
     config_ = config;
 }
@@ -38,6 +81,51 @@ const VoiceRecognizerConfig& VoiceRecognizer::getConfig() const {
     return config_;
 }
 
+void VoiceRecognizer::reportHypothesis(const std::string& hypothesis) {
+    const std::string stable = commonWordPrefix(hypothesis, lastHypothesis_);
+    lastHypothesis_ = hypothesis;
+    if (config_.partialIntervalMs <= 0 || !callback_) {
+        return;
+    }
+    if (!stable.empty()) {
+        // Supersedes any prefix still held back
+        pendingPartial_ = stable == lastPartial_ ? std::string() : stable;
+    }
+    if (pendingPartial_.empty()) {
+        return;
+    }
+    
+    const auto now = std::chrono::steady_clock::now();
+    if (!lastPartial_.empty() && now - lastPartialTime_ < std::chrono::milliseconds(config_.partialIntervalMs)) {
+        return;
+    }
+    lastPartial_.swap(pendingPartial_);
+    pendingPartial_.clear();
+    lastPartialTime_ = now;
+    callback_(lastPartial_, false);
+}
+
+void VoiceRecognizer::reportFailure(const std::string& reason) {
+    if (failureCallback_) {
+        failureCallback_(reason);
+    } else {
+        std::cerr << "Speech recognition failed: " << reason << std::endl;
+    }
+}
+
+void VoiceRecognizer::reportFinal(const std::string& text) {
+    // A prefix the interval held back still goes out, ahead of the final text
+    if (callback_ && !pendingPartial_.empty()) {
+        callback_(pendingPartial_, false);
+    }
+    lastHypothesis_.clear();
+    lastPartial_.clear();
+    pendingPartial_.clear();
+    if (callback_) {
+        callback_(text, true);
+    }
+}
+
 #ifdef _WIN32
 // Windows implementation
 
@@ -48,9 +136,7 @@ public:
           recognizer_(nullptr),
           reco_context_(nullptr),
           grammar_(nullptr),
-          com_initialized_(false),
-          retry_count_(0),
-          max_retry_count_(3) {
+          com_initialized_(false) {
         // Windows-specific initialization
         HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
         if (SUCCEEDED(hr)) {
@@ -75,10 +161,15 @@ public:
 
         callback_ = std::move(callback);
 
-        // Reset retry counter when starting fresh
-        retry_count_ = 0;
+        // A prepared engine only needs activating
+        if (!recognizer_ && !createEngine()) {
+            return false;
+        }
+        return activate();
+    }
 
-        return initializeRecognizer();
+    bool prepare() override {
+        return recognizer_ || createEngine();
     }
 
     void stopListening() override {
@@ -97,68 +188,86 @@ public:
     }
 
 private:
-    bool initializeRecognizer() {
+    /**
+     * @brief Creates the engine with dictation loaded but inactive
+     *
+     * Failures are left to the caller; a ResilientVoiceRecognizer retries
+     * them in the background instead of blocking here.
+     */
+    bool createEngine() {
         cleanupRecognizer();
 
         HRESULT hr = recognizer_.CoCreateInstance(CLSID_SpInprocRecognizer);
         if (FAILED(hr)) {
             std::cerr << "Failed to create recognizer instance: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to create recognizer instance");
+            return fail("Failed to create recognizer instance");
         }
 
         CComPtr<ISpAudio> audio;
         hr = SpCreateDefaultObjectFromCategoryId(SPCAT_AUDIOIN, &audio);
         if (FAILED(hr)) {
             std::cerr << "Failed to create audio input: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to create audio input");
+            return fail("Failed to create audio input");
         }
 
         hr = recognizer_->SetInput(audio, TRUE);
         if (FAILED(hr)) {
             std::cerr << "Failed to set audio input: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to set audio input");
+            return fail("Failed to set audio input");
         }
 
         hr = recognizer_->CreateRecoContext(&reco_context_);
         if (FAILED(hr)) {
             std::cerr << "Failed to create recognition context: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to create recognition context");
+            return fail("Failed to create recognition context");
+        }
+
+        // Hypotheses feed the partial results
+        const ULONGLONG interest = SPFEI(SPEI_RECOGNITION) | SPFEI(SPEI_HYPOTHESIS) | SPFEI(SPEI_END_SR_STREAM);
+        hr = reco_context_->SetInterest(interest, interest);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to set event interest: " << std::hex << hr << std::endl;
+            return fail("Failed to set event interest");
         }
 
         hr = reco_context_->SetNotifyWin32Event();
         if (FAILED(hr)) {
             std::cerr << "Failed to set notify event: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to set notify event");
+            return fail("Failed to set notify event");
         }
 
         h_event_ = reco_context_->GetNotifyEventHandle();
         if (h_event_ == INVALID_HANDLE_VALUE) {
             std::cerr << "Failed to get notify event handle" << std::endl;
-            return tryRecovery("Failed to get notify event handle");
+            return fail("Failed to get notify event handle");
         }
 
         hr = reco_context_->CreateGrammar(0, &grammar_);
         if (FAILED(hr)) {
             std::cerr << "Failed to create grammar: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to create grammar");
+            return fail("Failed to create grammar");
         }
 
         hr = grammar_->LoadDictation(nullptr, SPLO_STATIC);
         if (FAILED(hr)) {
             std::cerr << "Failed to load dictation: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to load dictation");
+            return fail("Failed to load dictation");
         }
 
-        hr = grammar_->SetDictationState(SPRS_ACTIVE);
+        return true;
+    }
+
+    bool activate() {
+        HRESULT hr = grammar_->SetDictationState(SPRS_ACTIVE);
         if (FAILED(hr)) {
             std::cerr << "Failed to activate dictation: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to activate dictation");
+            return fail("Failed to activate dictation");
         }
 
         hr = recognizer_->SetRecoState(SPRST_ACTIVE);
         if (FAILED(hr)) {
             std::cerr << "Failed to set recognizer state: " << std::hex << hr << std::endl;
-            return tryRecovery("Failed to set recognizer state");
+            return fail("Failed to set recognizer state");
         }
 
         listening_ = true;
@@ -168,21 +277,10 @@ private:
         return true;
     }
 
-    bool tryRecovery(const std::string& errorMsg) {
+    bool fail(const std::string& errorMsg) {
         cleanupRecognizer();
-
-        if (retry_count_ < max_retry_count_) {
-            retry_count_++;
-            std::cerr << "Retrying speech recognition setup (attempt " << retry_count_
-                      << " of " << max_retry_count_ << ")" << std::endl;
-
-            // Small delay before retry
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            return initializeRecognizer();
-        } else {
-            std::cerr << "Error: " << errorMsg << " - Max retries exceeded" << std::endl;
-            return false;
-        }
+        std::cerr << "Error: " << errorMsg << std::endl;
+        return false;
     }
 
     void cleanupRecognizer() {
@@ -211,46 +309,53 @@ private:
                 continue;
             } else if (wait_result != WAIT_OBJECT_0) {
                 std::cerr << "Error waiting for recognition events: " << GetLastError() << std::endl;
+                reportFailure("Lost the recognition event handle");
                 break;
             }
 
             CSpEvent event;
             while (reco_context_ && SUCCEEDED(event.GetFrom(reco_context_)) && event.eEventId != SPEI_FALSE_RECOGNITION) {
-                if (event.eEventId == SPEI_RECOGNITION) {
-                    const auto* phrase = event.RecoResult();
-                    if (phrase) {
-                        wchar_t* text = nullptr;
-                        if (SUCCEEDED(phrase->GetText(SP_GETWHOLEPHRASE, SP_GETWHOLEPHRASE, TRUE, &text, nullptr))) {
-                            std::wstring wstr(text);
-                            CoTaskMemFree(text);
-                            int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
-                            std::string str(size_needed, 0);
-                            WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &str[0], size_needed, NULL, NULL);
-                            if (callback_) {
-                                callback_(str);
-                            }
+                if (event.eEventId == SPEI_RECOGNITION || event.eEventId == SPEI_HYPOTHESIS) {
+                    std::string text;
+                    if (getPhraseText(event.RecoResult(), text)) {
+                        if (event.eEventId == SPEI_RECOGNITION) {
+                            reportFinal(text);
+                        } else {
+                            reportHypothesis(text);
                         }
                     }
                 } else if (event.eEventId == SPEI_END_SR_STREAM) {
-                    // Recognition stream has ended
+                    // Recognition stream has ended. Rebuilding the engine
+                    // from its own thread would leave recognition dark for
+                    // the duration, so the owner swaps in a standby instead.
                     if (listening_) {
-                        // If we're still supposed to be listening, restart recognition
-                        std::cout << "Recognition stream ended, restarting..." << std::endl;
-                        initializeRecognizer();
+                        reportFailure("Recognition stream ended");
+                        return;
                     }
                 }
             }
         }
     }
 
+    static bool getPhraseText(ISpRecoResult* phrase, std::string& out) {
+        wchar_t* text = nullptr;
+        if (!phrase || FAILED(phrase->GetText(SP_GETWHOLEPHRASE, SP_GETWHOLEPHRASE, TRUE, &text, nullptr))) {
+            return false;
+        }
+        std::wstring wstr(text);
+        CoTaskMemFree(text);
+        int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
+        out.assign(size_needed, 0);
+        WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &out[0], size_needed, NULL, NULL);
+        return true;
+    }
+
     CComPtr<ISpRecognizer> recognizer_;
     CComPtr<ISpRecoContext> reco_context_;
     CComPtr<ISpRecoGrammar> grammar_;
     HANDLE h_event_ = INVALID_HANDLE_VALUE;
     std::thread listener_thread_;
     bool com_initialized_;
-    int retry_count_;
-    int max_retry_count_;
 };
 
 #elif __APPLE__
@@ -351,7 +456,9 @@ private:
 
 #endif
 
-std::unique_ptr<VoiceRecognizer> createVoiceRecognizer(const VoiceRecognizerConfig& config) {
+namespace {
+
+std::unique_ptr<VoiceRecognizer> createPlatformVoiceRecognizer(const VoiceRecognizerConfig& config) {
 #ifdef _WIN32
     return std::make_unique<WindowsVoiceRecognizer>(config);
 #elif __APPLE__
@@ -361,4 +468,13 @@ std::unique_ptr<VoiceRecognizer> createVoiceRecognizer(const VoiceRecognizerConf
 #endif
 }
 
+} // namespace
+
+std::unique_ptr<VoiceRecognizer> createVoiceRecognizer(const VoiceRecognizerConfig& config) {
+    if (!config.recoverFailures) {
+        return createPlatformVoiceRecognizer(config);
+    }
+    return std::make_unique<ResilientVoiceRecognizer>(config, createPlatformVoiceRecognizer);
+}
+
 } // namespace voice_assist
@@ -0,0 +1,230 @@
+#include "wake_word_spotter.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace voice_assist {
+
+namespace {
+
+// Feature mean time constant, in frames; long enough to span a phrase
+constexpr float kMeanFrames = 100.0f;
+// Template frames more than 30 dB below the loudest are trimmed off the ends
+constexpr float kTrimLogRange = 6.9f;
+// Bands more than 25 dB below a frame's strongest are clamped, so background
+// noise in the gaps between formants does not dominate the distance
+constexpr float kBandLogRange = 5.76f;
+constexpr size_t kMinTemplateFrames = 20;
+constexpr size_t kMaxTemplateFrames = 200;
+constexpr float kInfiniteCost = std::numeric_limits<float>::max() / 4;
+
+/**
+ * @brief Subtracts the running mean and the frame's overall level, then scales to unit length
+ *
+ * Without the level term every loud frame would look alike and only the
+ * spectral shape is left to tell phrases apart.
+ */
+void normalizeFrame(const float* features, size_t bands, float* mean, bool& meanValid, float* out) {
+    const float alpha = 1.0f / kMeanFrames;
+    const float floor = *std::max_element(features, features + bands) - kBandLogRange;
+    float level = 0.0f;
+    for (size_t i = 0; i < bands; ++i) {
+        const float value = std::max(features[i], floor);
+        mean[i] = meanValid ? mean[i] + alpha * (value - mean[i]) : value;
+        out[i] = value - mean[i];
+        level += out[i];
+    }
+    meanValid = true;
+
+    level /= bands;
+    for (size_t i = 0; i < bands; ++i) {
+        out[i] -= level;
+    }
+
+    const float norm = std::sqrt(kernels::dotProduct(out, out, bands));
+    const float scale = norm > 1e-6f ? 1.0f / norm : 0.0f;
+    for (size_t i = 0; i < bands; ++i) {
+        out[i] *= scale;
+    }
+}
+
+float loudness(const float* features, size_t bands) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < bands; ++i) {
+        sum += features[i];
+    }
+    return sum / bands;
+}
+
+FeatureConfig logMelOnly(FeatureConfig config) {
+    config.cepstra = 0;
+    return config;
+}
+
+} // namespace
+
+WakeWordSpotter::WakeWordSpotter(const FeatureConfig& features, float threshold)
+    : features_(logMelOnly(features)), frontend_(features_, 1), threshold_(threshold) {
+    mean_.resize(frontend_.bands());
+    normalized_.resize(frontend_.bands());
+}
+
+bool WakeWordSpotter::addTemplate(AudioSampleView recording) {
+    const size_t bands = frontend_.bands();
+
+    // Run the same pipeline as the live stream, from a fresh state
+    FeatureFrontend frontend(features_, 1);
+    AlignedBuffer<float> mean(bands);
+    bool meanValid = false;
+    std::vector<float> frames;
+    std::vector<float> levels;
+    frontend.process(recording, [&](const float* features) {
+        levels.push_back(loudness(features, bands));
+        frames.resize(frames.size() + bands);
+        normalizeFrame(features, bands, mean.data(), meanValid, frames.data() + frames.size() - bands);
+    });
+    if (levels.empty()) {
+        return false;
+    }
+
+    // Keep the span from the first to the last loud frame
+    const float loudest = *std::max_element(levels.begin(), levels.end());
+    size_t first = 0;
+    size_t last = levels.size();
+    while (first < last && levels[first] < loudest - kTrimLogRange) {
+        ++first;
+    }
+    while (last > first && levels[last - 1] < loudest - kTrimLogRange) {
+        --last;
+    }
+    last = std::min(last, first + kMaxTemplateFrames);
+    if (last - first < kMinTemplateFrames) {
+        return false;
+    }
+
+    Template entry;
+    entry.length = last - first;
+    entry.frames.resize(entry.length * bands);
+    std::copy(frames.begin() + first * bands, frames.begin() + last * bands, entry.frames.data());
+    entry.cost.resize(entry.length);
+    entry.nextCost.resize(entry.length);
+    entry.pathLength.resize(entry.length);
+    entry.nextPathLength.resize(entry.length);
+    templates_.push_back(std::move(entry));
+
+    resetPaths();
+    return true;
+}
+
+size_t WakeWordSpotter::templateCount() const {
+    return templates_.size();
+}
+
+bool WakeWordSpotter::process(AudioSampleView samples) {
+    float best = 2.0f;
+    bool detected = false;
+    if (templates_.empty()) {
+        lastScore_ = best;
+        return false;
+    }
+
+    frontend_.process(samples, [&](const float* features) {
+        detected = processFrame(features) || detected;
+        best = std::min(best, lastScore_);
+    });
+    lastScore_ = best;
+    return detected;
+}
+
+void WakeWordSpotter::reset() {
+    frontend_.reset();
+    resetPaths();
+    refractoryFrames_ = 0;
+}
+
+float WakeWordSpotter::getLastScore() const {
+    return lastScore_;
+}
+
+void WakeWordSpotter::setThreshold(float threshold) {
+    threshold_ = threshold;
+}
+
+float WakeWordSpotter::getThreshold() const {
+    return threshold_;
+}
+
+bool WakeWordSpotter::processFrame(const float* logMel) {
+    lastScore_ = 2.0f;
+    if (templates_.empty()) {
+        return false;
+    }
+
+    const size_t bands = frontend_.bands();
+    float* x = normalized_.data();
+    normalizeFrame(logMel, bands, mean_.data(), meanValid_, x);
+
+    float best = 2.0f;
+    size_t longest = 0;
+    for (Template& entry : templates_) {
+        const size_t length = entry.length;
+        const float* frames = entry.frames.data();
+        float* cost = entry.cost.data();
+        float* next = entry.nextCost.data();
+        uint32_t* pathLength = entry.pathLength.data();
+        uint32_t* nextLength = entry.nextPathLength.data();
+
+        for (size_t j = 0; j < length; ++j) {
+            const float distance = 1.0f - kernels::dotProduct(x, frames + j * bands, bands);
+
+            // A path may start on any input frame; otherwise the template
+            // holds, or advances by one or two frames. Predecessors are
+            // compared by average cost so skipping frames is not rewarded.
+            // A fresh start averages this frame's distance alone, so the
+            // first template frame holds while its path matches better.
+            float from = j == 0 ? 0.0f : kInfiniteCost;
+            uint32_t fromLength = j == 0 ? 0 : 1;
+            float fromAverage = j == 0 ? distance : kInfiniteCost;
+            for (size_t step = 0; step <= 2 && step <= j; ++step) {
+                const float average = cost[j - step] / pathLength[j - step];
+                if (average < fromAverage) {
+                    from = cost[j - step];
+                    fromLength = pathLength[j - step];
+                    fromAverage = average;
+                }
+            }
+            next[j] = from + distance;
+            nextLength[j] = fromLength + 1;
+        }
+        entry.cost.swap(entry.nextCost);
+        entry.pathLength.swap(entry.nextPathLength);
+
+        const float score = entry.cost[length - 1] / entry.pathLength[length - 1];
+        best = std::min(best, score);
+        longest = std::max(longest, length);
+    }
+
+    lastScore_ = best;
+    if (refractoryFrames_ > 0) {
+        --refractoryFrames_;
+        return false;
+    }
+    if (best >= threshold_) {
+        return false;
+    }
+
+    // One phrase must not fire again while its tail still matches
+    refractoryFrames_ = longest;
+    resetPaths();
+    return true;
+}
+
+void WakeWordSpotter::resetPaths() {
+    for (Template& entry : templates_) {
+        std::fill(entry.cost.begin(), entry.cost.end(), kInfiniteCost);
+        std::fill(entry.pathLength.begin(), entry.pathLength.end(), 1u);
+    }
+}
+
+} // namespace voice_assist
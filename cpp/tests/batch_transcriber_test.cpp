@@ -0,0 +1,74 @@
+// BatchTranscriber with engines that cannot transcribe recorded audio
+
+#include "batch_transcriber.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace voice_assist;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    failures += ok ? 0 : 1;
+}
+
+/**
+ * @brief Writes one second of a quiet tone as raw PCM in the default format
+ */
+void writeRecording(const fs::path& path) {
+    const AudioFormat format;
+    std::vector<int16_t> samples(static_cast<size_t>(format.sampleRate) * format.channels);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<int16_t>(i % 40 < 20 ? 1000 : -1000);
+    }
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(samples.data()), static_cast<std::streamsize>(samples.size() * 2));
+}
+
+void testPlatformEngineFailsEveryFile() {
+    const fs::path directory = fs::temp_directory_path() / "batch_transcriber_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    for (const char* name : {"a.raw", "b.raw", "c.raw"}) {
+        writeRecording(directory / name);
+    }
+
+    const std::vector<std::string> files = BatchTranscriber::collectInputs(directory.string());
+    check(files.size() == 3, "platform engine: finds the recordings");
+
+    // The platform engines listen to a microphone or are placeholders
+    BatchConfig config;
+    config.workers = 2;
+    BatchTranscriber transcriber(config);
+    std::vector<BatchResult> results;
+    const size_t succeeded = transcriber.run(files, [&results](const BatchResult& result) {
+        results.push_back(result);
+    });
+
+    check(succeeded == 0, "platform engine: no file counts as transcribed");
+    check(results.size() == files.size(), "platform engine: every file gets a result");
+    bool allFailed = true;
+    for (const BatchResult& result : results) {
+        allFailed = allFailed && !result.ok && !result.error.empty() && result.text.empty();
+    }
+    check(allFailed, "platform engine: every result carries an error and no text");
+
+    fs::remove_all(directory);
+}
+
+} // namespace
+
+int main() {
+    testPlatformEngineFailsEveryFile();
+    return failures == 0 ? 0 : 1;
+}
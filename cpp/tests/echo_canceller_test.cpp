@@ -0,0 +1,97 @@
+// Convergence of EchoCanceller on echo paths with realistic delay and gain
+
+#include "echo_canceller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace voice_assist;
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+constexpr size_t kBlock = 160;  // 10 ms, as the capture thread delivers it
+
+struct EchoPath {
+    int delayMs;
+    float gain;
+    int doubleTalkStartMs;  // Near-end tone for two seconds from here; -1 for none
+};
+
+/**
+ * @brief Runs white far-end noise through a delayed, attenuated echo path
+ * @return Echo return loss enhancement over the last second, in dB
+ */
+double measureErle(const EchoPath& path, int seconds) {
+    EchoCanceller canceller(kSampleRate, 200);
+    std::mt19937 random(1);
+    std::normal_distribution<float> speech(0.0f, 3000.0f);
+    std::normal_distribution<float> noise(0.0f, 10.0f);
+
+    const size_t total = static_cast<size_t>(kSampleRate) * seconds;
+    const size_t delay = static_cast<size_t>(kSampleRate) * path.delayMs / 1000;
+    const size_t talkStart = path.doubleTalkStartMs < 0 ? total
+        : static_cast<size_t>(kSampleRate) * path.doubleTalkStartMs / 1000;
+    const size_t talkEnd = talkStart + 2 * kSampleRate;
+
+    std::vector<float> far(total);
+    for (float& sample : far) {
+        sample = std::max(-32767.0f, std::min(32767.0f, speech(random)));
+    }
+
+    double echoEnergy = 0.0;
+    double residualEnergy = 0.0;
+    int16_t farBlock[kBlock];
+    int16_t nearBlock[kBlock];
+    int16_t outBlock[kBlock];
+    float talk[kBlock];
+    for (size_t position = 0; position + kBlock <= total; position += kBlock) {
+        for (size_t i = 0; i < kBlock; ++i) {
+            const size_t n = position + i;
+            talk[i] = n >= talkStart && n < talkEnd ? 4000.0f * std::sin(0.05f * static_cast<float>(n)) : 0.0f;
+            const float echo = n >= delay ? path.gain * far[n - delay] : 0.0f;
+            farBlock[i] = static_cast<int16_t>(far[n]);
+            nearBlock[i] = static_cast<int16_t>(std::max(-32767.0f, std::min(32767.0f, echo + noise(random) + talk[i])));
+        }
+        canceller.pushFarEnd(farBlock, kBlock);
+        canceller.process(nearBlock, outBlock, kBlock);
+
+        if (position >= total - kSampleRate) {
+            for (size_t i = 0; i < kBlock; ++i) {
+                const double echo = nearBlock[i] - talk[i];
+                const double residual = outBlock[i] - talk[i];
+                echoEnergy += echo * echo;
+                residualEnergy += residual * residual;
+            }
+        }
+    }
+    return 10.0 * std::log10(echoEnergy / std::max(residualEnergy, 1.0));
+}
+
+} // namespace
+
+int main() {
+    const EchoPath paths[] = {
+        {50, 0.4f, -1},    // Laptop speaker into its own microphone
+        {50, 0.5f, -1},
+        {13, 0.3f, -1},
+        {50, 1.5f, -1},    // Echo louder than the far end
+        {50, 0.4f, 0},     // Near-end speech before the path is known
+        {50, 0.4f, 5000},  // Near-end speech once it is known
+    };
+    constexpr double kMinErle = 20.0;
+
+    int failures = 0;
+    for (const EchoPath& path : paths) {
+        const double erle = measureErle(path, 12);
+        const bool ok = erle > kMinErle;
+        std::cout << (ok ? "ok   " : "FAIL ") << path.delayMs << " ms, gain " << path.gain << ", double talk at "
+                  << path.doubleTalkStartMs << " ms: ERLE " << erle << " dB" << std::endl;
+        failures += ok ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
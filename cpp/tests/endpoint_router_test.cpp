@@ -0,0 +1,94 @@
+// EndpointRouter choices after latency and failure reports
+
+#include "endpoint_router.h"
+
+#include <iostream>
+#include <string>
+
+using namespace voice_assist;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    failures += ok ? 0 : 1;
+}
+
+EndpointRouter::EndpointPtr find(EndpointRouter& router, const std::string& url) {
+    // Untried endpoints are handed out first, so each comes up within one round
+    for (size_t i = 0; i < router.size(); ++i) {
+        EndpointRouter::EndpointPtr endpoint = router.choose();
+        if (endpoint && EndpointRouter::baseUrl(endpoint) == url) {
+            return endpoint;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Counts how often url is chosen out of count requests
+ */
+int chosen(EndpointRouter& router, const std::string& url, int count) {
+    int times = 0;
+    for (int i = 0; i < count; ++i) {
+        EndpointRouter::EndpointPtr endpoint = router.choose();
+        times += endpoint && EndpointRouter::baseUrl(endpoint) == url ? 1 : 0;
+    }
+    return times;
+}
+
+void testUntriedGoFirst() {
+    EndpointRouter router({"https://a", "https://b"});
+    EndpointRouter::EndpointPtr a = find(router, "https://a");
+    router.reportLatency(a, 50.0);
+    router.reportResult(a, false, true);
+    check(chosen(router, "https://b", 1) == 1, "untried: is chosen over a fast measured endpoint");
+}
+
+void testHealthyBeatsNeverAnswered() {
+    EndpointRouter router({"https://healthy", "https://dead"});
+    EndpointRouter::EndpointPtr healthy = find(router, "https://healthy");
+    EndpointRouter::EndpointPtr dead = find(router, "https://dead");
+    check(healthy && dead, "never answered: both endpoints are handed out");
+
+    router.reportLatency(healthy, 300.0);
+    router.reportResult(healthy, false, true);
+    router.reportResult(dead, true, false);
+    check(chosen(router, "https://healthy", 20) == 20, "never answered: a slow healthy endpoint wins after one failure");
+
+    // With nothing measured at all the failed endpoint still loses
+    EndpointRouter unmeasured({"https://ok", "https://failed"});
+    EndpointRouter::EndpointPtr ok = find(unmeasured, "https://ok");
+    EndpointRouter::EndpointPtr failed = find(unmeasured, "https://failed");
+    unmeasured.reportResult(ok, false, true);
+    unmeasured.reportResult(failed, true, false);
+    check(chosen(unmeasured, "https://ok", 20) == 20, "never answered: loses when no latency is known");
+}
+
+void testFaultyCoolsDown() {
+    EndpointRouter router({"https://fast", "https://slow"});
+    EndpointRouter::EndpointPtr fast = find(router, "https://fast");
+    EndpointRouter::EndpointPtr slow = find(router, "https://slow");
+    router.reportLatency(fast, 50.0);
+    router.reportResult(fast, false, true);
+    router.reportLatency(slow, 400.0);
+    router.reportResult(slow, false, true);
+    check(chosen(router, "https://fast", 10) == 10, "cooldown: the faster endpoint is preferred");
+
+    for (int i = 0; i < 3; ++i) {
+        router.reportResult(fast, true, false);
+    }
+    check(chosen(router, "https://slow", 10) == 10, "cooldown: repeated failures take an endpoint out of rotation");
+    check(router.choose(slow) == nullptr, "cooldown: no hedge goes to a cooling endpoint");
+}
+
+} // namespace
+
+int main() {
+    testUntriedGoFirst();
+    testHealthyBeatsNeverAnswered();
+    testFaultyCoolsDown();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// FormatConverter output when a stream arrives in uneven chunks instead of one block
+
+#include "format_converter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace voice_assist;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    failures += ok ? 0 : 1;
+}
+
+/**
+ * @brief A second of interleaved audio: a tone per channel plus a slow sweep
+ */
+std::vector<int16_t> makeSignal(const AudioFormat& format) {
+    const double pi = 3.14159265358979323846;
+    const size_t frames = static_cast<size_t>(format.sampleRate);
+    std::vector<int16_t> samples(frames * format.channels);
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(i) / format.sampleRate;
+        for (int c = 0; c < format.channels; ++c) {
+            const double tone = std::sin(2.0 * pi * (300.0 + 200.0 * c) * t);
+            const double sweep = std::sin(2.0 * pi * (50.0 + 1500.0 * t) * t);
+            samples[i * format.channels + c] = static_cast<int16_t>(9000.0 * tone + 6000.0 * sweep);
+        }
+    }
+    return samples;
+}
+
+std::vector<int16_t> convertWhole(const AudioFormat& from, const AudioFormat& to, const std::vector<int16_t>& input) {
+    FormatConverter converter(from, to);
+    const AudioSampleView output = converter.convert(AudioSampleView(input.data(), input.size()), true);
+    return std::vector<int16_t>(output.begin(), output.end());
+}
+
+/**
+ * @brief Converts input in chunks cycling through frameCounts, flushing with the last one
+ */
+std::vector<int16_t> convertChunked(const AudioFormat& from, const AudioFormat& to, const std::vector<int16_t>& input,
+                                    const std::vector<size_t>& frameCounts) {
+    FormatConverter converter(from, to);
+    std::vector<int16_t> result;
+    const size_t channels = static_cast<size_t>(from.channels);
+    size_t position = 0;
+    for (size_t i = 0; position < input.size(); ++i) {
+        const size_t count = std::min(frameCounts[i % frameCounts.size()] * channels, input.size() - position);
+        const bool last = position + count >= input.size();
+        const AudioSampleView output = converter.convert(AudioSampleView(input.data() + position, count), last);
+        result.insert(result.end(), output.begin(), output.end());
+        position += count;
+    }
+    return result;
+}
+
+std::string describe(const AudioFormat& from, const AudioFormat& to) {
+    return std::to_string(from.sampleRate) + "/" + std::to_string(from.channels) + " -> " +
+           std::to_string(to.sampleRate) + "/" + std::to_string(to.channels);
+}
+
+void testChunkedMatchesWhole(const AudioFormat& from, const AudioFormat& to) {
+    const std::vector<int16_t> input = makeSignal(from);
+    const std::vector<int16_t> whole = convertWhole(from, to, input);
+    const std::string name = describe(from, to);
+
+    // Expected length of one second, give or take the rounding of the last frame
+    const long expected = static_cast<long>(to.sampleRate) * to.channels;
+    check(std::labs(static_cast<long>(whole.size()) - expected) <= to.channels,
+          name + ": one block covers the input duration");
+
+    // Single frames, odd sizes and chunks longer than the filter
+    const std::vector<std::vector<size_t>> patterns = {
+        {1},
+        {7, 160, 33, 1023, 2, 480},
+        {4096, 3, 5},
+    };
+    for (const std::vector<size_t>& pattern : patterns) {
+        const std::vector<int16_t> chunked = convertChunked(from, to, input, pattern);
+        size_t mismatch = 0;
+        while (mismatch < chunked.size() && mismatch < whole.size() && chunked[mismatch] == whole[mismatch]) {
+            ++mismatch;
+        }
+        const bool same = chunked.size() == whole.size() && mismatch == whole.size();
+        check(same, name + ": chunks of " + std::to_string(pattern.front()) + "... frames match one block" +
+                        (same ? "" : " (first difference at sample " + std::to_string(mismatch) + ")"));
+    }
+}
+
+void testReuseAfterFlush() {
+    const AudioFormat from{44100, 1, 16};
+    const AudioFormat to{16000, 1, 16};
+    const std::vector<int16_t> input = makeSignal(from);
+    const std::vector<int16_t> whole = convertWhole(from, to, input);
+
+    // A flush resets the converter, so a second stream starts from scratch
+    FormatConverter converter(from, to);
+    converter.convert(AudioSampleView(input.data(), input.size() / 3), true);
+    const AudioSampleView second = converter.convert(AudioSampleView(input.data(), input.size()), true);
+    check(std::vector<int16_t>(second.begin(), second.end()) == whole, "flush: the next stream is unaffected");
+}
+
+} // namespace
+
+int main() {
+    testChunkedMatchesWhole({48000, 2, 16}, {16000, 1, 16});
+    testChunkedMatchesWhole({44100, 1, 16}, {16000, 1, 16});
+    testChunkedMatchesWhole({16000, 1, 16}, {48000, 2, 16});
+    testChunkedMatchesWhole({22050, 2, 16}, {44100, 2, 16});
+    testChunkedMatchesWhole({16000, 1, 16}, {16000, 2, 16});
+    testReuseAfterFlush();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+// IntentMatcher phrase matching, number slots and transcripts that must not match
+
+#include "intent_matcher.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace voice_assist;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    failures += ok ? 0 : 1;
+}
+
+/**
+ * @brief Intent matched by text, or an empty string
+ */
+std::string intentOf(const IntentMatcher& matcher, const std::string& text) {
+    IntentMatch match;
+    return matcher.match(text, match) ? match.intent : std::string();
+}
+
+IntentMatcher commands() {
+    IntentMatcher matcher;
+    matcher.addRule("stop", "(stop|cancel|never mind) [please]");
+    matcher.addRule("timer", "set [a] timer for {amount:number} {unit}", "Timer set for {amount} {unit}.");
+    matcher.addRule("remind", "remind me to {task:text}", "I'll remind you to {task}.");
+    matcher.addRule("play", "play {song}");
+    matcher.addRule("silence", "play nothing");
+    matcher.addRule("first", "hello (there|again)");
+    return matcher;
+}
+
+void testPhrases() {
+    IntentMatcher matcher = commands();
+    check(matcher.ruleCount() == 6, "phrases: every rule compiles");
+    check(intentOf(matcher, "stop") == "stop", "phrases: a single word");
+    check(intentOf(matcher, "Cancel, please!") == "stop", "phrases: case and punctuation are ignored");
+    check(intentOf(matcher, "never mind") == "stop", "phrases: a multi-word alternative");
+    check(intentOf(matcher, "play nothing") == "silence", "phrases: literal words beat a slot");
+    check(!matcher.addRule("second", "hello there"), "phrases: a rule the earlier ones cover is rejected");
+    check(matcher.addRule("third", "hello (there|you)") && intentOf(matcher, "hello there") == "first" &&
+              intentOf(matcher, "hello you") == "third",
+          "phrases: the earlier rule wins a tie");
+
+    IntentMatch match;
+    check(matcher.match("play yesterday", match) && match.slot("song") == "yesterday", "phrases: a word slot");
+    check(matcher.match("remind me to buy more milk", match) && match.slot("task") == "buy more milk" &&
+              match.reply == "I'll remind you to buy more milk.",
+          "phrases: a text slot fills the reply");
+}
+
+void testNumbers() {
+    const IntentMatcher matcher = commands();
+    const struct {
+        const char* text;
+        const char* amount;
+    } cases[] = {
+        {"set a timer for 90 seconds", "90"},
+        {"set timer for five minutes", "5"},
+        {"set a timer for twenty five minutes", "25"},
+        {"set a timer for a hundred seconds", "100"},
+        {"set a timer for two hundred and five seconds", "205"},
+        {"set a timer for one thousand two hundred seconds", "1200"},
+    };
+    for (const auto& c : cases) {
+        IntentMatch match;
+        const bool ok = matcher.match(c.text, match) && match.intent == "timer" && match.slot("amount") == c.amount;
+        check(ok, std::string("numbers: \"") + c.text + "\" reads " + c.amount);
+    }
+
+    IntentMatch match;
+    check(matcher.match("set a timer for twenty five minutes", match) && match.reply == "Timer set for 25 minutes.",
+          "numbers: the reply carries digits");
+}
+
+void testNonMatches() {
+    const IntentMatcher matcher = commands();
+    const char* const texts[] = {
+        "",
+        "stop it now",                              // The whole transcript must match
+        "please stop",
+        "set a timer for five five minutes",        // Not one number
+        "set a timer for twenty fifteen minutes",
+        "set a timer for many minutes",
+        "set a timer for minutes",
+        "remind me to",                             // A text slot needs a word
+        "what is the weather like",
+    };
+    for (const char* text : texts) {
+        check(intentOf(matcher, text).empty(), std::string("non-matches: \"") + text + "\"");
+    }
+}
+
+void testRulesFile() {
+    const std::string path = "intent_matcher_test.rules";
+    {
+        std::ofstream file(path);
+        file << "# Comment\n"
+             << "\n"
+             << "time: what time is it => It's {time}.\n"
+             << "broken: turn (up\n"
+             << "volume: turn it (up|down)\n";
+    }
+    IntentMatcher matcher;
+    check(!matcher.loadRules(path), "rules file: a malformed line is reported");
+    check(matcher.ruleCount() == 2, "rules file: the other rules still load");
+
+    IntentMatch match;
+    check(matcher.match("What time is it?", match) && match.reply.rfind("It's ", 0) == 0 &&
+              match.reply.find("{time}") == std::string::npos,
+          "rules file: built-ins are filled in");
+    check(intentOf(matcher, "turn it down") == "volume", "rules file: alternatives are expanded");
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    testPhrases();
+    testNumbers();
+    testNonMatches();
+    testRulesFile();
+    return failures == 0 ? 0 : 1;
+}
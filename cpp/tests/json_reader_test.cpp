@@ -0,0 +1,198 @@
+// Round trips through JsonWriter and JsonReader, and JsonReader on corrupted input
+
+#include "json_reader.h"
+#include "json_writer.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace voice_assist;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    failures += ok ? 0 : 1;
+}
+
+/**
+ * @brief Random text with control characters, quotes, backslashes and multi-byte UTF-8
+ */
+std::string randomText(std::mt19937& random) {
+    std::string text;
+    const int length = static_cast<int>(random() % 80);
+    for (int i = 0; i < length; ++i) {
+        switch (random() % 10) {
+            case 0: text += static_cast<char>(random() % 32); break;
+            case 1: text += random() % 2 ? '"' : '\\'; break;
+            case 2: text += "\xc3\xa9"; break;               // é
+            case 3: text += "\xf0\x9f\x98\x80"; break;       // U+1F600, a surrogate pair when escaped
+            default: text += static_cast<char>(32 + random() % 95); break;
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Reads a whole document, unescaping every string and skipping everything else
+ */
+bool walk(JsonReader& reader) {
+    std::string text;
+    switch (reader.peek()) {
+        case JsonReader::Type::OBJECT:
+            if (!reader.beginObject()) {
+                return false;
+            }
+            while (reader.nextKey(text)) {
+                if (!walk(reader)) {
+                    return false;
+                }
+            }
+            return !reader.failed();
+        case JsonReader::Type::ARRAY:
+            if (!reader.beginArray()) {
+                return false;
+            }
+            while (reader.nextElement()) {
+                if (!walk(reader)) {
+                    return false;
+                }
+            }
+            return !reader.failed();
+        case JsonReader::Type::STRING:
+            return reader.readString(text);
+        case JsonReader::Type::INVALID:
+            return false;
+        default:
+            return reader.skipValue();
+    }
+}
+
+bool accepts(const std::string& json, bool skip) {
+    JsonReader reader(json.data(), json.size());
+    const bool read = skip ? reader.skipValue() : walk(reader);
+    return read && reader.atEnd();
+}
+
+bool domAccepts(const std::string& json) {
+    return !nlohmann::json::parse(json, nullptr, false).is_discarded();
+}
+
+void testStringRoundTrip() {
+    std::mt19937 random(1);
+    int writerMismatches = 0;
+    int readerMismatches = 0;
+    for (int i = 0; i < 20000; ++i) {
+        const std::string text = randomText(random);
+
+        std::string written;
+        JsonWriter(written).beginObject().key("content").value(text).endObject();
+        const nlohmann::json dom = nlohmann::json::parse(written, nullptr, false);
+        if (dom.is_discarded() || dom.value("content", std::string()) != text) {
+            ++writerMismatches;
+        }
+
+        // Both as written and with everything beyond ASCII escaped
+        for (const std::string& json : {written, nlohmann::json{{"content", text}}.dump(-1, ' ', true)}) {
+            JsonReader reader(json.data(), json.size());
+            std::string key;
+            std::string read;
+            const bool ok = reader.beginObject() && reader.nextKey(key) && reader.readString(read)
+                && !reader.nextKey(key) && reader.atEnd();
+            if (!ok || key != "content" || read != text) {
+                ++readerMismatches;
+            }
+        }
+    }
+    check(writerMismatches == 0, "round trip: written strings parse back, " + std::to_string(writerMismatches) + " mismatches");
+    check(readerMismatches == 0, "round trip: read strings match, " + std::to_string(readerMismatches) + " mismatches");
+}
+
+void testNumberRoundTrip() {
+    std::mt19937 random(2);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    std::uniform_int_distribution<int64_t> integers(-999999999999999999, 999999999999999999);
+    int mismatches = 0;
+    for (int i = 0; i < 10000; ++i) {
+        const double number = real(random) * std::pow(10.0, static_cast<int>(random() % 40) - 20);
+        const float single = static_cast<float>(number);
+        const int64_t integer = integers(random);
+
+        std::string written;
+        JsonWriter(written).beginArray().value(number).value(single).value(integer).endArray();
+        const nlohmann::json dom = nlohmann::json::parse(written, nullptr, false);
+        if (dom.is_discarded() || dom[0].get<double>() != number || dom[1].get<float>() != single) {
+            ++mismatches;
+            continue;
+        }
+
+        JsonReader reader(written.data(), written.size());
+        int64_t read = 0;
+        const bool ok = reader.beginArray() && reader.nextElement() && reader.skipValue() && reader.nextElement()
+            && reader.skipValue() && reader.nextElement() && reader.readInteger(read) && !reader.nextElement()
+            && reader.atEnd();
+        if (!ok || read != integer) {
+            ++mismatches;
+        }
+    }
+    check(mismatches == 0, "round trip: numbers read back exactly, " + std::to_string(mismatches) + " mismatches");
+
+    const std::string tooLong = "-1000000000000000000";
+    JsonReader reader(tooLong.data(), tooLong.size());
+    int64_t read = 0;
+    check(!reader.readInteger(read), "round trip: integers of 19 digits are left to the DOM");
+}
+
+void testCorruptInput() {
+    // ASCII only, so corrupting it with ASCII bytes cannot make invalid
+    // UTF-8, which the reader passes through unchecked
+    const std::string body = R"({"id":"chatcmpl-1","choices":[{"index":0,"message":{"role":"assistant",)"
+        R"("content":"Hi \"there\" \\ \u00e9\ud83d\ude00 \/ end"},"finish_reason":"stop"}],)"
+        R"("usage":{"prompt_tokens":12,"completion_tokens":5},"extra":[1,-2.5e3,0.5E-2,{"a":"}]\""},true,false,null]})";
+    check(accepts(body, true) && accepts(body, false), "corrupt input: the intact body is accepted");
+
+    // Every proper prefix is incomplete
+    int truncatedAccepted = 0;
+    for (size_t length = 0; length < body.size(); ++length) {
+        const std::string truncated = body.substr(0, length);
+        truncatedAccepted += accepts(truncated, true) ? 1 : 0;
+        truncatedAccepted += accepts(truncated, false) ? 1 : 0;
+    }
+    check(truncatedAccepted == 0, "corrupt input: " + std::to_string(truncatedAccepted) + " truncations accepted");
+
+    std::mt19937 random(3);
+    int wronglyAccepted = 0;
+    int disagreements = 0;
+    for (int i = 0; i < 100000; ++i) {
+        std::string corrupted = body;
+        const int edits = 1 + static_cast<int>(random() % 3);
+        for (int e = 0; e < edits; ++e) {
+            corrupted[random() % corrupted.size()] = static_cast<char>(random() % 128);
+        }
+        const bool skipped = accepts(corrupted, true);
+        const bool walked = accepts(corrupted, false);
+        wronglyAccepted += (skipped || walked) && !domAccepts(corrupted) ? 1 : 0;
+        disagreements += skipped != walked ? 1 : 0;
+    }
+    check(wronglyAccepted == 0, "corrupt input: " + std::to_string(wronglyAccepted) + " invalid documents accepted");
+    check(disagreements == 0, "corrupt input: skipping and reading disagree on " + std::to_string(disagreements));
+
+    const std::string deep = std::string(100000, '[') + std::string(100000, ']');
+    check(!accepts(deep, true), "corrupt input: deep nesting is rejected without overflowing the stack");
+}
+
+} // namespace
+
+int main() {
+    testStringRoundTrip();
+    testNumberRoundTrip();
+    testCorruptInput();
+    return failures == 0 ? 0 : 1;
+}
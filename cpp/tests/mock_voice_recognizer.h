@@ -0,0 +1,201 @@
+#ifndef MOCK_VOICE_RECOGNIZER_H
+#define MOCK_VOICE_RECOGNIZER_H
+
+#include "resilient_voice_recognizer.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace voice_assist {
+
+class MockVoiceRecognizer;
+
+/**
+ * @brief Builds MockVoiceRecognizer engines and injects faults into them
+ *
+ * Keeps track of the engines alive, in the order they were built, and of
+ * when each build was attempted. All methods are thread-safe.
+ */
+class MockEngineFactory {
+public:
+    /**
+     * @brief Factory for ResilientVoiceRecognizer; this object must outlive it
+     */
+    ResilientVoiceRecognizer::Factory factory();
+
+    void failBuilds(int count);       // The next count builds return nullptr
+    void failPrepares(int count);     // The next count engines fail prepare()
+    void failStarts(int count);       // The next count startListening() calls fail
+
+    /**
+     * @brief Engine number index in build order, if it is still alive
+     */
+    MockVoiceRecognizer* engine(int index);
+
+    int built() const;
+    std::vector<std::chrono::steady_clock::time_point> buildAttempts() const;
+
+private:
+    friend class MockVoiceRecognizer;
+
+    mutable std::mutex mutex_;
+    std::vector<MockVoiceRecognizer*> engines_;  // Null once destroyed
+    std::vector<std::chrono::steady_clock::time_point> attempts_;
+    int buildFailures_ = 0;
+    int prepareFailures_ = 0;
+    int startFailures_ = 0;
+
+    bool consume(int& counter) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (counter == 0) {
+            return false;
+        }
+        --counter;
+        return true;
+    }
+};
+
+/**
+ * @brief Recognizer engine driven by the test instead of by speech
+ */
+class MockVoiceRecognizer : public VoiceRecognizer {
+public:
+    MockVoiceRecognizer(const VoiceRecognizerConfig& config, MockEngineFactory& factory, size_t index)
+        : VoiceRecognizer(config), factory_(factory), index_(index) {
+    }
+
+    ~MockVoiceRecognizer() override {
+        std::lock_guard<std::mutex> lock(factory_.mutex_);
+        factory_.engines_[index_] = nullptr;
+    }
+
+    bool prepare() override {
+        return !factory_.consume(factory_.prepareFailures_);
+    }
+
+    bool startListening(TranscriptionCallback callback) override {
+        if (factory_.consume(factory_.startFailures_)) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            callback_ = std::move(callback);
+        }
+        active_ = true;
+        return true;
+    }
+
+    void stopListening() override {
+        const int delayMs = stopDelayMs_;
+        if (delayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        }
+        active_ = false;
+    }
+
+    bool isListening() const override {
+        return active_;
+    }
+
+    bool acceptsPushedAudio() const override {
+        return true;
+    }
+
+    void processAudio(AudioSampleView) override {
+        frames_ += 1;
+    }
+
+    void setConfig(const VoiceRecognizerConfig& config) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        VoiceRecognizer::setConfig(config);
+    }
+
+    std::string language() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_.language;
+    }
+
+    /**
+     * @brief Reports a failure, as an engine's listener thread would
+     */
+    void fail(const std::string& reason) {
+        reportFailure(reason);
+    }
+
+    /**
+     * @brief Delivers a final transcript
+     */
+    void say(const std::string& text) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reportFinal(text);
+    }
+
+    void setStopDelay(int delayMs) {
+        stopDelayMs_ = delayMs;
+    }
+
+    int frames() const {
+        return frames_;
+    }
+
+private:
+    MockEngineFactory& factory_;
+    size_t index_;
+    mutable std::mutex mutex_;  // Guards config_ and callback_
+    std::atomic<bool> active_{false};
+    std::atomic<int> stopDelayMs_{0};
+    std::atomic<int> frames_{0};
+};
+
+inline ResilientVoiceRecognizer::Factory MockEngineFactory::factory() {
+    return [this](const VoiceRecognizerConfig& config) -> std::unique_ptr<VoiceRecognizer> {
+        std::lock_guard<std::mutex> lock(mutex_);
+        attempts_.push_back(std::chrono::steady_clock::now());
+        if (buildFailures_ > 0) {
+            --buildFailures_;
+            return nullptr;
+        }
+        auto engine = std::make_unique<MockVoiceRecognizer>(config, *this, engines_.size());
+        engines_.push_back(engine.get());
+        return engine;
+    };
+}
+
+inline void MockEngineFactory::failBuilds(int count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buildFailures_ = count;
+}
+
+inline void MockEngineFactory::failPrepares(int count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    prepareFailures_ = count;
+}
+
+inline void MockEngineFactory::failStarts(int count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    startFailures_ = count;
+}
+
+inline MockVoiceRecognizer* MockEngineFactory::engine(int index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index >= 0 && static_cast<size_t>(index) < engines_.size() ? engines_[index] : nullptr;
+}
+
+inline int MockEngineFactory::built() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(engines_.size());
+}
+
+inline std::vector<std::chrono::steady_clock::time_point> MockEngineFactory::buildAttempts() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return attempts_;
+}
+
+} // namespace voice_assist
+
+#endif // MOCK_VOICE_RECOGNIZER_H
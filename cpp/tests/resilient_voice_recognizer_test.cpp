@@ -0,0 +1,207 @@
+// Recovery of ResilientVoiceRecognizer from engine failures injected by MockEngineFactory
+
+#include "mock_voice_recognizer.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace voice_assist;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    failures += ok ? 0 : 1;
+}
+
+/**
+ * @brief Polls condition until it holds or timeoutMs passes
+ */
+bool waitFor(const std::function<bool()>& condition, int timeoutMs = 2000) {
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!condition()) {
+        if (Clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+/**
+ * @brief Collects the final transcripts a recognizer delivers
+ */
+class Transcripts {
+public:
+    VoiceRecognizer::TranscriptionCallback callback() {
+        return [this](const std::string& text, bool isFinal) {
+            if (isFinal) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                texts_.push_back(text);
+            }
+        };
+    }
+
+    bool received(const std::string& text) {
+        return waitFor([this, &text]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return !texts_.empty() && texts_.back() == text;
+        });
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> texts_;
+};
+
+VoiceRecognizerConfig testConfig(bool warmStandby) {
+    VoiceRecognizerConfig config;
+    config.warmStandby = warmStandby;
+    config.recoveryBackoffMs = 40;
+    config.maxRecoveryBackoffMs = 100;
+    return config;
+}
+
+bool listening(MockEngineFactory& engines, int index) {
+    MockVoiceRecognizer* engine = engines.engine(index);
+    return engine && engine->isListening();
+}
+
+void testStandbyTakesOver() {
+    MockEngineFactory engines;
+    ResilientVoiceRecognizer recognizer(testConfig(true), engines.factory());
+    check(waitFor([&]() { return recognizer.hasStandby(); }), "standby: is prepared in the background");
+
+    Transcripts transcripts;
+    check(recognizer.startListening(transcripts.callback()), "standby: starts listening");
+    check(recognizer.acceptsPushedAudio(), "standby: takes pushed audio as its engine does");
+    engines.engine(0)->fail("device lost");
+    check(waitFor([&]() { return listening(engines, 1); }), "standby: listens after the active engine fails");
+    engines.engine(1)->say("hello");
+    check(transcripts.received("hello"), "standby: delivers through the original callback");
+    check(waitFor([&]() { return engines.engine(0) == nullptr; }), "standby: failed engine is destroyed");
+    check(waitFor([&]() { return recognizer.hasStandby() && engines.built() == 3; }), "standby: is replaced");
+
+    const RecoveryStats stats = recognizer.getRecoveryStats();
+    check(stats.failures == 1 && stats.standbySwaps == 1 && stats.failedRebuilds == 0, "standby: stats count one swap");
+}
+
+void testStartFailureFallsBack() {
+    MockEngineFactory engines;
+    ResilientVoiceRecognizer recognizer(testConfig(true), engines.factory());
+    check(waitFor([&]() { return recognizer.hasStandby(); }), "start failure: standby is prepared");
+
+    engines.failStarts(1);
+    Transcripts transcripts;
+    check(recognizer.startListening(transcripts.callback()), "start failure: falls back to the standby");
+    check(engines.engine(0) == nullptr && listening(engines, 1), "start failure: standby listens in its place");
+
+    const RecoveryStats stats = recognizer.getRecoveryStats();
+    check(stats.failures == 1 && stats.standbySwaps == 1, "start failure: stats count one swap");
+}
+
+void testFailedRebuildsBackOff() {
+    MockEngineFactory engines;
+    const VoiceRecognizerConfig config = testConfig(false);
+    ResilientVoiceRecognizer recognizer(config, engines.factory());
+
+    Transcripts transcripts;
+    check(recognizer.startListening(transcripts.callback()), "backoff: starts listening");
+
+    // Two builds fail outright and one engine fails to prepare
+    engines.failBuilds(2);
+    engines.failPrepares(1);
+    const Clock::time_point failedAt = Clock::now();
+    engines.engine(0)->fail("engine crashed");
+    check(waitFor([&]() { return recognizer.getRecoveryStats().rebuilds == 1; }), "backoff: rebuilds eventually");
+
+    const int rebuilt = engines.built() - 1;
+    check(waitFor([&]() { return listening(engines, rebuilt); }), "backoff: rebuilt engine resumes listening");
+    engines.engine(rebuilt)->say("back again");
+    check(transcripts.received("back again"), "backoff: delivers through the original callback");
+
+    const RecoveryStats stats = recognizer.getRecoveryStats();
+    check(stats.failures == 1 && stats.standbySwaps == 0 && stats.failedRebuilds == 3,
+          "backoff: stats count three failed rebuilds");
+
+    // The first attempt was the constructor's. Each wait is jittered within
+    // [backoff / 2, backoff], and the backoff doubles up to its maximum.
+    const std::vector<Clock::time_point> attempts = engines.buildAttempts();
+    check(attempts.size() == 5, "backoff: four attempts after the failure");
+    if (attempts.size() != 5) {
+        return;
+    }
+    int backoffMs = config.recoveryBackoffMs;
+    Clock::time_point previous = failedAt;
+    for (size_t i = 1; i < attempts.size(); ++i) {
+        const double waitedMs = elapsedMs(previous, attempts[i]);
+        const bool ok = waitedMs >= backoffMs / 2 - 1.0 && waitedMs <= backoffMs + 50.0;
+        check(ok, "backoff: attempt " + std::to_string(i) + " waited " + std::to_string(waitedMs) + " ms of "
+                  + std::to_string(backoffMs / 2) + "-" + std::to_string(backoffMs));
+        backoffMs = std::min(backoffMs * 2, config.maxRecoveryBackoffMs);
+        previous = attempts[i];
+    }
+}
+
+void testSetConfigReachesEngines() {
+    MockEngineFactory engines;
+    ResilientVoiceRecognizer recognizer(testConfig(true), engines.factory());
+    check(waitFor([&]() { return recognizer.hasStandby(); }), "config: standby is prepared");
+
+    VoiceRecognizerConfig config = recognizer.getConfig();
+    config.language = "de-DE";
+    recognizer.setConfig(config);
+    check(engines.engine(0)->language() == "de-DE", "config: reaches the active engine");
+    check(engines.engine(1)->language() == "de-DE", "config: reaches the standby");
+
+    Transcripts transcripts;
+    recognizer.startListening(transcripts.callback());
+    engines.engine(0)->fail("device lost");
+    check(waitFor([&]() { return engines.built() == 3 && engines.engine(2); }), "config: standby is replaced");
+    MockVoiceRecognizer* replacement = engines.engine(2);
+    check(replacement && replacement->language() == "de-DE", "config: reaches engines built later");
+}
+
+void testSlowShutdownDoesNotBlock() {
+    MockEngineFactory engines;
+    ResilientVoiceRecognizer recognizer(testConfig(true), engines.factory());
+    check(waitFor([&]() { return recognizer.hasStandby(); }), "slow shutdown: standby is prepared");
+
+    Transcripts transcripts;
+    recognizer.startListening(transcripts.callback());
+    engines.engine(0)->setStopDelay(500);
+    engines.engine(0)->fail("device lost");
+    check(waitFor([&]() { return recognizer.getRecoveryStats().standbySwaps == 1; }), "slow shutdown: standby swapped in");
+
+    // The failed engine is still shutting down on the recovery thread
+    const Clock::time_point start = Clock::now();
+    recognizer.stopListening();
+    const bool restarted = recognizer.startListening(transcripts.callback());
+    const double tookMs = elapsedMs(start, Clock::now());
+    check(restarted && tookMs < 200.0,
+          "slow shutdown: restart took " + std::to_string(tookMs) + " ms while the failed engine stopped");
+}
+
+} // namespace
+
+int main() {
+    testStandbyTakesOver();
+    testStartFailureFallsBack();
+    testFailedRebuildsBackOff();
+    testSetConfigReachesEngines();
+    testSlowShutdownDoesNotBlock();
+    return failures == 0 ? 0 : 1;
+}